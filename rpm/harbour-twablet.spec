@@ -13,6 +13,7 @@ BuildRequires: pkgconfig(Qt5Core)
 BuildRequires: pkgconfig(Qt5Qml)
 BuildRequires: pkgconfig(Qt5Quick)
 BuildRequires: pkgconfig(Qt5Test)
+BuildRequires: pkgconfig(zlib)
 BuildRequires: desktop-file-utils
 BuildRequires: cmake
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtTest/QtTest>
+#include <tweet.h>
+#include <private/entityformatutil.h>
+#include <private/jsonreader.h>
+#include "benchmarkutil.h"
+
+using namespace benchmark_util;
+
+class FormattingBenchmark: public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        private_util::JsonReader reader {fixture(QLatin1String("home_timeline.json"))};
+        if (reader.beginArray()) {
+            while (reader.hasNext()) {
+                m_tweets.emplace_back(reader);
+            }
+        }
+        QVERIFY(!m_tweets.empty());
+    }
+    void formatEntities()
+    {
+        auto format = [this]() {
+            for (const Tweet &tweet : m_tweets) {
+                private_util::formatEntities(tweet.text(), tweet.entities(), true);
+            }
+        };
+        report("formatEntities", m_tweets.size(), format);
+        QBENCHMARK {
+            format();
+        }
+    }
+    void formatPlainText()
+    {
+        auto format = [this]() {
+            for (const Tweet &tweet : m_tweets) {
+                private_util::formatPlainText(tweet.text(), tweet.entities());
+            }
+        };
+        report("formatPlainText", m_tweets.size(), format);
+        QBENCHMARK {
+            format();
+        }
+    }
+    void prepareDisplayText()
+    {
+        // Tweets are copied, so that their data is detached, like
+        // when they are decoded
+        auto prepare = [this]() {
+            for (const Tweet &tweet : m_tweets) {
+                Tweet copy {tweet};
+                copy.prepareDisplayText();
+            }
+        };
+        report("Tweet::prepareDisplayText", m_tweets.size(), prepare);
+        QBENCHMARK {
+            prepare();
+        }
+    }
+private:
+    std::vector<Tweet> m_tweets {};
+};
+
+QTEST_GUILESS_MAIN(FormattingBenchmark)
+
+#include "bench_formatting.moc"
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/QMessageAuthenticationCode>
+#include <private/twitterdatautil.h>
+#include "benchmarkutil.h"
+
+using namespace benchmark_util;
+
+// Signing as it was done before TwitterDataUtil::SigningContext,
+// kept as a baseline
+static QByteArray previousAuthorizationHeader(const QByteArray &oauthConsumerKey,
+                                              const QByteArray &oauthConsumerSecret,
+                                              const QByteArray &requestMethod,
+                                              const QByteArray &requestUrl,
+                                              const std::vector<std::pair<QByteArray, QByteArray>> &parameters,
+                                              const QByteArray &oauthToken,
+                                              const QByteArray &oauthTokenSecret)
+{
+    QByteArray nonce {QUuid::createUuid().toByteArray().toBase64()};
+    QByteArray timestamp {QByteArray::number(qFloor(QDateTime::currentMSecsSinceEpoch() / 1000.0))};
+
+    QMap<QByteArray, QByteArray> encodedParams {};
+    encodedParams.insert(QByteArray("oauth_consumer_key").toPercentEncoding(), QByteArray(oauthConsumerKey).toPercentEncoding());
+    encodedParams.insert(QByteArray("oauth_nonce").toPercentEncoding(), nonce.toPercentEncoding());
+    encodedParams.insert(QByteArray("oauth_signature_method").toPercentEncoding(), QByteArray("HMAC-SHA1").toPercentEncoding());
+    encodedParams.insert(QByteArray("oauth_timestamp").toPercentEncoding(), timestamp.toPercentEncoding());
+    encodedParams.insert(QByteArray("oauth_version").toPercentEncoding(), QByteArray("1.0").toPercentEncoding());
+    if (!oauthToken.isEmpty()) {
+        encodedParams.insert(QByteArray("oauth_token").toPercentEncoding(), oauthToken.toPercentEncoding());
+    }
+    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
+        encodedParams.insert(parameter.first, parameter.second);
+    }
+
+    QByteArray parametersByteArray {};
+    QList<QByteArray> keys = encodedParams.keys();
+    for (const QByteArray &key : keys) {
+        parametersByteArray += key + QByteArray("=") + encodedParams.value(key) + QByteArray("&");
+    }
+    parametersByteArray.chop(1);
+
+    QByteArray signatureBaseString {requestMethod.toUpper() + QByteArray("&") + requestUrl.toPercentEncoding() + QByteArray("&") + parametersByteArray.toPercentEncoding()};
+    QByteArray signingKey {oauthConsumerSecret.toPercentEncoding() + QByteArray("&") + oauthTokenSecret.toPercentEncoding()};
+
+    QByteArray oauthSignature {QMessageAuthenticationCode::hash(signatureBaseString, signingKey, QCryptographicHash::Sha1).toBase64()};
+    encodedParams.insert(QByteArray("oauth_signature").toPercentEncoding(), oauthSignature.toPercentEncoding());
+
+    QByteArray authHeader = QByteArray("OAuth ");
+    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
+        encodedParams.remove(parameter.first);
+    }
+    keys = encodedParams.keys();
+    for (const QByteArray &key : keys) {
+        authHeader += key + "=\"" + encodedParams.value(key) + "\", ";
+    }
+    authHeader.chop(2);
+    return authHeader;
+}
+
+class OAuthBenchmark: public QObject
+{
+    Q_OBJECT
+private slots:
+    void authorizationHeader()
+    {
+        // Parameters of a refresh of the home timeline, copied
+        // from a std::map like TwitterQueryUtil used to do
+        auto sign = [this]() {
+            std::map<QByteArray, QByteArray> fullParameters (std::begin(m_parameters), std::end(m_parameters));
+            std::vector<std::pair<QByteArray, QByteArray>> parameters (std::begin(fullParameters), std::end(fullParameters));
+            previousAuthorizationHeader("consumer-key", "consumer-secret", "GET", m_url, parameters,
+                                        "token", "token-secret");
+        };
+        report("Previous TwitterDataUtil::authorizationHeader", 1, sign);
+        QBENCHMARK {
+            sign();
+        }
+    }
+    void signingContext()
+    {
+        // Contexts are built once per account
+        const private_util::TwitterDataUtil::SigningContext context {"consumer-key", "consumer-secret",
+                                                                     "token", "token-secret"};
+        auto sign = [this, &context]() {
+            context.authorizationHeader("GET", m_url, m_parameters);
+        };
+        report("TwitterDataUtil::SigningContext::authorizationHeader", 1, sign);
+        QBENCHMARK {
+            sign();
+        }
+    }
+    void createSigningContext()
+    {
+        auto create = []() {
+            private_util::TwitterDataUtil::SigningContext context {"consumer-key", "consumer-secret",
+                                                                   "token", "token-secret"};
+            Q_UNUSED(context)
+        };
+        report("TwitterDataUtil::SigningContext", 1, create);
+        QBENCHMARK {
+            create();
+        }
+    }
+private:
+    const QByteArray m_url {"https://api.twitter.com/1.1/statuses/home_timeline.json"};
+    const std::map<QByteArray, QByteArray> m_parameters {
+        {"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"},
+        {"since_id", "708999999994921707"}
+    };
+};
+
+QTEST_GUILESS_MAIN(OAuthBenchmark)
+
+#include "bench_oauth.moc"
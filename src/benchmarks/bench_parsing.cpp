@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtTest/QtTest>
+#include <entity.h>
+#include <tweet.h>
+#include <user.h>
+#include <private/jsonreader.h>
+#include "benchmarkutil.h"
+
+using namespace benchmark_util;
+
+static std::vector<Tweet> readTweets(private_util::JsonReader &reader)
+{
+    std::vector<Tweet> tweets {};
+    if (reader.beginArray()) {
+        while (reader.hasNext()) {
+            tweets.emplace_back(reader);
+        }
+    }
+    return tweets;
+}
+
+class ParsingBenchmark: public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        m_timeline = fixture(QLatin1String("home_timeline.json"));
+        m_search = fixture(QLatin1String("search.json"));
+        m_members = fixture(QLatin1String("members.json"));
+        m_timelineArray = QJsonDocument::fromJson(m_timeline).array();
+        QVERIFY(m_timelineArray.size() > 0);
+    }
+    void documentParsing()
+    {
+        report("QJsonDocument::fromJson (timeline)", m_timelineArray.size(), [this]() {
+            QJsonDocument::fromJson(m_timeline);
+        });
+        QBENCHMARK {
+            QJsonDocument::fromJson(m_timeline);
+        }
+    }
+    void tweetFromJsonObject()
+    {
+        auto parse = [this]() {
+            for (const QJsonValue &value : m_timelineArray) {
+                Tweet tweet {value.toObject()};
+                Q_UNUSED(tweet);
+            }
+        };
+        report("Tweet(const QJsonObject &)", m_timelineArray.size(), parse);
+        QBENCHMARK {
+            parse();
+        }
+    }
+    void tweetFromReader()
+    {
+        auto parse = [this]() {
+            private_util::JsonReader reader {m_timeline};
+            readTweets(reader);
+        };
+        report("Tweet(JsonReader &) (timeline)", m_timelineArray.size(), parse);
+        QBENCHMARK {
+            parse();
+        }
+    }
+    void searchFromReader()
+    {
+        int count {0};
+        auto parse = [this, &count]() {
+            private_util::JsonReader reader {m_search};
+            if (reader.beginObject()) {
+                while (reader.nextName()) {
+                    if (reader.name() == "statuses") {
+                        count = readTweets(reader).size();
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+            }
+        };
+        parse();
+        QVERIFY(count > 0);
+        report("Tweet(JsonReader &) (search)", count, parse);
+        QBENCHMARK {
+            parse();
+        }
+    }
+    void usersFromReader()
+    {
+        int count {0};
+        auto parse = [this, &count]() {
+            std::vector<User> users {};
+            private_util::JsonReader reader {m_members};
+            if (reader.beginObject()) {
+                while (reader.nextName()) {
+                    if (reader.name() == "users" && reader.beginArray()) {
+                        while (reader.hasNext()) {
+                            users.emplace_back(reader);
+                        }
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+            }
+            count = users.size();
+        };
+        parse();
+        QVERIFY(count > 0);
+        report("User(JsonReader &) (list members)", count, parse);
+        QBENCHMARK {
+            parse();
+        }
+    }
+    void entityCreate()
+    {
+        std::vector<std::pair<QJsonObject, QJsonObject>> entities {};
+        for (const QJsonValue &value : m_timelineArray) {
+            const QJsonObject &tweet (value.toObject());
+            entities.emplace_back(tweet.value(QLatin1String("entities")).toObject(),
+                                  tweet.value(QLatin1String("extended_entities")).toObject());
+        }
+        auto create = [&entities]() {
+            for (const std::pair<QJsonObject, QJsonObject> &entity : entities) {
+                Entity::create(entity.first, entity.second);
+            }
+        };
+        report("Entity::create", entities.size(), create);
+        QBENCHMARK {
+            create();
+        }
+    }
+private:
+    QByteArray m_timeline {};
+    QByteArray m_search {};
+    QByteArray m_members {};
+    QJsonArray m_timelineArray {};
+};
+
+QTEST_GUILESS_MAIN(ParsingBenchmark)
+
+#include "bench_parsing.moc"
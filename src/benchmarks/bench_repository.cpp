@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtTest/QtTest>
+#include <tweetrepository.h>
+#include <tweetstore.h>
+#include <userstore.h>
+#include <private/jsonreader.h>
+#include <private/repositoryindex.h>
+#include "benchmarkutil.h"
+
+using namespace benchmark_util;
+
+class RepositoryBenchmark: public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        private_util::JsonReader reader {fixture(QLatin1String("home_timeline.json"))};
+        if (reader.beginArray()) {
+            while (reader.hasNext()) {
+                m_tweets.emplace_back(reader);
+            }
+        }
+        QVERIFY(!m_tweets.empty());
+    }
+    void prepend()
+    {
+        auto prepend = [this]() {
+            TweetRepository repository {};
+            repository.prepend(m_tweets);
+        };
+        report("Repository::prepend", m_tweets.size(), prepend);
+        QBENCHMARK {
+            prepend();
+        }
+    }
+    void prependIndexed()
+    {
+        // Like the repositories of TweetRepositoryContainer, that are
+        // indexed, and bounded
+        auto prepend = [this]() {
+            TweetRepository repository {};
+            repository.setMaximumSize(m_tweets.size() * 3 / 2);
+            private_util::RepositoryIndex<Tweet> index {repository};
+            repository.prepend(m_tweets);
+            repository.prepend(m_tweets);
+            repository.trimBack();
+        };
+        report("Repository::prepend (indexed and trimmed)", 2 * m_tweets.size(), prepend);
+        QBENCHMARK {
+            prepend();
+        }
+    }
+    void intern()
+    {
+        auto intern = [this]() {
+            UserStore userStore {};
+            TweetStore tweetStore {};
+            std::vector<Tweet> tweets {m_tweets};
+            for (Tweet &tweet : tweets) {
+                tweet.internUsers(userStore);
+                tweetStore.insert(tweet);
+            }
+        };
+        report("UserStore::intern and TweetStore::insert", m_tweets.size(), intern);
+        QBENCHMARK {
+            intern();
+        }
+    }
+private:
+    std::vector<Tweet> m_tweets {};
+};
+
+QTEST_GUILESS_MAIN(RepositoryBenchmark)
+
+#include "bench_repository.moc"
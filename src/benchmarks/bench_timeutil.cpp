@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QtCore/QLocale>
+#include <QtTest/QtTest>
+#include <private/timeutil.h>
+#include "benchmarkutil.h"
+
+using namespace benchmark_util;
+
+// Implementation based on QLocale, that was used before parseTimestamp()
+static QDateTime fromUtcWithLocale(const QString &timeUtc)
+{
+    QLocale locale (QLocale::English, QLocale::UnitedStates);
+    QDateTime utc {locale.toDateTime(timeUtc, QLatin1String("ddd MMM dd HH:mm:ss +0000 yyyy"))};
+    utc.setTimeSpec(Qt::UTC);
+    return utc.toLocalTime();
+}
+
+class TimeUtilBenchmark: public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        // Same volume as a refresh of the home timeline
+        for (int i = 0; i < 200; ++i) {
+            m_timestamps.append(QString(QLatin1String("Wed Aug %1 13:%2:45 +0000 2015")).arg(1 + i % 28, 2, 10, QLatin1Char('0'))
+                                                                                       .arg(i % 60, 2, 10, QLatin1Char('0')));
+        }
+    }
+    void locale()
+    {
+        qint64 sum {0};
+        auto parse = [this, &sum]() {
+            for (const QString &timestamp : m_timestamps) {
+                sum += fromUtcWithLocale(timestamp).toMSecsSinceEpoch();
+            }
+        };
+        report("QLocale::toDateTime", m_timestamps.size(), parse);
+        QBENCHMARK {
+            parse();
+        }
+        QVERIFY(sum != 0);
+    }
+    void parseTimestamp()
+    {
+        qint64 sum {0};
+        auto parse = [this, &sum]() {
+            for (const QString &timestamp : m_timestamps) {
+                sum += private_util::parseTimestamp(timestamp);
+            }
+        };
+        report("private_util::parseTimestamp", m_timestamps.size(), parse);
+        QBENCHMARK {
+            parse();
+        }
+        QVERIFY(sum != 0);
+    }
+    void parseTimestampAndConvert()
+    {
+        qint64 sum {0};
+        auto parse = [this, &sum]() {
+            for (const QString &timestamp : m_timestamps) {
+                sum += private_util::fromUtc(timestamp).toMSecsSinceEpoch();
+            }
+        };
+        report("private_util::fromUtc", m_timestamps.size(), parse);
+        QBENCHMARK {
+            parse();
+        }
+        QVERIFY(sum != 0);
+    }
+private:
+    QStringList m_timestamps {};
+};
+
+QTEST_GUILESS_MAIN(TimeUtilBenchmark)
+
+#include "bench_timeutil.moc"
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "benchmarkutil.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+
+static std::atomic<qint64> allocations {0};
+
+#if defined(__GLIBC__)
+// Qt containers allocate with malloc, and not with operator new, so the
+// allocator of glibc is wrapped. The shared libraries, like Qt, also use
+// the functions defined in the executable.
+extern "C" {
+void * __libc_malloc(std::size_t size);
+void * __libc_calloc(std::size_t count, std::size_t size);
+void * __libc_realloc(void *pointer, std::size_t size);
+
+void * malloc(std::size_t size) __THROW
+{
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+void * calloc(std::size_t count, std::size_t size) __THROW
+{
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void *pointer, std::size_t size) __THROW
+{
+    ++allocations;
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+// Only the allocations made with operator new are counted
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    void *pointer {std::malloc(size > 0 ? size : 1)};
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+namespace benchmark_util
+{
+
+static const qint64 MINIMUM_DURATION {200 * 1000 * 1000};
+
+QByteArray fixture(const QString &name)
+{
+    QFile file {QString(QLatin1String(":/data/%1")).arg(name)};
+    if (!file.open(QIODevice::ReadOnly)) {
+        qFatal("Cannot open fixture %s", qPrintable(name));
+    }
+    return file.readAll();
+}
+
+qint64 allocationCount()
+{
+    return allocations;
+}
+
+void report(const char *stage, int operations, const std::function<void ()> &function)
+{
+    // Warm-up, that also fills caches that are used by Qt
+    function();
+
+    qint64 runs {0};
+    qint64 startAllocations {allocationCount()};
+    QElapsedTimer timer {};
+    timer.start();
+    do {
+        function();
+        ++runs;
+    } while (timer.nsecsElapsed() < MINIMUM_DURATION);
+    qint64 elapsed {timer.nsecsElapsed()};
+    qint64 allocated {allocationCount() - startAllocations};
+
+    double count {static_cast<double>(runs * qMax(operations, 1))};
+    qDebug("%s: %.0f ns/op, %.2f allocations/op (%d operations per run, %lld runs)",
+           stage, elapsed / count, allocated / count, operations, runs);
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef BENCHMARKUTIL_H
+#define BENCHMARKUTIL_H
+
+#include <functional>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace benchmark_util
+{
+
+/**
+ * @brief Content of a fixture
+ *
+ * Fixtures are generated with tools/genfixtures.py, and
+ * embedded in the benchmarks as resources.
+ *
+ * @param name name of the fixture, like "home_timeline.json".
+ * @return content of the fixture.
+ */
+QByteArray fixture(const QString &name);
+
+/**
+ * @brief Number of allocations made since the start of the program
+ *
+ * With glibc, malloc(), calloc() and realloc() are wrapped, so that
+ * the allocations of Qt containers are counted too. Otherwise, only
+ * the allocations made with the global operator new are counted.
+ *
+ * @return number of allocations.
+ */
+qint64 allocationCount();
+
+/**
+ * @brief Measure and print the cost of a stage
+ *
+ * The function is run repeatedly for at least 200 ms, after a
+ * warm-up run, and the time and allocations per operation
+ * are printed.
+ *
+ * @param stage name of the measured stage.
+ * @param operations number of operations performed by each call of the function.
+ * @param function function to measure.
+ */
+void report(const char *stage, int operations, const std::function<void ()> &function);
+
+}
+
+#endif // BENCHMARKUTIL_H
@@ -42,7 +42,21 @@ ApplicationWindow {
         repository: Repository
     }
 
+    // Connections to Twitter are opened when the network comes online
+    Connections {
+        target: NetworkMonitor
+        onOnlineChanged: Repository.setOnline(NetworkMonitor.online)
+    }
+
+    // Timelines are only refreshed automatically while the application is active
+    Connections {
+        target: Qt.application
+        onActiveChanged: Repository.setActive(Qt.application.active)
+    }
+
     Component.onCompleted: {
+        Repository.setOnline(NetworkMonitor.online)
+        Repository.setActive(Qt.application.active)
         if (accountModel.count === 0) {
             pageStack.push(Qt.resolvedUrl("pages/SettingsPage.qml"), {initial: true})
         } else {
@@ -140,10 +140,14 @@ Page {
                 snapMode: view.columnCount > 1 ? ListView.SnapToItem : ListView.SnapOneItem
                 delegate: ColumnLayout {
                     id: delegate
+                    // Visible columns are refreshed first
+                    property bool onScreen: x + width > view.contentX && x < view.contentX + view.width
                     width: view.columnWidth
                     height: view.height
                     title: model.name
                     query: model.layout.query
+                    onOnScreenChanged: Repository.setLayoutVisible(model.index, onScreen)
+                    Component.onCompleted: Repository.setLayoutVisible(model.index, onScreen)
                     onHandleLink: {
                         LH.handleLink(url, panel, model.layout.accountUserId, Info.Clear)
                     }
@@ -33,6 +33,7 @@
 
 ContainerKey::ContainerKey(Account &&account, Query &&query)
     : m_account(std::move(account)), m_query(std::move(query))
+    , m_userId(TwitterId::fromString(m_account.userId()))
 {
 }
 
@@ -48,7 +49,17 @@ const Query & ContainerKey::query() const
 
 bool ContainerKey::operator<(const ContainerKey &other) const
 {
-    return m_account.userId() == other.m_account.userId()
-            ? m_query < other.m_query
-            : m_account.userId() < other.m_account.userId();
+    // Keys are compared with the parsed user id, that is cheaper to compare.
+    // A valid id stands for one string, but ids that cannot be parsed are
+    // all invalid, so only their strings tell them apart.
+    if (m_userId != other.m_userId) {
+        return m_userId < other.m_userId;
+    }
+    if (!m_userId.isValid()) {
+        int userIdComparison {QString::compare(m_account.userId(), other.m_account.userId())};
+        if (userIdComparison != 0) {
+            return userIdComparison < 0;
+        }
+    }
+    return m_query < other.m_query;
 }
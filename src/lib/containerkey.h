@@ -34,6 +34,7 @@
 
 #include "account.h"
 #include "query.h"
+#include "twitterid.h"
 
 class ContainerKey
 {
@@ -45,6 +46,7 @@ public:
 private:
     Account m_account {};
     Query m_query {};
+    TwitterId m_userId {};
 };
 
 #endif // CONTAINERKEY_H
@@ -31,63 +31,142 @@
 
 #include "entity.h"
 #include <map>
-#include <set>
+#include <QtCore/QDataStream>
 #include <QtCore/QJsonArray>
+#include "private/jsonreader.h"
 #include "private/maputil.h"
 #include "urlentity.h"
 #include "mediaentity.h"
 #include "usermentionentity.h"
 #include "hashtagentity.h"
+#include "entityvisitor.h"
 
 template <class T>
-static void insertEntity(const QJsonValue &value, std::map<QString, Entity::Ptr> &map,
-                         std::vector<QString> &texts)
+static void createEntities(const QJsonArray &values, Entity::List &entities)
 {
-    Entity::Ptr entity {new T(value.toObject())};
-    if (!private_util::hasValue(map, entity->text())) {
-        texts.push_back(entity->text());
+    for (const QJsonValue &value : values) {
+        entities.emplace_back(new T(value.toObject()));
     }
-    map.emplace(entity->text(), entity);
 }
 
 template <class T>
-static void overrideEntity(const QJsonValue &value, std::map<QString, Entity::Ptr> &map,
-                           Entity::List &extended)
+static void readEntities(private_util::JsonReader &reader, Entity::List &entities)
 {
-    Entity::Ptr entity {new T(value.toObject())};
-    map.erase(entity->text());
-    extended.push_back(entity);
+    if (!reader.beginArray()) {
+        return;
+    }
+    while (reader.hasNext()) {
+        entities.emplace_back(new T(reader));
+    }
+}
+
+int Entity::start() const
+{
+    return m_start;
+}
+
+int Entity::end() const
+{
+    return m_end;
+}
+
+void Entity::readIndices(const QJsonObject &json)
+{
+    const QJsonArray &indices (json.value(QLatin1String("indices")).toArray());
+    if (indices.size() == 2) {
+        m_start = indices.at(0).toInt(-1);
+        m_end = indices.at(1).toInt(-1);
+    }
+}
+
+void Entity::readIndices(private_util::JsonReader &reader)
+{
+    if (!reader.beginArray()) {
+        return;
+    }
+    std::vector<int> indices {};
+    while (reader.hasNext()) {
+        indices.push_back(reader.readInt());
+    }
+    if (indices.size() == 2) {
+        m_start = indices.at(0);
+        m_end = indices.at(1);
+    }
 }
 
 Entity::List Entity::create(const QJsonObject &json, const QJsonObject &extendedJson)
 {
+    List entities {};
+    createEntities<MediaEntity>(json.value(QLatin1String("media")).toArray(), entities);
+    createEntities<UrlEntity>(json.value(QLatin1String("urls")).toArray(), entities);
+    createEntities<UserMentionEntity>(json.value(QLatin1String("user_mentions")).toArray(), entities);
+    createEntities<HashtagEntity>(json.value(QLatin1String("hashtags")).toArray(), entities);
+
     List extended {};
-    List returned {};
-    std::vector<QString> texts {};
-    std::map<QString, Entity::Ptr> map {};
-    const QJsonArray &media (json.value(QLatin1String("media")).toArray());
-    for (const QJsonValue &value : media) {
-        insertEntity<MediaEntity>(value, map, texts);
-    }
+    createEntities<MediaEntity>(extendedJson.value(QLatin1String("media")).toArray(), extended);
+    return merge(std::move(entities), std::move(extended));
+}
 
-    const QJsonArray &urls (json.value(QLatin1String("urls")).toArray());
-    for (const QJsonValue &value : urls) {
-        insertEntity<UrlEntity>(value, map, texts);
+Entity::List Entity::create(private_util::JsonReader &reader)
+{
+    // Members can come in any order, but entities are ordered by category
+    List media {};
+    List urls {};
+    List users {};
+    List hashtags {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "media") {
+                readEntities<MediaEntity>(reader, media);
+            } else if (name == "urls") {
+                readEntities<UrlEntity>(reader, urls);
+            } else if (name == "user_mentions") {
+                readEntities<UserMentionEntity>(reader, users);
+            } else if (name == "hashtags") {
+                readEntities<HashtagEntity>(reader, hashtags);
+            } else {
+                reader.skipValue();
+            }
+        }
     }
 
-    const QJsonArray &users (json.value(QLatin1String("user_mentions")).toArray());
-    for (const QJsonValue &value : users) {
-        insertEntity<UserMentionEntity>(value, map, texts);
+    List entities {std::move(media)};
+    entities.insert(std::end(entities), std::begin(urls), std::end(urls));
+    entities.insert(std::end(entities), std::begin(users), std::end(users));
+    entities.insert(std::end(entities), std::begin(hashtags), std::end(hashtags));
+    return merge(std::move(entities), List());
+}
+
+Entity::List Entity::createExtended(private_util::JsonReader &reader)
+{
+    List returned {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            if (reader.name() == "media") {
+                readEntities<MediaEntity>(reader, returned);
+            } else {
+                reader.skipValue();
+            }
+        }
     }
+    return returned;
+}
 
-    const QJsonArray &hashtags (json.value(QLatin1String("hashtags")).toArray());
-    for (const QJsonValue &value : hashtags) {
-        insertEntity<HashtagEntity>(value, map, texts);
+Entity::List Entity::merge(List &&entities, List &&extendedEntities)
+{
+    List returned {};
+    std::vector<QString> texts {};
+    std::map<QString, Entity::Ptr> map {};
+    for (const Entity::Ptr &entity : entities) {
+        if (!private_util::hasValue(map, entity->text())) {
+            texts.push_back(entity->text());
+        }
+        map.emplace(entity->text(), entity);
     }
 
-    const QJsonArray &extendedMedia (extendedJson.value(QLatin1String("media")).toArray());
-    for (const QJsonValue &value : extendedMedia) {
-        overrideEntity<MediaEntity>(value, map, extended);
+    for (const Entity::Ptr &entity : extendedEntities) {
+        map.erase(entity->text());
     }
 
     for (const QString &text : texts) {
@@ -96,9 +175,97 @@ Entity::List Entity::create(const QJsonObject &json, const QJsonObject &extended
             returned.push_back(it->second);
         }
     }
-    for (Entity::Ptr entity : extended) {
-        returned.push_back(entity);
+    for (Entity::Ptr &entity : extendedEntities) {
+        returned.push_back(std::move(entity));
     }
 
     return returned;
 }
+
+enum EntityTag
+{
+    MediaTag = 1,
+    UrlTag,
+    UserMentionTag,
+    HashtagTag
+};
+
+class EntityWriter: public EntityVisitor
+{
+public:
+    explicit EntityWriter(QDataStream &stream)
+        : m_stream(stream)
+    {
+    }
+    void visitMedia(const MediaEntity &entity) override
+    {
+        m_stream << static_cast<quint8>(MediaTag) << entity;
+    }
+    void visitUrl(const UrlEntity &entity) override
+    {
+        m_stream << static_cast<quint8>(UrlTag) << entity;
+    }
+    void visitUserMention(const UserMentionEntity &entity) override
+    {
+        m_stream << static_cast<quint8>(UserMentionTag) << entity;
+    }
+    void visitHashtag(const HashtagEntity &entity) override
+    {
+        m_stream << static_cast<quint8>(HashtagTag) << entity;
+    }
+private:
+    QDataStream &m_stream;
+};
+
+template <class T>
+static Entity::Ptr readEntity(QDataStream &stream)
+{
+    std::shared_ptr<T> entity {std::make_shared<T>()};
+    stream >> *entity;
+    return entity;
+}
+
+QDataStream & operator<<(QDataStream &stream, const Entity::List &entities)
+{
+    stream << static_cast<quint32>(entities.size());
+    EntityWriter writer {stream};
+    for (const Entity::Ptr &entity : entities) {
+        entity->accept(writer);
+        stream << static_cast<qint32>(entity->m_start) << static_cast<qint32>(entity->m_end);
+    }
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, Entity::List &entities)
+{
+    entities.clear();
+    quint32 count {0};
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint8 tag {0};
+        stream >> tag;
+        switch (tag) {
+        case MediaTag:
+            entities.push_back(readEntity<MediaEntity>(stream));
+            break;
+        case UrlTag:
+            entities.push_back(readEntity<UrlEntity>(stream));
+            break;
+        case UserMentionTag:
+            entities.push_back(readEntity<UserMentionEntity>(stream));
+            break;
+        case HashtagTag:
+            entities.push_back(readEntity<HashtagEntity>(stream));
+            break;
+        default:
+            stream.setStatus(QDataStream::ReadCorruptData);
+            return stream;
+        }
+        qint32 start {-1};
+        qint32 end {-1};
+        stream >> start >> end;
+        entities.back()->m_start = start;
+        entities.back()->m_end = end;
+    }
+    return stream;
+}
@@ -35,7 +35,13 @@
 #include <memory>
 #include <QtCore/QJsonObject>
 
+class QDataStream;
 class EntityVisitor;
+namespace private_util
+{
+class JsonReader;
+}
+
 /**
  * @brief An entity
  *
@@ -62,6 +68,20 @@ public:
      * @return text captured by the entity.
      */
     virtual QString text() const = 0;
+    /**
+     * @brief Start of the text captured by the entity
+     *
+     * The position is expressed in Unicode code points
+     * in the unescaped tweet text.
+     *
+     * @return start of the captured text, or -1 if unknown.
+     */
+    int start() const;
+    /**
+     * @brief End of the text captured by the entity
+     * @return end (exclusive) of the captured text, or -1 if unknown.
+     */
+    int end() const;
     virtual void accept(EntityVisitor &visitor) const = 0;
     /**
      * @brief Creates a list of Entity from a JSON object
@@ -77,6 +97,47 @@ public:
      * @return an list of entities.
      */
     static List create(const QJsonObject &json, const QJsonObject &extendedJson = QJsonObject());
+    /**
+     * @brief Creates a list of Entity from a JSON reader
+     *
+     * This factory method reads an entities object
+     * from a JSON reader. Extended entities should be
+     * read with createExtended(), and both lists
+     * should be combined with merge().
+     *
+     * @param reader JSON reader to read from.
+     * @return an list of entities.
+     */
+    static List create(private_util::JsonReader &reader);
+    /**
+     * @brief Creates a list of Entity from a JSON reader (extended_entities)
+     * @param reader JSON reader to read from.
+     * @return an list of extended entities.
+     */
+    static List createExtended(private_util::JsonReader &reader);
+    /**
+     * @brief Merge entities and extended entities
+     *
+     * Entities that capture the same text are only
+     * kept once, and extended entities replace the
+     * entities that capture the same text.
+     *
+     * @param entities entities to merge.
+     * @param extendedEntities extended entities to merge.
+     * @return merged list of entities.
+     */
+    static List merge(List &&entities, List &&extendedEntities);
+    friend QDataStream & operator<<(QDataStream &stream, const List &entities);
+    friend QDataStream & operator>>(QDataStream &stream, List &entities);
+protected:
+    void readIndices(const QJsonObject &json);
+    void readIndices(private_util::JsonReader &reader);
+private:
+    int m_start {-1};
+    int m_end {-1};
 };
 
+QDataStream & operator<<(QDataStream &stream, const Entity::List &entities);
+QDataStream & operator>>(QDataStream &stream, Entity::List &entities);
+
 #endif // ENTITY_H
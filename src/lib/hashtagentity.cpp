@@ -30,13 +30,33 @@
  */
 
 #include "hashtagentity.h"
+#include <QtCore/QDataStream>
 #include "entityvisitor.h"
+#include "private/jsonreader.h"
 
 HashtagEntity::HashtagEntity(const QJsonObject &json)
 {
+    readIndices(json);
     m_text = std::move(json.value(QLatin1String("text")).toString());
 }
 
+HashtagEntity::HashtagEntity(private_util::JsonReader &reader)
+{
+    if (!reader.beginObject()) {
+        return;
+    }
+    while (reader.nextName()) {
+        const QByteArray &name (reader.name());
+        if (name == "text") {
+            m_text = reader.readString();
+        } else if (name == "indices") {
+            readIndices(reader);
+        } else {
+            reader.skipValue();
+        }
+    }
+}
+
 bool HashtagEntity::isValid() const
 {
     return !m_text.isEmpty();
@@ -51,3 +71,15 @@ void HashtagEntity::accept(EntityVisitor &visitor) const
 {
     visitor.visitHashtag(*this);
 }
+
+QDataStream & operator<<(QDataStream &stream, const HashtagEntity &entity)
+{
+    stream << entity.m_text;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, HashtagEntity &entity)
+{
+    stream >> entity.m_text;
+    return stream;
+}
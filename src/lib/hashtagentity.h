@@ -40,10 +40,13 @@ class HashtagEntity: public Entity
 public:
     explicit HashtagEntity() = default;
     explicit HashtagEntity(const QJsonObject &json);
+    explicit HashtagEntity(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(HashtagEntity);
     bool isValid() const override;
     QString text() const override;
     void accept(EntityVisitor &visitor) const override;
+    friend QDataStream & operator<<(QDataStream &stream, const HashtagEntity &entity);
+    friend QDataStream & operator>>(QDataStream &stream, HashtagEntity &entity);
 private:
     QString m_text {};
 };
@@ -42,11 +42,45 @@ class IQueryExecutor
 {
 public:
     using ConstPtr = std::unique_ptr<const IQueryExecutor>;
+    using SharedPtr = std::shared_ptr<const IQueryExecutor>;
     using Callback_t = std::function<void (QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage)>;
     virtual ~IQueryExecutor() {}
     virtual void execute(Query::RequestType type, const QByteArray &path,
                          const std::map<QByteArray, QByteArray> &parameters,
                          const Account &account, const Callback_t &callback) const = 0;
+    /**
+     * @brief Execute a query with additional request headers
+     *
+     * This is used to send conditional requests. Executors that
+     * do not send requests over HTTP ignore the headers, and the
+     * default implementation drops them.
+     */
+    virtual void execute(Query::RequestType type, const QByteArray &path,
+                         const std::map<QByteArray, QByteArray> &parameters,
+                         const std::map<QByteArray, QByteArray> &headers,
+                         const Account &account, const Callback_t &callback) const
+    {
+        Q_UNUSED(headers)
+        execute(type, path, parameters, account, callback);
+    }
+    /**
+     * @brief If a query would be delayed before being sent
+     *
+     * Executors that hold queries back, like when a rate limit is
+     * reached, return true, so that callers do not count these
+     * queries as being in flight. The default implementation
+     * returns false.
+     */
+    virtual bool isDeferred(Query::RequestType type, const QByteArray &path,
+                            const std::map<QByteArray, QByteArray> &parameters,
+                            const Account &account) const
+    {
+        Q_UNUSED(type)
+        Q_UNUSED(path)
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        return false;
+    }
 };
 
 #endif // ILISTQUERYEXECUTOR_H
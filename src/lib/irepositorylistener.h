@@ -43,7 +43,9 @@ class QString;
  *
  * This listener can be used to get notifications when some items are inserted,
  * removed, or updated. This is done via onAppend(), onPrepend(), onUpdate() and
- * onRemove().
+ * onRemove(). Changes made in a transaction are notified as ranges, and the
+ * range overloads of onUpdate() and onRemove() can be reimplemented to handle
+ * them at once.
  *
  * This interface also handle the status of the asynchronous loading operation
  * that takes places in the Repository. This is done via onStart(), onError() and
@@ -75,11 +77,39 @@ public:
      * @param item the new value of the item.
      */
     virtual void onUpdate(int index, const T &item) = 0;
+    /**
+     * @brief Notify that a range of items is updated
+     *
+     * The default implementation calls onUpdate() for each item.
+     *
+     * @param first index of the first item that is updated.
+     * @param items the new values of the items.
+     */
+    virtual void onUpdate(int first, const std::vector<T> &items)
+    {
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            onUpdate(first + static_cast<int>(i), items[i]);
+        }
+    }
     /**
      * @brief Notify that an item is removed
      * @param index index of the item that is removed.
      */
     virtual void onRemove(int index) = 0;
+    /**
+     * @brief Notify that a range of items is removed
+     *
+     * The default implementation calls onRemove() for each item.
+     *
+     * @param first index of the first item that is removed.
+     * @param count number of removed items.
+     */
+    virtual void onRemove(int first, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            onRemove(first);
+        }
+    }
     /**
      * @brief Notify that an item has moved
      * @param from index of the item to move.
@@ -36,6 +36,10 @@
 #include <vector>
 #include <QtCore/QString>
 #include "query.h"
+#include "repository.h"
+
+class QDataStream;
+class QIODevice;
 
 template<class T>
 class IRepositoryQueryHandler
@@ -53,11 +57,38 @@ public:
         Prepend,
     };
     using Ptr = std::unique_ptr<IRepositoryQueryHandler<T>>;
+    using SharedPtr = std::shared_ptr<IRepositoryQueryHandler<T>>;
     virtual ~IRepositoryQueryHandler() {}
     virtual Query::Parameters additionalParameters(RequestType requestType) const = 0;
-    virtual bool treatReply(RequestType requestType, const QByteArray &data,
+    virtual bool treatReply(RequestType requestType, QIODevice &reply,
                             std::vector<T> &items, QString &errorMessage,
                             Placement &placement) = 0;
+    /**
+     * @brief Save the state of the handler
+     *
+     * The state contains the cursors that are used
+     * to refresh or load more items, and is stored
+     * with the cached items of a repository.
+     *
+     * @param stream stream to write to.
+     */
+    virtual void saveState(QDataStream &stream) const = 0;
+    /**
+     * @brief Restore the state of the handler
+     * @param stream stream to read from.
+     * @param items cached items that are restored with the state.
+     */
+    virtual void restoreState(QDataStream &stream, const std::vector<T> &items) = 0;
+    /**
+     * @brief Synchronize the handler with a trimmed repository
+     *
+     * This method is called when items were trimmed from
+     * the repository, so that the cursors are updated to
+     * load the trimmed items again when needed.
+     *
+     * @param repository repository that was trimmed.
+     */
+    virtual void synchronize(const Repository<T> &repository) = 0;
 };
 
 #endif // ILISTQUERYHANDLER_H
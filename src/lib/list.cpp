@@ -47,7 +47,7 @@ List::List(const QJsonObject &json)
     m_memberCount = json.value(QLatin1String("member_count")).toInt();
     m_subscriberCount = json.value(QLatin1String("subscriber_count")).toInt();
     m_uri = std::move(json.value(QLatin1String("uri")).toString());
-    m_createdAt = std::move(private_util::fromUtc(json.value(QLatin1String("created_at")).toString()));
+    m_createdAt = private_util::fromUtc(json.value(QLatin1String("created_at")).toString());
 }
 
 bool List::isValid() const
@@ -30,15 +30,22 @@
  */
 
 #include "listrepositorycontainer.h"
+#include "private/replydecoder.h"
 #include "private/repositoryquerycallback.h"
 #include "repositoryqueryhandlerfactory.h"
 
-ListRepositoryContainer::ListRepositoryContainer(IQueryExecutor::ConstPtr queryExecutor)
+ListRepositoryContainer::ListRepositoryContainer(IQueryExecutor::ConstPtr queryExecutor,
+                                                 QThreadPool *threadPool)
     : m_queryExecutor{std::move(queryExecutor)}
+    , m_decoder{new private_util::ReplyDecoder(threadPool)}
 {
     Q_ASSERT_X(m_queryExecutor, "ListQueryContainer", "NULL query executor");
 }
 
+ListRepositoryContainer::~ListRepositoryContainer()
+{
+}
+
 ListRepository * ListRepositoryContainer::repository(const Account &account, const Query &query)
 {
     auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
@@ -101,16 +108,32 @@ void ListRepositoryContainer::load(const ContainerKey &key, ListRepositoryContai
 
     mappingData.repository.start();
 
-    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, &mappingData, requestType](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
-        std::vector<List> items {};
-        private_util::RepositoryQueryCallback<List> callback {
-            requestType,
-            *mappingData.handler,
-            mappingData.repository,
-            items,
-            mappingData.loading
-        };
-        callback(reply, error, errorMessage);
+    private_util::RepositoryQueryCallback<List>::Ptr callback {
+        std::make_shared<private_util::RepositoryQueryCallback<List>>(requestType, mappingData.handler)
+    };
+    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, key, callback](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
+        Data *mappingData {getLoadingMappingData(key, callback->handler())};
+        if (mappingData == nullptr) {
+            return;
+        }
+        if (callback->treatError(mappingData->repository, reply, error, errorMessage)) {
+            mappingData->loading = false;
+            return;
+        }
+
+        // Decoding is done in the thread pool, while the result
+        // is placed in the repository in the current thread
+        QByteArray data {reply.readAll()};
+        m_decoder->decode([callback, data]() {
+            callback->decode(data);
+        }, [this, key, callback]() {
+            Data *mappingData {getLoadingMappingData(key, callback->handler())};
+            if (mappingData == nullptr) {
+                return;
+            }
+            mappingData->loading = false;
+            callback->apply(mappingData->repository);
+        });
     });
 }
 
@@ -132,6 +155,17 @@ ListRepositoryContainer::Data * ListRepositoryContainer::getMappingData(const Co
     return &(m_mapping.emplace(key, Data{std::move(handler)}).first->second);
 }
 
+ListRepositoryContainer::Data * ListRepositoryContainer::getLoadingMappingData(const ContainerKey &key,
+                                                                               const IRepositoryQueryHandler<List>::SharedPtr &handler)
+{
+    // The query might have been removed, or even added again, while loading
+    auto it = m_mapping.find(key);
+    if (it == std::end(m_mapping) || it->second.handler != handler) {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
 ListRepositoryContainer::Data::Data(IRepositoryQueryHandler<List>::Ptr &&inputHandler)
     : handler{std::move(inputHandler)}
 {
@@ -40,12 +40,19 @@
 #include "irepositorylistener.h"
 #include "listrepository.h"
 
+class QThreadPool;
 class Account;
 class List;
+namespace private_util {
+class ReplyDecoder;
+}
+
 class ListRepositoryContainer
 {
 public:
-    explicit ListRepositoryContainer(IQueryExecutor::ConstPtr queryExecutor);
+    explicit ListRepositoryContainer(IQueryExecutor::ConstPtr queryExecutor,
+                                     QThreadPool *threadPool = nullptr);
+    ~ListRepositoryContainer();
     DISABLE_COPY_DEFAULT_MOVE(ListRepositoryContainer);
     ListRepository * repository(const Account &account, const Query &query);
     void referenceQuery(const Account &account, const Query &query);
@@ -60,12 +67,15 @@ private:
         bool loading {false};
         ListRepository repository {};
         int refcount {0};
-        IRepositoryQueryHandler<List>::Ptr handler;
+        IRepositoryQueryHandler<List>::SharedPtr handler;
     };
     void load(const ContainerKey &key, Data &mappingData,
               IRepositoryQueryHandler<List>::RequestType requestType);
     Data * getMappingData(const ContainerKey &key);
+    Data * getLoadingMappingData(const ContainerKey &key,
+                                 const IRepositoryQueryHandler<List>::SharedPtr &handler);
     IQueryExecutor::ConstPtr m_queryExecutor {nullptr};
+    std::unique_ptr<private_util::ReplyDecoder> m_decoder {};
     std::map<ContainerKey, Data> m_mapping {};
 };
 
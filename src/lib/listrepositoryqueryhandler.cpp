@@ -30,6 +30,8 @@
  */
 
 #include "listrepositoryqueryhandler.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
 #include <QtCore/QUrl>
@@ -62,13 +64,13 @@ Query::Parameters ListRepositoryQueryHandler::additionalParameters(RequestType r
     return returned;
 }
 
-bool ListRepositoryQueryHandler::treatReply(RequestType requestType, const QByteArray &data,
+bool ListRepositoryQueryHandler::treatReply(RequestType requestType, QIODevice &reply,
                                             std::vector<List> &items, QString &errorMessage,
                                             Placement &placement)
 {
     Q_ASSERT_X(requestType == LoadMore, "ListRepositoryQueryHandler", "Refreshed is not implemented for List");
     QJsonParseError error {-1, QJsonParseError::NoError};
-    QJsonDocument document {QJsonDocument::fromJson(data, &error)};
+    QJsonDocument document {QJsonDocument::fromJson(reply.readAll(), &error)};
     if (error.error != QJsonParseError::NoError) {
         errorMessage = error.errorString();
         placement = Discard;
@@ -90,3 +92,21 @@ bool ListRepositoryQueryHandler::treatReply(RequestType requestType, const QByte
     }
     return true;
 }
+
+void ListRepositoryQueryHandler::saveState(QDataStream &stream) const
+{
+    stream << m_nextCursor;
+}
+
+void ListRepositoryQueryHandler::restoreState(QDataStream &stream, const std::vector<List> &items)
+{
+    Q_UNUSED(items);
+    stream >> m_nextCursor;
+}
+
+void ListRepositoryQueryHandler::synchronize(const Repository<List> &repository)
+{
+    // Cursor based pagination cannot be resumed from the
+    // items, so these repositories are not trimmed
+    Q_UNUSED(repository);
+}
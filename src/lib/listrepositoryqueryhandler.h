@@ -43,9 +43,12 @@ public:
 private:
     ListRepositoryQueryHandler();
     Query::Parameters additionalParameters(RequestType requestType) const override;
-    bool treatReply(RequestType requestType, const QByteArray &data,
+    bool treatReply(RequestType requestType, QIODevice &reply,
                     std::vector<List> &items, QString &errorMessage,
                     Placement &placement) override;
+    void saveState(QDataStream &stream) const override;
+    void restoreState(QDataStream &stream, const std::vector<List> &items) override;
+    void synchronize(const Repository<List> &repository) override;
     QString m_nextCursor {};
 };
 
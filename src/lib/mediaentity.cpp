@@ -30,13 +30,56 @@
  */
 
 #include "mediaentity.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QLoggingCategory>
 #include "entityvisitor.h"
+#include "private/jsonreader.h"
 
 static const QLoggingCategory logger {"media-entity"};
 
+static MediaEntity::Type parseMediaType(const QString &type)
+{
+    if (type == QLatin1String("photo")) {
+        return MediaEntity::Photo;
+    } else if (type == QLatin1String("video")) {
+        return MediaEntity::Video;
+    } else if (type == QLatin1String("animated_gif")) {
+        return MediaEntity::Gif;
+    } else {
+        qCDebug(logger) << "Unknown type" << type;
+        return MediaEntity::Invalid;
+    }
+}
+
+static void readLargeSize(private_util::JsonReader &reader, int &width, int &height)
+{
+    // Use "large" for size
+    if (!reader.beginObject()) {
+        return;
+    }
+    while (reader.nextName()) {
+        if (reader.name() != "large") {
+            reader.skipValue();
+            continue;
+        }
+        if (!reader.beginObject()) {
+            continue;
+        }
+        while (reader.nextName()) {
+            if (reader.name() == "w") {
+                width = reader.readInt();
+            } else if (reader.name() == "h") {
+                height = reader.readInt();
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+}
+
 MediaEntity::MediaEntity(const QJsonObject &json)
 {
+    readIndices(json);
     m_id = std::move(json.value(QLatin1String("id_str")).toString());
 
     m_text = std::move(json.value(QLatin1String("url")).toString());
@@ -44,16 +87,7 @@ MediaEntity::MediaEntity(const QJsonObject &json)
     m_expandedUrl = std::move(json.value(QLatin1String("expanded_url")).toString());
 
     m_mediaUrl = std::move(json.value(QLatin1String("media_url_https")).toString());
-    QString type {json.value(QLatin1String("type")).toString()};
-    if (type == QLatin1String("photo")) {
-        m_mediaType = Photo;
-    } else if (type == QLatin1String("video")) {
-        m_mediaType = Video;
-    } else if (type == QLatin1String("animated_gif")) {
-        m_mediaType = Gif;
-    } else {
-        qCDebug(logger) << "Unknown type" << type;
-    }
+    m_mediaType = parseMediaType(json.value(QLatin1String("type")).toString());
 
     // Use "large" for size
     QJsonObject sizes {json.value(QLatin1String("sizes")).toObject()};
@@ -66,6 +100,39 @@ MediaEntity::MediaEntity(const QJsonObject &json)
     }
 }
 
+MediaEntity::MediaEntity(private_util::JsonReader &reader)
+    : m_width(0), m_height(0)
+{
+    QString type {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "id_str") {
+                m_id = reader.readString();
+            } else if (name == "url") {
+                m_text = reader.readString();
+            } else if (name == "display_url") {
+                m_displayUrl = reader.readString();
+            } else if (name == "expanded_url") {
+                m_expandedUrl = reader.readString();
+            } else if (name == "media_url_https") {
+                m_mediaUrl = reader.readString();
+            } else if (name == "type") {
+                type = reader.readString();
+            } else if (name == "sizes") {
+                readLargeSize(reader, m_width, m_height);
+            } else if (name == "duration_millis") {
+                m_duration = reader.readInt();
+            } else if (name == "indices") {
+                readIndices(reader);
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    m_mediaType = parseMediaType(type);
+}
+
 bool MediaEntity::isValid() const
 {
     return !m_id.isEmpty() && !m_text.isEmpty() && !m_displayUrl.isEmpty() && !m_expandedUrl.isEmpty() && !m_mediaUrl.isEmpty();
@@ -129,3 +196,32 @@ void MediaEntity::accept(EntityVisitor &visitor) const
     visitor.visitMedia(*this);
 }
 
+QDataStream & operator<<(QDataStream &stream, const MediaEntity &entity)
+{
+    stream << entity.m_id;
+    stream << entity.m_text;
+    stream << entity.m_displayUrl;
+    stream << entity.m_expandedUrl;
+    stream << entity.m_mediaUrl;
+    stream << static_cast<qint32>(entity.m_mediaType);
+    stream << entity.m_width;
+    stream << entity.m_height;
+    stream << entity.m_duration;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, MediaEntity &entity)
+{
+    stream >> entity.m_id;
+    stream >> entity.m_text;
+    stream >> entity.m_displayUrl;
+    stream >> entity.m_expandedUrl;
+    stream >> entity.m_mediaUrl;
+    qint32 mediaType {MediaEntity::Invalid};
+    stream >> mediaType;
+    entity.m_mediaType = static_cast<MediaEntity::Type>(mediaType);
+    stream >> entity.m_width;
+    stream >> entity.m_height;
+    stream >> entity.m_duration;
+    return stream;
+}
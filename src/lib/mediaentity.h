@@ -47,6 +47,7 @@ public:
     };
     explicit MediaEntity() = default;
     explicit MediaEntity(const QJsonObject &json);
+    explicit MediaEntity(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(MediaEntity);
     bool isValid() const override;
     QString id() const;
@@ -60,6 +61,8 @@ public:
     int height() const;
     int duration() const;
     void accept(EntityVisitor &visitor) const override;
+    friend QDataStream & operator<<(QDataStream &stream, const MediaEntity &entity);
+    friend QDataStream & operator>>(QDataStream &stream, MediaEntity &entity);
 private:
     QString m_id {};
     QString m_text {};
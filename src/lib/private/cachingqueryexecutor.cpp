@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "cachingqueryexecutor.h"
+#include <algorithm>
+#include <vector>
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include "account.h"
+
+static const QLoggingCategory logger {"caching-query-executor"};
+static const quint32 MAGIC {0x54575243}; // "TWRC"
+static const quint32 VERSION {1};
+
+namespace private_util {
+
+double CachingQueryExecutor::Statistics::hitRate() const
+{
+    int total {hits + revalidations + misses};
+    if (total == 0) {
+        return 0.;
+    }
+    return static_cast<double>(hits + revalidations) / total;
+}
+
+CachingQueryExecutor::CachingQueryExecutor(IQueryExecutor::ConstPtr &&queryExecutor, const QString &dirPath,
+                                           qint64 maximumSize, const Clock &clock)
+    : m_queryExecutor(std::move(queryExecutor))
+    , m_state(std::make_shared<State>())
+{
+    Q_ASSERT_X(m_queryExecutor, "CachingQueryExecutor", "NULL query executor");
+    m_state->dirPath = dirPath;
+    m_state->maximumSize = maximumSize;
+    m_state->clock = clock ? clock : []() {
+        return QDateTime::currentMSecsSinceEpoch();
+    };
+    loadEntries();
+}
+
+IQueryExecutor::ConstPtr CachingQueryExecutor::create(IQueryExecutor::ConstPtr &&queryExecutor,
+                                                      const QString &dirPath, qint64 maximumSize,
+                                                      const Clock &clock)
+{
+    return IQueryExecutor::ConstPtr(new CachingQueryExecutor(std::move(queryExecutor), dirPath,
+                                                             maximumSize, clock));
+}
+
+QString CachingQueryExecutor::defaultDirPath()
+{
+    QDir dir {QStandardPaths::writableLocation(QStandardPaths::CacheLocation)};
+    return dir.absoluteFilePath(QLatin1String("replies"));
+}
+
+int CachingQueryExecutor::defaultTimeToLive(const QByteArray &path)
+{
+    // Timelines are loaded with since_id and max_id, and are not cached
+    static const std::map<QByteArray, int> timeToLive {
+        {"statuses/show.json", 30},
+        {"users/show.json", 60},
+        {"friends/list.json", 120},
+        {"followers/list.json", 120},
+        {"lists/subscriptions.json", 300},
+        {"lists/ownerships.json", 300},
+        {"lists/memberships.json", 300}
+    };
+    auto it = timeToLive.find(path);
+    return it != std::end(timeToLive) ? it->second : 0;
+}
+
+void CachingQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                   const std::map<QByteArray, QByteArray> &parameters,
+                                   const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    std::shared_ptr<State> state {m_state};
+    QString key {accountKey(account)};
+    if (type != Query::Get) {
+        m_queryExecutor->execute(type, path, parameters, account,
+                                 [state, key, callback](QIODevice &reply, QNetworkReply::NetworkError error,
+                                                        const QString &errorMessage) {
+            if (error == QNetworkReply::NoError) {
+                state->removeAccount(key);
+            }
+            callback(reply, error, errorMessage);
+        });
+        return;
+    }
+
+    int ttl {timeToLive(path)};
+    if (ttl <= 0) {
+        ++state->statistics.uncached;
+        m_queryExecutor->execute(type, path, parameters, account, callback);
+        return;
+    }
+
+    QString name {fileName(key, path, parameters)};
+    Reply cached {};
+    bool hasCached {state->loadReply(name, cached)};
+    if (hasCached && state->clock() - cached.storedAt < ttl * 1000) {
+        ++state->statistics.hits;
+        state->logStatistics();
+        QBuffer buffer {};
+        buffer.setData(cached.data);
+        buffer.open(QIODevice::ReadOnly);
+        callback(buffer, QNetworkReply::NoError, QString());
+        return;
+    }
+
+    std::map<QByteArray, QByteArray> headers {};
+    if (hasCached && !cached.etag.isEmpty()) {
+        headers.emplace("If-None-Match", cached.etag);
+    }
+    if (hasCached && !cached.lastModified.isEmpty()) {
+        headers.emplace("If-Modified-Since", cached.lastModified);
+    }
+
+    m_queryExecutor->execute(type, path, parameters, headers, account,
+                             [state, key, name, cached, hasCached, callback](QIODevice &reply,
+                                                                             QNetworkReply::NetworkError error,
+                                                                             const QString &errorMessage) {
+        QNetworkReply *networkReply {qobject_cast<QNetworkReply *>(&reply)};
+        int status {networkReply != nullptr
+                    ? networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() : 0};
+        Reply stored {};
+        if (hasCached && error == QNetworkReply::NoError && status == 304) {
+            ++state->statistics.revalidations;
+            stored = cached;
+        } else {
+            ++state->statistics.misses;
+            if (error != QNetworkReply::NoError) {
+                state->logStatistics();
+                callback(reply, error, errorMessage);
+                return;
+            }
+            stored.data = reply.readAll();
+            if (networkReply != nullptr) {
+                stored.etag = networkReply->rawHeader("ETag");
+                stored.lastModified = networkReply->rawHeader("Last-Modified");
+            }
+        }
+        state->logStatistics();
+        stored.storedAt = state->clock();
+        state->storeReply(key, name, stored);
+
+        QBuffer buffer {};
+        buffer.setData(stored.data);
+        buffer.open(QIODevice::ReadOnly);
+        callback(buffer, QNetworkReply::NoError, QString());
+    });
+}
+
+bool CachingQueryExecutor::isDeferred(Query::RequestType type, const QByteArray &path,
+                                      const std::map<QByteArray, QByteArray> &parameters,
+                                      const Account &account) const
+{
+    return m_queryExecutor->isDeferred(type, path, parameters, account);
+}
+
+int CachingQueryExecutor::timeToLive(const QByteArray &path) const
+{
+    auto it = m_timeToLive.find(path);
+    return it != std::end(m_timeToLive) ? it->second : defaultTimeToLive(path);
+}
+
+void CachingQueryExecutor::setTimeToLive(const QByteArray &path, int timeToLive)
+{
+    m_timeToLive[path] = timeToLive;
+}
+
+CachingQueryExecutor::Statistics CachingQueryExecutor::statistics() const
+{
+    return m_state->statistics;
+}
+
+qint64 CachingQueryExecutor::size() const
+{
+    return m_state->size;
+}
+
+QString CachingQueryExecutor::accountKey(const Account &account)
+{
+    return account.userId();
+}
+
+QString CachingQueryExecutor::fileName(const QString &accountKey, const QByteArray &path,
+                                       const std::map<QByteArray, QByteArray> &parameters)
+{
+    QCryptographicHash hash {QCryptographicHash::Sha1};
+    hash.addData(accountKey.toUtf8());
+    hash.addData(QByteArray(" ") + path);
+    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
+        hash.addData(QByteArray("&") + parameter.first + "=" + parameter.second);
+    }
+    return QLatin1String(hash.result().toHex());
+}
+
+void CachingQueryExecutor::loadEntries()
+{
+    QDir dir {m_state->dirPath};
+    for (const QFileInfo &info : dir.entryInfoList(QDir::Files)) {
+        QFile file {info.absoluteFilePath()};
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QDataStream stream {&file};
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic {0};
+        quint32 version {0};
+        Entry entry {};
+        stream >> magic >> version >> entry.accountKey >> entry.storedAt;
+        if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION) {
+            qCDebug(logger) << "Removing cached reply with unknown format" << file.fileName();
+            file.remove();
+            continue;
+        }
+        entry.size = info.size();
+        m_state->size += entry.size;
+        m_state->entries.emplace(info.fileName(), entry);
+    }
+    qCDebug(logger) << "Loaded" << m_state->entries.size() << "cached replies," << m_state->size << "bytes";
+}
+
+qint64 CachingQueryExecutor::State::replySize(const Reply &reply)
+{
+    return reply.etag.size() + reply.lastModified.size() + reply.data.size();
+}
+
+bool CachingQueryExecutor::State::loadReply(const QString &fileName, Reply &reply)
+{
+    auto it = entries.find(fileName);
+    if (it == std::end(entries)) {
+        return false;
+    }
+    if (it->second.reply) {
+        it->second.usedAt = clock();
+        reply = *it->second.reply;
+        return true;
+    }
+
+    QFile file {QDir(dirPath).absoluteFilePath(fileName)};
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream {&file};
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic {0};
+    quint32 version {0};
+    QString accountKey {};
+    stream >> magic >> version >> accountKey >> reply.storedAt >> reply.etag >> reply.lastModified >> reply.data;
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION) {
+        return false;
+    }
+    keepInMemory(it->second, reply);
+    return true;
+}
+
+void CachingQueryExecutor::State::storeReply(const QString &accountKey, const QString &fileName,
+                                             const Reply &reply)
+{
+    if (!QDir().mkpath(dirPath)) {
+        qCWarning(logger) << "Failed to create cache directory" << dirPath;
+        return;
+    }
+
+    QSaveFile file {QDir(dirPath).absoluteFilePath(fileName)};
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(logger) << "Failed to open cache file" << file.fileName();
+        return;
+    }
+    QDataStream stream {&file};
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << MAGIC << VERSION << accountKey << reply.storedAt << reply.etag << reply.lastModified << reply.data;
+    qint64 fileSize {file.size()};
+    if (!file.commit()) {
+        qCWarning(logger) << "Failed to write cache file" << file.fileName();
+        return;
+    }
+
+    auto it = entries.find(fileName);
+    if (it != std::end(entries)) {
+        size -= it->second.size;
+    }
+    Entry &entry (entries[fileName]);
+    entry.accountKey = accountKey;
+    entry.storedAt = reply.storedAt;
+    entry.size = fileSize;
+    size += fileSize;
+    keepInMemory(entry, reply);
+
+    // The oldest replies are removed first
+    while (size > maximumSize && !entries.empty()) {
+        auto oldest = std::min_element(std::begin(entries), std::end(entries),
+                                       [](const std::pair<const QString, Entry> &first,
+                                          const std::pair<const QString, Entry> &second) {
+            return first.second.storedAt < second.second.storedAt;
+        });
+        removeReply(oldest->first);
+    }
+}
+
+void CachingQueryExecutor::State::removeReply(const QString &fileName)
+{
+    auto it = entries.find(fileName);
+    if (it == std::end(entries)) {
+        return;
+    }
+    size -= it->second.size;
+    releaseMemory(it->second);
+    entries.erase(it);
+    QFile::remove(QDir(dirPath).absoluteFilePath(fileName));
+}
+
+void CachingQueryExecutor::State::keepInMemory(Entry &entry, const Reply &reply)
+{
+    releaseMemory(entry);
+    qint64 replyMemorySize {replySize(reply)};
+    if (replyMemorySize > maximumMemorySize) {
+        return;
+    }
+    entry.reply = std::make_shared<const Reply>(reply);
+    entry.usedAt = clock();
+    memorySize += replyMemorySize;
+
+    // The least recently used replies are only kept on disk
+    while (memorySize > maximumMemorySize) {
+        Entry *leastRecentlyUsed {nullptr};
+        for (std::pair<const QString, Entry> &it : entries) {
+            if (it.second.reply && (leastRecentlyUsed == nullptr || it.second.usedAt < leastRecentlyUsed->usedAt)) {
+                leastRecentlyUsed = &it.second;
+            }
+        }
+        if (leastRecentlyUsed == nullptr) {
+            break;
+        }
+        releaseMemory(*leastRecentlyUsed);
+    }
+}
+
+void CachingQueryExecutor::State::releaseMemory(Entry &entry)
+{
+    if (entry.reply) {
+        memorySize -= replySize(*entry.reply);
+        entry.reply.reset();
+    }
+}
+
+void CachingQueryExecutor::State::removeAccount(const QString &accountKey)
+{
+    std::vector<QString> fileNames {};
+    for (const std::pair<const QString, Entry> &entry : entries) {
+        if (entry.second.accountKey == accountKey) {
+            fileNames.push_back(entry.first);
+        }
+    }
+    for (const QString &fileName : fileNames) {
+        removeReply(fileName);
+    }
+}
+
+void CachingQueryExecutor::State::logStatistics() const
+{
+    qCDebug(logger) << "Hit rate:" << statistics.hitRate() << "(" << statistics.hits << "hits,"
+                    << statistics.revalidations << "revalidations," << statistics.misses << "misses,"
+                    << statistics.uncached << "uncached queries)," << size << "bytes";
+}
+
+}
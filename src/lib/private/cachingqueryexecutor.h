@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef CACHINGQUERYEXECUTOR_H
+#define CACHINGQUERYEXECUTOR_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <QtCore/QString>
+#include "iqueryexecutor.h"
+
+namespace private_util {
+
+/**
+ * @brief An executor that caches the replies of GET queries
+ *
+ * Replies are stored on disk, in a directory whose size is
+ * capped. The least recently stored replies are removed when
+ * the cap is reached. The most recently used replies are also
+ * kept in memory, up to DefaultMaximumMemorySize bytes, so that
+ * the hot replies are not read from the disk.
+ *
+ * Each path has a time to live, see timeToLive(). Paths with
+ * no time to live, like the timelines, are not cached. A reply
+ * that is younger than its time to live is served without using
+ * the network. An older reply is revalidated with a conditional
+ * request, using the ETag and Last-Modified headers of the reply,
+ * and is served again if the server answers 304 Not Modified.
+ *
+ * POST queries change the state of the account, so they remove
+ * every reply cached for this account.
+ */
+class CachingQueryExecutor final : public IQueryExecutor
+{
+public:
+    using Clock = std::function<qint64 ()>;
+    static const qint64 DefaultMaximumSize = 10 * 1024 * 1024;
+    static const qint64 DefaultMaximumMemorySize = 1024 * 1024;
+    struct Statistics
+    {
+        int hits {0};
+        int revalidations {0};
+        int misses {0};
+        int uncached {0};
+        /**
+         * @brief Ratio of the cacheable queries that were served from the cache
+         *
+         * Revalidated replies are counted as hits.
+         *
+         * @return hit rate, between 0 and 1.
+         */
+        double hitRate() const;
+    };
+    /**
+     * @brief Create a caching executor
+     * @param queryExecutor executor that is used to send the queries.
+     * @param dirPath directory where replies are stored.
+     * @param maximumSize maximum size of the stored replies, in bytes.
+     * @param clock clock returning the current time in ms, that can be replaced in tests.
+     * @return a caching executor.
+     */
+    static IQueryExecutor::ConstPtr create(IQueryExecutor::ConstPtr &&queryExecutor, const QString &dirPath,
+                                           qint64 maximumSize = DefaultMaximumSize,
+                                           const Clock &clock = Clock());
+    static QString defaultDirPath();
+    /**
+     * @brief Default time to live of the replies of a path
+     * @param path path of the query.
+     * @return time to live in seconds, or 0 if the replies are not cached.
+     */
+    static int defaultTimeToLive(const QByteArray &path);
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override;
+    bool isDeferred(Query::RequestType type, const QByteArray &path,
+                    const std::map<QByteArray, QByteArray> &parameters,
+                    const Account &account) const override;
+    int timeToLive(const QByteArray &path) const;
+    void setTimeToLive(const QByteArray &path, int timeToLive);
+    Statistics statistics() const;
+    qint64 size() const;
+private:
+    struct Reply
+    {
+        qint64 storedAt {0};
+        QByteArray etag {};
+        QByteArray lastModified {};
+        QByteArray data {};
+    };
+    struct Entry
+    {
+        QString accountKey {};
+        qint64 storedAt {0};
+        qint64 size {0};
+        // Copy of the reply, for the most recently used entries
+        std::shared_ptr<const Reply> reply {};
+        qint64 usedAt {0};
+    };
+    // Shared with the callbacks, that might be called
+    // after the executor is destroyed
+    struct State
+    {
+        bool loadReply(const QString &fileName, Reply &reply);
+        void storeReply(const QString &accountKey, const QString &fileName, const Reply &reply);
+        void removeReply(const QString &fileName);
+        void keepInMemory(Entry &entry, const Reply &reply);
+        void releaseMemory(Entry &entry);
+        static qint64 replySize(const Reply &reply);
+        void removeAccount(const QString &accountKey);
+        void logStatistics() const;
+        QString dirPath {};
+        qint64 maximumSize {DefaultMaximumSize};
+        qint64 memorySize {0};
+        qint64 maximumMemorySize {DefaultMaximumMemorySize};
+        Clock clock {};
+        std::map<QString, Entry> entries {};
+        qint64 size {0};
+        Statistics statistics {};
+    };
+    explicit CachingQueryExecutor(IQueryExecutor::ConstPtr &&queryExecutor, const QString &dirPath,
+                                  qint64 maximumSize, const Clock &clock);
+    static QString accountKey(const Account &account);
+    static QString fileName(const QString &accountKey, const QByteArray &path,
+                            const std::map<QByteArray, QByteArray> &parameters);
+    void loadEntries();
+    IQueryExecutor::ConstPtr m_queryExecutor {};
+    std::map<QByteArray, int> m_timeToLive {};
+    std::shared_ptr<State> m_state {};
+};
+
+}
+
+#endif // CACHINGQUERYEXECUTOR_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "coalescingqueryexecutor.h"
+#include <QtCore/QBuffer>
+#include <QtCore/QLoggingCategory>
+#include "account.h"
+
+static const QLoggingCategory logger {"coalescing-query-executor"};
+
+namespace private_util {
+
+CoalescingQueryExecutor::CoalescingQueryExecutor(IQueryExecutor::ConstPtr &&queryExecutor)
+    : m_queryExecutor(std::move(queryExecutor))
+    , m_state(std::make_shared<State>())
+{
+    Q_ASSERT_X(m_queryExecutor, "CoalescingQueryExecutor", "NULL query executor");
+}
+
+IQueryExecutor::ConstPtr CoalescingQueryExecutor::create(IQueryExecutor::ConstPtr &&queryExecutor)
+{
+    return IQueryExecutor::ConstPtr(new CoalescingQueryExecutor(std::move(queryExecutor)));
+}
+
+void CoalescingQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                      const std::map<QByteArray, QByteArray> &parameters,
+                                      const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    if (type != Query::Get) {
+        m_queryExecutor->execute(type, path, parameters, account, callback);
+        return;
+    }
+
+    Key key {path, parameters, account.userId(), account.token()};
+    auto it = m_state->pending.find(key);
+    if (it != std::end(m_state->pending)) {
+        ++m_state->coalescedCount;
+        qCDebug(logger) << "Merged with the request in flight:" << path;
+        it->second.push_back(callback);
+        return;
+    }
+
+    // The entry is added before executing, since the
+    // callback might be called during the execution
+    m_state->pending.emplace(key, std::vector<Callback_t>{callback});
+    std::shared_ptr<State> state {m_state};
+    m_queryExecutor->execute(type, path, parameters, account,
+                             [state, key](QIODevice &reply, QNetworkReply::NetworkError error,
+                                          const QString &errorMessage) {
+        auto it = state->pending.find(key);
+        if (it == std::end(state->pending)) {
+            return;
+        }
+        // Callbacks might execute the same query again, that
+        // should then be sent, so the entry is removed first
+        std::vector<Callback_t> callbacks {std::move(it->second)};
+        state->pending.erase(it);
+
+        if (callbacks.size() == 1) {
+            callbacks.front()(reply, error, errorMessage);
+            return;
+        }
+
+        QByteArray data {reply.readAll()};
+        for (const Callback_t &callback : callbacks) {
+            QBuffer buffer {};
+            buffer.setData(data);
+            buffer.open(QIODevice::ReadOnly);
+            callback(buffer, error, errorMessage);
+        }
+    });
+}
+
+bool CoalescingQueryExecutor::isDeferred(Query::RequestType type, const QByteArray &path,
+                                         const std::map<QByteArray, QByteArray> &parameters,
+                                         const Account &account) const
+{
+    return m_queryExecutor->isDeferred(type, path, parameters, account);
+}
+
+int CoalescingQueryExecutor::pendingCount() const
+{
+    return static_cast<int>(m_state->pending.size());
+}
+
+int CoalescingQueryExecutor::coalescedCount() const
+{
+    return m_state->coalescedCount;
+}
+
+}
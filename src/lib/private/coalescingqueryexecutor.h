@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef COALESCINGQUERYEXECUTOR_H
+#define COALESCINGQUERYEXECUTOR_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "iqueryexecutor.h"
+
+namespace private_util {
+
+/**
+ * @brief An executor that merges identical queries in flight
+ *
+ * When a GET query is executed while the same query, for the
+ * same account, is still in flight, no new request is sent.
+ * The reply of the request in flight is given to every callback
+ * instead.
+ *
+ * POST queries are not idempotent, and are always sent.
+ *
+ * To merge the queries of several containers, this executor
+ * should be shared with a SharedQueryExecutor.
+ */
+class CoalescingQueryExecutor final : public IQueryExecutor
+{
+public:
+    static IQueryExecutor::ConstPtr create(IQueryExecutor::ConstPtr &&queryExecutor);
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override;
+    bool isDeferred(Query::RequestType type, const QByteArray &path,
+                    const std::map<QByteArray, QByteArray> &parameters,
+                    const Account &account) const override;
+    /**
+     * @brief Number of requests in flight
+     * @return number of requests in flight.
+     */
+    int pendingCount() const;
+    /**
+     * @brief Number of queries that were merged with a request in flight
+     * @return number of merged queries.
+     */
+    int coalescedCount() const;
+private:
+    using Key = std::tuple<QByteArray, std::map<QByteArray, QByteArray>, QString, QByteArray>;
+    struct State
+    {
+        std::map<Key, std::vector<Callback_t>> pending {};
+        int coalescedCount {0};
+    };
+    explicit CoalescingQueryExecutor(IQueryExecutor::ConstPtr &&queryExecutor);
+    IQueryExecutor::ConstPtr m_queryExecutor {};
+    std::shared_ptr<State> m_state {};
+};
+
+}
+
+#endif // COALESCINGQUERYEXECUTOR_H
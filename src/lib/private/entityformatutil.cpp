@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "entityformatutil.h"
+#include <algorithm>
+#include <vector>
+#include "entityvisitor.h"
+#include "hashtagentity.h"
+#include "mediaentity.h"
+#include "urlentity.h"
+#include "usermentionentity.h"
+
+namespace private_util
+{
+
+namespace
+{
+
+struct Token
+{
+    QString text {};
+    QString replacement {};
+    Qt::CaseSensitivity caseSensitivity {Qt::CaseSensitive};
+    bool wordBoundary {false};
+};
+
+struct Candidate
+{
+    int start;
+    Token token;
+};
+
+struct Span
+{
+    int start;
+    int end;
+    QString replacement;
+};
+
+// Describes the text captured by an entity, and what replaces it
+class TokenVisitor: public EntityVisitor
+{
+public:
+    explicit TokenVisitor(bool includeLinks)
+        : m_includeLinks(includeLinks)
+    {
+    }
+    Token token() const
+    {
+        return m_token;
+    }
+    void visitMedia(const MediaEntity &entity) override
+    {
+        setUrl(entity.text(), entity.expandedUrl(), entity.displayUrl());
+    }
+    void visitUrl(const UrlEntity &entity) override
+    {
+        setUrl(entity.text(), entity.expandedUrl(), entity.displayUrl());
+    }
+    void visitUserMention(const UserMentionEntity &entity) override
+    {
+        if (m_includeLinks) {
+            m_token.text = entity.text();
+            m_token.replacement = QString(QLatin1String("<a href=\"user://%1\">@%2</a>")).arg(entity.id(), entity.screenName());
+            m_token.caseSensitivity = Qt::CaseInsensitive;
+            m_token.wordBoundary = true;
+        }
+    }
+    void visitHashtag(const HashtagEntity &entity) override
+    {
+        if (m_includeLinks) {
+            m_token.text = QString(QLatin1String("#%1")).arg(entity.text());
+            m_token.replacement = QString(QLatin1String("<a href=\"hashtag://%1\">#%1</a>")).arg(entity.text());
+            m_token.caseSensitivity = Qt::CaseInsensitive;
+            m_token.wordBoundary = true;
+        }
+    }
+private:
+    void setUrl(const QString &text, const QString &expandedUrl, const QString &displayUrl)
+    {
+        m_token.text = text;
+        if (m_includeLinks) {
+            m_token.replacement = QString(QLatin1String("<a href=\"%1\">%2</a>")).arg(expandedUrl, displayUrl);
+        } else {
+            m_token.replacement = displayUrl;
+        }
+    }
+    bool m_includeLinks {false};
+    Token m_token {};
+};
+
+}
+
+static QString unescape(const QString &input)
+{
+    QString returned {};
+    returned.reserve(input.size());
+    int i = 0;
+    while (i < input.size()) {
+        const QChar &character (input.at(i));
+        if (character == QLatin1Char('&')) {
+            const QStringRef &rest (input.midRef(i));
+            if (rest.startsWith(QLatin1String("&lt;"))) {
+                returned.append(QLatin1Char('<'));
+                i += 4;
+                continue;
+            } else if (rest.startsWith(QLatin1String("&gt;"))) {
+                returned.append(QLatin1Char('>'));
+                i += 4;
+                continue;
+            } else if (rest.startsWith(QLatin1String("&amp;"))) {
+                returned.append(QLatin1Char('&'));
+                i += 5;
+                continue;
+            }
+        }
+        returned.append(character);
+        ++i;
+    }
+    return returned;
+}
+
+static void appendEscaped(QString &output, const QString &text, int from, int to)
+{
+    // Same escaping as QString::toHtmlEscaped()
+    for (int i = from; i < to; ++i) {
+        const QChar &character (text.at(i));
+        switch (character.unicode()) {
+        case '<':
+            output.append(QLatin1String("&lt;"));
+            break;
+        case '>':
+            output.append(QLatin1String("&gt;"));
+            break;
+        case '&':
+            output.append(QLatin1String("&amp;"));
+            break;
+        case '"':
+            output.append(QLatin1String("&quot;"));
+            break;
+        default:
+            output.append(character);
+            break;
+        }
+    }
+}
+
+static bool isWordCharacter(const QChar &character)
+{
+    return character.isLetterOrNumber() || character == QLatin1Char('_');
+}
+
+static bool matches(const QString &text, int position, const Token &token)
+{
+    int end = position + token.text.size();
+    if (end > text.size()) {
+        return false;
+    }
+    if (token.wordBoundary && end < text.size() && isWordCharacter(text.at(end))) {
+        return false;
+    }
+    return text.midRef(position, token.text.size()).compare(token.text, token.caseSensitivity) == 0;
+}
+
+// Moves a code point position, and the matching UTF-16 position forward
+static void advance(const QString &text, int codePoint, int &currentCodePoint, int &position)
+{
+    while (currentCodePoint < codePoint && position < text.size()) {
+        if (text.at(position).isHighSurrogate() && position + 1 < text.size()
+            && text.at(position + 1).isLowSurrogate()) {
+            ++position;
+        }
+        ++position;
+        ++currentCodePoint;
+    }
+}
+
+static void append(QString &output, const QString &text, int from, int to, bool escape)
+{
+    if (escape) {
+        appendEscaped(output, text, from, to);
+    } else {
+        output.append(text.midRef(from, to - from));
+    }
+}
+
+static QString format(const QString &input, const Entity::List &entities, bool includeLinks, bool escape)
+{
+    const QString text {unescape(input)};
+
+    std::vector<Candidate> candidates {};
+    for (const Entity::Ptr &entity : entities) {
+        if (!entity || !entity->isValid()) {
+            continue;
+        }
+        TokenVisitor visitor {includeLinks};
+        entity->accept(visitor);
+        Token token {visitor.token()};
+        if (!token.text.isEmpty()) {
+            candidates.push_back(Candidate {entity->start(), std::move(token)});
+        }
+    }
+
+    // Indices are converted in increasing order, so that code points
+    // are only counted once
+    std::sort(std::begin(candidates), std::end(candidates), [](const Candidate &first, const Candidate &second) {
+        return first.start < second.start;
+    });
+
+    std::vector<Span> spans {};
+    int codePoint {0};
+    int position {0};
+    for (const Candidate &candidate : candidates) {
+        const Token &token (candidate.token);
+        if (candidate.start >= 0) {
+            advance(text, candidate.start, codePoint, position);
+            if (codePoint == candidate.start && matches(text, position, token)) {
+                spans.push_back(Span {position, position + token.text.size(), token.replacement});
+                continue;
+            }
+        }
+
+        // Without usable indices, every occurrence is replaced
+        int from = text.indexOf(token.text, 0, token.caseSensitivity);
+        while (from >= 0) {
+            if (matches(text, from, token)) {
+                spans.push_back(Span {from, from + token.text.size(), token.replacement});
+            }
+            from = text.indexOf(token.text, from + token.text.size(), token.caseSensitivity);
+        }
+    }
+
+    // Longer entities are preferred when entities overlap
+    std::sort(std::begin(spans), std::end(spans), [](const Span &first, const Span &second) {
+        return first.start < second.start || (first.start == second.start && first.end > second.end);
+    });
+
+    QString returned {};
+    returned.reserve(text.size() + text.size() / 2);
+    int current {0};
+    for (const Span &span : spans) {
+        if (span.start < current) {
+            continue;
+        }
+        append(returned, text, current, span.start, escape);
+        returned.append(span.replacement);
+        current = span.end;
+    }
+    append(returned, text, current, text.size(), escape);
+    return returned;
+}
+
+QString formatEntities(const QString &input, const Entity::List &entities, bool includeLinks)
+{
+    return format(input, entities, includeLinks, true);
+}
+
+QString formatPlainText(const QString &input, const Entity::List &entities)
+{
+    return format(input, entities, false, false);
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef ENTITYFORMATUTIL_H
+#define ENTITYFORMATUTIL_H
+
+#include <QtCore/QString>
+#include "entity.h"
+
+namespace private_util
+{
+
+/**
+ * @brief Format a text and its entities as rich text
+ *
+ * The input text is the text as sent by Twitter, where
+ * <, > and & are escaped. The returned text is HTML escaped,
+ * and entities are replaced by links, or by their display
+ * text.
+ *
+ * Entities are located using their indices, and the output
+ * is built in a single pass over the text. Entities whose
+ * indices do not match the text are searched instead.
+ *
+ * @param input text to format.
+ * @param entities entities in the text.
+ * @param includeLinks if entities should be formatted as links.
+ * @return formatted text.
+ */
+QString formatEntities(const QString &input, const Entity::List &entities, bool includeLinks);
+/**
+ * @brief Format a text and its entities as plain text
+ *
+ * The returned text is unescaped, and links are replaced
+ * by their display text.
+ *
+ * @param input text to format.
+ * @param entities entities in the text.
+ * @return formatted text.
+ */
+QString formatPlainText(const QString &input, const Entity::List &entities);
+
+}
+
+#endif // ENTITYFORMATUTIL_H
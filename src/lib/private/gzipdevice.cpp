@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "gzipdevice.h"
+#include <algorithm>
+#include <limits>
+#include <QtCore/QBuffer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QtEndian>
+#include <zlib.h>
+
+static const QLoggingCategory logger {"gzip-device"};
+
+namespace private_util {
+
+GzipDevice::GzipDevice(QIODevice &source)
+    : m_source(source), m_stream(new z_stream_s())
+{
+}
+
+GzipDevice::~GzipDevice()
+{
+    close();
+}
+
+bool GzipDevice::isCompressed(const QByteArray &data)
+{
+    return data.size() >= 2 && static_cast<uchar>(data.at(0)) == 0x1f && static_cast<uchar>(data.at(1)) == 0x8b;
+}
+
+qint64 GzipDevice::decompressedSize(const QByteArray &data)
+{
+    // The gzip trailer ends with the decompressed size, modulo 2^32
+    static const int TrailerSize = 8;
+    if (!isCompressed(data) || data.size() < TrailerSize) {
+        return -1;
+    }
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data.constData() + data.size() - 4));
+}
+
+QByteArray GzipDevice::decompress(const QByteArray &data)
+{
+    if (!isCompressed(data)) {
+        return data;
+    }
+    QBuffer buffer {};
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    GzipDevice device {buffer};
+    device.open(QIODevice::ReadOnly);
+    return device.readAll();
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+    if ((mode & QIODevice::ReadWrite) != QIODevice::ReadOnly) {
+        setErrorString(QLatin1String("Only reading is supported"));
+        return false;
+    }
+    if (!m_source.isOpen() && !m_source.open(QIODevice::ReadOnly)) {
+        setErrorString(m_source.errorString());
+        return false;
+    }
+
+    *m_stream = z_stream_s();
+    // 16 + MAX_WBITS only accepts data with a gzip header
+    if (inflateInit2(m_stream.get(), 16 + MAX_WBITS) != Z_OK) {
+        setErrorString(QLatin1String("Cannot initialize zlib"));
+        return false;
+    }
+    m_finished = false;
+    return QIODevice::open(mode);
+}
+
+void GzipDevice::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    inflateEnd(m_stream.get());
+    m_input.clear();
+    QIODevice::close();
+}
+
+bool GzipDevice::isSequential() const
+{
+    return true;
+}
+
+bool GzipDevice::atEnd() const
+{
+    return m_finished && QIODevice::atEnd();
+}
+
+qint64 GzipDevice::readData(char *data, qint64 maxSize)
+{
+    if (m_finished) {
+        return 0;
+    }
+
+    uInt size {static_cast<uInt>(std::min<qint64>(maxSize, std::numeric_limits<uInt>::max()))};
+    m_stream->next_out = reinterpret_cast<Bytef *>(data);
+    m_stream->avail_out = size;
+    while (m_stream->avail_out > 0) {
+        if (m_stream->avail_in == 0) {
+            if (m_input.size() != ChunkSize) {
+                m_input.resize(ChunkSize);
+            }
+            qint64 read {m_source.read(m_input.data(), ChunkSize)};
+            if (read <= 0) {
+                qCWarning(logger) << "Compressed data is truncated";
+                setErrorString(QLatin1String("Compressed data is truncated"));
+                m_finished = true;
+                break;
+            }
+            m_stream->next_in = reinterpret_cast<Bytef *>(m_input.data());
+            m_stream->avail_in = static_cast<uInt>(read);
+        }
+
+        int result {inflate(m_stream.get(), Z_NO_FLUSH)};
+        if (result == Z_STREAM_END) {
+            m_finished = true;
+            break;
+        } else if (result != Z_OK) {
+            qCWarning(logger) << "Invalid compressed data:" << result;
+            setErrorString(QLatin1String("Invalid compressed data"));
+            m_finished = true;
+            return -1;
+        }
+    }
+    return size - m_stream->avail_out;
+}
+
+qint64 GzipDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(maxSize)
+    return -1;
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef GZIPDEVICE_H
+#define GZIPDEVICE_H
+
+#include <memory>
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+
+struct z_stream_s;
+
+namespace private_util {
+
+/**
+ * @brief A device that decompresses gzip data
+ *
+ * Replies are requested with "Accept-Encoding: gzip", so that
+ * Twitter sends them compressed. This device reads the compressed
+ * data from the source device by chunks, and inflates them while
+ * they are read, so that a reply can be parsed without building
+ * the decompressed reply in memory.
+ *
+ * Compressed replies are recognized with isCompressed(), as the
+ * headers of the reply are not kept by every executor.
+ */
+class GzipDevice final : public QIODevice
+{
+public:
+    // Size of the chunks read from the source device
+    static const int ChunkSize = 16 * 1024;
+    /**
+     * @brief Constructor
+     * @param source device to read the compressed data from.
+     */
+    explicit GzipDevice(QIODevice &source);
+    ~GzipDevice();
+    /**
+     * @brief If data is compressed with gzip
+     * @param data data to check.
+     * @return if data starts with the gzip header.
+     */
+    static bool isCompressed(const QByteArray &data);
+    /**
+     * @brief Decompressed size of gzip data
+     *
+     * The size is read from the end of the gzip data, without
+     * decompressing it.
+     *
+     * @param data data compressed with gzip.
+     * @return decompressed size, or -1 if data is not compressed.
+     */
+    static qint64 decompressedSize(const QByteArray &data);
+    /**
+     * @brief Decompress data if it is compressed with gzip
+     *
+     * This should only be used for small replies, like errors.
+     *
+     * @param data data to decompress.
+     * @return decompressed data, or data if it is not compressed.
+     */
+    static QByteArray decompress(const QByteArray &data);
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    bool atEnd() const override;
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+private:
+    QIODevice &m_source;
+    std::unique_ptr<z_stream_s> m_stream;
+    QByteArray m_input {};
+    bool m_finished {false};
+};
+
+}
+
+#endif // GZIPDEVICE_H
@@ -39,6 +39,7 @@
 #include <QtCore/QLoggingCategory>
 #include <QtNetwork/QNetworkReply>
 #include "debughelper.h"
+#include "gzipdevice.h"
 #include "iitemqueryhandler.h"
 #include "iitemlistener.h"
 
@@ -61,7 +62,7 @@ public:
             qCWarning(iqcLogger) << "Network error";
             qCWarning(iqcLogger) << "  Error code:" << error;
             qCWarning(iqcLogger) << "  Error message (Qt):" << errorMessage;
-            const QByteArray &data {reply.readAll()};
+            const QByteArray &data {GzipDevice::decompress(reply.readAll())};
             qCWarning(iqcLogger) << "  Error message (Twitter):" << data;
 
             QString newErrorMessage {};
@@ -75,7 +76,7 @@ public:
 
         T item {};
         QString newErrorMessage {};
-        bool returned = m_handler.treatReply(reply.readAll(), item, newErrorMessage);
+        bool returned = m_handler.treatReply(GzipDevice::decompress(reply.readAll()), item, newErrorMessage);
         if (!returned) {
             qCWarning(iqcLogger) << "Parsing error: " << newErrorMessage;
             doError(QObject::tr("Internal error"));
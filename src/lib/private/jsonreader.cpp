@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "jsonreader.h"
+#include <limits>
+#include <QtCore/QIODevice>
+
+namespace private_util
+{
+
+JsonReader::JsonReader(QIODevice &device)
+    : m_device(&device)
+{
+}
+
+JsonReader::JsonReader(const QByteArray &data)
+    : m_buffer(data), m_data(m_buffer.constData()), m_size(m_buffer.size())
+{
+}
+
+bool JsonReader::hasError() const
+{
+    return m_error;
+}
+
+QString JsonReader::errorString() const
+{
+    return m_errorString;
+}
+
+JsonReader::Type JsonReader::peek()
+{
+    skipWhitespaces();
+    switch (peekChar()) {
+    case '{':
+        return Object;
+    case '[':
+        return Array;
+    case '"':
+        return String;
+    case 't':
+    case 'f':
+        return Bool;
+    case 'n':
+        return Null;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return Number;
+    default:
+        return Invalid;
+    }
+}
+
+bool JsonReader::beginObject()
+{
+    if (peek() != Object) {
+        skipValue();
+        return false;
+    }
+    getChar();
+    return true;
+}
+
+bool JsonReader::nextName()
+{
+    skipWhitespaces();
+    char c {peekChar()};
+    if (c == '}') {
+        getChar();
+        return false;
+    }
+    if (c == ',') {
+        getChar();
+        skipWhitespaces();
+        c = peekChar();
+    }
+    if (c != '"') {
+        setError(ensure() ? "member name expected" : "unexpected end of data");
+        return false;
+    }
+    getChar();
+
+    // Member names are short and ASCII, escapes are only unquoted
+    m_name.clear();
+    while (true) {
+        if (!ensure()) {
+            setError("unterminated member name");
+            return false;
+        }
+        c = m_data[m_pos++];
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            c = getChar();
+        }
+        m_name.append(c);
+    }
+
+    skipWhitespaces();
+    return expect(':');
+}
+
+const QByteArray & JsonReader::name() const
+{
+    return m_name;
+}
+
+bool JsonReader::beginArray()
+{
+    if (peek() != Array) {
+        skipValue();
+        return false;
+    }
+    getChar();
+    return true;
+}
+
+bool JsonReader::hasNext()
+{
+    skipWhitespaces();
+    char c {peekChar()};
+    if (c == ']') {
+        getChar();
+        return false;
+    }
+    if (c == ',') {
+        getChar();
+    }
+    if (!ensure()) {
+        setError("unexpected end of data");
+        return false;
+    }
+    return true;
+}
+
+QString JsonReader::readString()
+{
+    if (peek() != String) {
+        skipValue();
+        return QString();
+    }
+    QString returned {};
+    readRawString(&returned);
+    return returned;
+}
+
+double JsonReader::readDouble()
+{
+    if (peek() != Number) {
+        skipValue();
+        return 0.;
+    }
+    readRawNumber(m_scratch);
+    bool ok {false};
+    double returned {m_scratch.toDouble(&ok)};
+    if (!ok) {
+        setError("invalid number");
+        return 0.;
+    }
+    return returned;
+}
+
+int JsonReader::readInt()
+{
+    // Same conversion rules as QJsonValue::toInt()
+    double value {readDouble()};
+    if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+        return 0;
+    }
+    int returned {static_cast<int>(value)};
+    return returned == value ? returned : 0;
+}
+
+bool JsonReader::readBool()
+{
+    if (peek() != Bool) {
+        skipValue();
+        return false;
+    }
+    if (peekChar() == 't') {
+        return expectLiteral("true");
+    }
+    expectLiteral("false");
+    return false;
+}
+
+void JsonReader::skipValue()
+{
+    switch (peek()) {
+    case Null:
+        expectLiteral("null");
+        break;
+    case Bool:
+        expectLiteral(peekChar() == 't' ? "true" : "false");
+        break;
+    case Number:
+        readRawNumber(m_scratch);
+        break;
+    case String:
+        readRawString(nullptr);
+        break;
+    case Array:
+        getChar();
+        while (hasNext()) {
+            skipValue();
+        }
+        break;
+    case Object:
+        getChar();
+        while (nextName()) {
+            skipValue();
+        }
+        break;
+    case Invalid:
+        setError(ensure() ? "illegal value" : "unexpected end of data");
+        break;
+    }
+}
+
+bool JsonReader::fill()
+{
+    if (m_device == nullptr) {
+        return false;
+    }
+
+    m_offset += m_size;
+    m_pos = 0;
+    m_size = 0;
+    if (m_buffer.size() != ChunkSize) {
+        m_buffer.resize(ChunkSize);
+    }
+    qint64 read {m_device->read(m_buffer.data(), ChunkSize)};
+    if (read <= 0) {
+        m_device = nullptr;
+        return false;
+    }
+    m_data = m_buffer.constData();
+    m_size = static_cast<int>(read);
+    return true;
+}
+
+bool JsonReader::ensure()
+{
+    if (m_error) {
+        return false;
+    }
+    return m_pos < m_size || fill();
+}
+
+char JsonReader::peekChar()
+{
+    return ensure() ? m_data[m_pos] : '\0';
+}
+
+char JsonReader::getChar()
+{
+    return ensure() ? m_data[m_pos++] : '\0';
+}
+
+void JsonReader::skipWhitespaces()
+{
+    while (ensure()) {
+        switch (m_data[m_pos]) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            ++m_pos;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+bool JsonReader::expect(char c)
+{
+    if (getChar() != c) {
+        setError("unexpected character");
+        return false;
+    }
+    return true;
+}
+
+bool JsonReader::expectLiteral(const char *literal)
+{
+    for (const char *it = literal; *it != '\0'; ++it) {
+        if (!expect(*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void JsonReader::readRawString(QString *string)
+{
+    getChar(); // Opening quote
+    m_scratch.clear();
+    while (true) {
+        if (!ensure()) {
+            setError("unterminated string");
+            return;
+        }
+
+        // Scan an unescaped run in the current chunk
+        int start {m_pos};
+        while (m_pos < m_size && m_data[m_pos] != '"' && m_data[m_pos] != '\\') {
+            ++m_pos;
+        }
+
+        if (string != nullptr) {
+            if (m_pos < m_size && m_data[m_pos] == '"' && m_scratch.isEmpty() && string->isEmpty()) {
+                // Fast path: the whole string is in the chunk and has no escape
+                *string = QString::fromUtf8(m_data + start, m_pos - start);
+                ++m_pos;
+                return;
+            }
+            m_scratch.append(m_data + start, m_pos - start);
+        }
+
+        if (m_pos == m_size) {
+            continue;
+        }
+
+        if (m_data[m_pos++] == '"') {
+            if (string != nullptr) {
+                string->append(QString::fromUtf8(m_scratch));
+            }
+            return;
+        }
+
+        QChar decoded {};
+        switch (getChar()) {
+        case '"':
+            decoded = QLatin1Char('"');
+            break;
+        case '\\':
+            decoded = QLatin1Char('\\');
+            break;
+        case '/':
+            decoded = QLatin1Char('/');
+            break;
+        case 'b':
+            decoded = QLatin1Char('\b');
+            break;
+        case 'f':
+            decoded = QLatin1Char('\f');
+            break;
+        case 'n':
+            decoded = QLatin1Char('\n');
+            break;
+        case 'r':
+            decoded = QLatin1Char('\r');
+            break;
+        case 't':
+            decoded = QLatin1Char('\t');
+            break;
+        case 'u': {
+            ushort value {0};
+            if (!readHex(value)) {
+                return;
+            }
+            // Surrogate pairs are two escapes, they are joined in the QString
+            decoded = QChar(value);
+            break;
+        }
+        default:
+            setError("invalid escape sequence");
+            return;
+        }
+
+        if (string != nullptr) {
+            string->append(QString::fromUtf8(m_scratch));
+            string->append(decoded);
+            m_scratch.clear();
+        }
+    }
+}
+
+void JsonReader::readRawNumber(QByteArray &number)
+{
+    number.clear();
+    while (ensure()) {
+        char c {m_data[m_pos]};
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            number.append(c);
+            ++m_pos;
+        } else {
+            return;
+        }
+    }
+}
+
+bool JsonReader::readHex(ushort &value)
+{
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c {getChar()};
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        } else {
+            setError("invalid unicode escape");
+            return false;
+        }
+    }
+    return true;
+}
+
+void JsonReader::setError(const char *error)
+{
+    if (m_error) {
+        return;
+    }
+    m_error = true;
+    m_errorString = QString(QLatin1String("%1 at offset %2")).arg(QLatin1String(error)).arg(m_offset + m_pos);
+}
+
+}
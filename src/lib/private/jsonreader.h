@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include "globals.h"
+
+class QIODevice;
+
+namespace private_util
+{
+
+/**
+ * @brief A pull JSON reader
+ *
+ * This class reads JSON data in one pass, without building a
+ * QJsonDocument. Values are consumed in document order: objects are
+ * walked with beginObject() and nextName(), arrays with beginArray()
+ * and hasNext(), and other values with the read methods. Values that
+ * are not used can be skipped with skipValue().
+ *
+ * Like QJsonValue, reading a value with an unexpected type consumes
+ * the value and returns a default value. Syntax errors are sticky:
+ * after an error, hasError() returns true and every read method
+ * returns a default value.
+ */
+class JsonReader
+{
+public:
+    enum Type
+    {
+        Invalid,
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+    /**
+     * @brief Constructs a reader that reads from a device
+     *
+     * Data is read by chunks from the device.
+     *
+     * @param device device to read from.
+     */
+    explicit JsonReader(QIODevice &device);
+    /**
+     * @brief Constructs a reader that reads from a byte array
+     * @param data data to read from.
+     */
+    explicit JsonReader(const QByteArray &data);
+    DISABLE_COPY_DISABLE_MOVE(JsonReader);
+    bool hasError() const;
+    QString errorString() const;
+    /**
+     * @brief Type of the next value
+     * @return type of the next value.
+     */
+    Type peek();
+    /**
+     * @brief Enter an object
+     *
+     * If the next value is not an object, it is skipped.
+     *
+     * @return if an object has been entered.
+     */
+    bool beginObject();
+    /**
+     * @brief Read the name of the next member of the current object
+     *
+     * The name can then be accessed with name(). This method returns
+     * false, and leaves the object, when there is no more member.
+     *
+     * @return if there is a member to read.
+     */
+    bool nextName();
+    /**
+     * @brief Name of the current member
+     * @return name of the current member.
+     */
+    const QByteArray & name() const;
+    /**
+     * @brief Enter an array
+     *
+     * If the next value is not an array, it is skipped.
+     *
+     * @return if an array has been entered.
+     */
+    bool beginArray();
+    /**
+     * @brief If the current array has more elements
+     *
+     * This method returns false, and leaves the array, when there is
+     * no more element.
+     *
+     * @return if the current array has more elements.
+     */
+    bool hasNext();
+    QString readString();
+    double readDouble();
+    int readInt();
+    bool readBool();
+    void skipValue();
+private:
+    static const int ChunkSize = 16384;
+    bool fill();
+    bool ensure();
+    char peekChar();
+    char getChar();
+    void skipWhitespaces();
+    bool expect(char c);
+    bool expectLiteral(const char *literal);
+    void readRawString(QString *string);
+    void readRawNumber(QByteArray &number);
+    bool readHex(ushort &value);
+    void setError(const char *error);
+    QIODevice *m_device {nullptr};
+    QByteArray m_buffer {};
+    const char *m_data {nullptr};
+    int m_size {0};
+    int m_pos {0};
+    qint64 m_offset {0};
+    bool m_error {false};
+    QString m_errorString {};
+    QByteArray m_name {};
+    QByteArray m_scratch {};
+};
+
+}
+
+#endif // JSONREADER_H
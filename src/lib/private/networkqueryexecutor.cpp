@@ -31,42 +31,71 @@
 
 #include "networkqueryexecutor.h"
 #include <QtNetwork/QNetworkAccessManager>
+#include "account.h"
 #include "qobjectutils.h"
 #include "twitterqueryutil.h"
 
 
 namespace private_util {
 
-NetworkQueryExecutor::NetworkQueryExecutor(QNetworkAccessManager &network)
-    : m_network(network)
+NetworkQueryExecutor::NetworkQueryExecutor(QNetworkAccessManager &network, const QByteArray &apiUrl)
+    : m_network(network), m_apiUrl(apiUrl)
 {
 }
 
-IQueryExecutor::ConstPtr NetworkQueryExecutor::create(QNetworkAccessManager &network)
+NetworkQueryExecutor::~NetworkQueryExecutor()
 {
-    return IQueryExecutor::ConstPtr(new NetworkQueryExecutor(network));
+    for (QNetworkReply *reply : m_replies) {
+        QObject::disconnect(reply, &QNetworkReply::finished, nullptr, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+IQueryExecutor::ConstPtr NetworkQueryExecutor::create(QNetworkAccessManager &network, const QByteArray &apiUrl)
+{
+    return IQueryExecutor::ConstPtr(new NetworkQueryExecutor(network, apiUrl));
+}
+
+void NetworkQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                   const std::map<QByteArray, QByteArray> &parameters,
+                                   const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    execute(type, path, parameters, {}, account, callback);
 }
 
 void NetworkQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
                                    const std::map<QByteArray, QByteArray> &parameters,
+                                   const std::map<QByteArray, QByteArray> &headers,
                                    const Account &account, const IQueryExecutor::Callback_t &callback) const
 {
     QNetworkReply *reply {nullptr};
     switch (type) {
     case Query::Get:
-        reply = TwitterQueryUtil::get(m_network, path, parameters, account);
+        reply = TwitterQueryUtil::get(m_network, m_apiUrl, path, parameters, signingContext(account), headers);
         break;
     case Query::Post:
-        reply = TwitterQueryUtil::post(m_network, path, {}, parameters, account);
+        reply = TwitterQueryUtil::post(m_network, m_apiUrl, path, {}, parameters, signingContext(account));
         break;
     default:
         Q_ASSERT_X(false, "NetworkQueryExecutor", "Type must be GET or POST");
         break;
     }
-    reply->connect(reply, &QNetworkReply::finished, [reply, callback]() {
+    m_replies.insert(reply);
+    reply->connect(reply, &QNetworkReply::finished, [this, reply, callback]() {
+        m_replies.erase(reply);
         QObjectPtr<QNetworkReply> replyPtr {reply};
         callback(*reply, reply->error(), reply->errorString());
     });
 }
 
+const TwitterDataUtil::SigningContext & NetworkQueryExecutor::signingContext(const Account &account) const
+{
+    auto it = m_signingContexts.find(account.token());
+    if (it == std::end(m_signingContexts)) {
+        it = m_signingContexts.emplace(account.token(), TwitterQueryUtil::signingContext(account)).first;
+    }
+    return it->second;
+}
+
 }
@@ -32,20 +32,41 @@
 #ifndef NETWORKQUERYEXECUTOR_H
 #define NETWORKQUERYEXECUTOR_H
 
+#include <map>
+#include <set>
 #include "iqueryexecutor.h"
+#include "twitterdatautil.h"
 
 namespace private_util {
 
 class NetworkQueryExecutor final : public IQueryExecutor
 {
 public:
-    static IQueryExecutor::ConstPtr create(QNetworkAccessManager &network);
+    /**
+     * @brief Create an executor that sends the queries to Twitter
+     * @param network network access manager used to send the queries.
+     * @param apiUrl URL of the REST API, see TwitterQueryUtil::apiUrl().
+     * @return an executor.
+     */
+    static IQueryExecutor::ConstPtr create(QNetworkAccessManager &network, const QByteArray &apiUrl);
+    ~NetworkQueryExecutor();
     void execute(Query::RequestType type, const QByteArray &path,
                  const std::map<QByteArray, QByteArray> &parameters,
                  const Account &account, const Callback_t &callback) const override;
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const std::map<QByteArray, QByteArray> &headers,
+                 const Account &account, const Callback_t &callback) const override;
 private:
-    explicit NetworkQueryExecutor(QNetworkAccessManager &network);
+    explicit NetworkQueryExecutor(QNetworkAccessManager &network, const QByteArray &apiUrl);
+    const TwitterDataUtil::SigningContext & signingContext(const Account &account) const;
     QNetworkAccessManager &m_network;
+    QByteArray m_apiUrl {};
+    // Signing contexts per token, that are built on the first request of an account
+    mutable std::map<QByteArray, TwitterDataUtil::SigningContext> m_signingContexts {};
+    // The shared manager outlives the executor, and the callbacks of
+    // these replies must not be called once the executor is destroyed
+    mutable std::set<QNetworkReply *> m_replies {};
 };
 
 }
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "networkstack.h"
+#include <algorithm>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include <QtCore/QUrl>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#ifndef QT_NO_SSL
+#include <QtNetwork/QSslConfiguration>
+#endif
+#include "gzipdevice.h"
+#include "queryexecutorfactory.h"
+
+static const QLoggingCategory logger {"network-stack"};
+
+namespace private_util {
+
+double NetworkStack::Statistics::reuseRate() const
+{
+    if (requests == 0) {
+        return 0.;
+    }
+    return std::max(requests - connections, 0) / static_cast<double>(requests);
+}
+
+NetworkStack::NetworkStack(const QByteArray &baseUrl)
+    : m_baseUrl(baseUrl)
+    , m_network(new QNetworkAccessManager())
+    , m_keepAliveTimer(new QTimer())
+{
+    m_keepAliveTimer->setInterval(KeepAliveInterval);
+    QObject::connect(m_keepAliveTimer.get(), &QTimer::timeout, [this]() {
+        keepAlive();
+    });
+    QObject::connect(m_network.get(), &QNetworkAccessManager::finished, [this](QNetworkReply *reply) {
+        ++m_statistics.requests;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+        if (reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool()) {
+            ++m_statistics.http2Requests;
+        }
+#endif
+        // Streams ask for "identity", and are read while they are received, so
+        // their body is gone when they finish. Only the REST API asks for gzip,
+        // see TwitterQueryUtil.
+        if (reply->request().rawHeader("Accept-Encoding") == "gzip") {
+            countTransfer(*reply);
+        }
+        m_lastRequest.start();
+    });
+#ifndef QT_NO_SSL
+    // Only emitted after a handshake, so not for the requests that reuse a connection
+    QObject::connect(m_network.get(), &QNetworkAccessManager::encrypted, [this](QNetworkReply *) {
+        ++m_statistics.connections;
+    });
+#endif
+}
+
+NetworkStack::~NetworkStack()
+{
+    // The manager is deleted later, and must not call this object
+    QObject::disconnect(m_network.get(), nullptr, nullptr, nullptr);
+    qCDebug(logger) << "Requests:" << m_statistics.requests << "connections:" << m_statistics.connections
+                    << "HTTP/2 requests:" << m_statistics.http2Requests << "reuse rate:" << m_statistics.reuseRate();
+    for (const std::pair<QByteArray, Transfer> &transfer : m_statistics.transfers) {
+        qCDebug(logger) << transfer.first << "replies:" << transfer.second.replies
+                        << "received:" << transfer.second.wireBytes << "decoded:" << transfer.second.decodedBytes;
+    }
+}
+
+std::shared_ptr<NetworkStack> NetworkStack::instance()
+{
+    static std::weak_ptr<NetworkStack> instance {};
+    std::shared_ptr<NetworkStack> returned {instance.lock()};
+    if (!returned) {
+        returned = std::make_shared<NetworkStack>(QueryExecutorFactory::baseUrl());
+        instance = returned;
+    }
+    return returned;
+}
+
+void NetworkStack::prepare(QNetworkRequest &request)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#else
+    Q_UNUSED(request)
+#endif
+}
+
+QNetworkAccessManager & NetworkStack::network()
+{
+    return *m_network;
+}
+
+void NetworkStack::setOnline(bool online)
+{
+    if (m_online == online) {
+        return;
+    }
+    m_online = online;
+    if (m_online) {
+        warmUp();
+        m_keepAliveTimer->start();
+    } else {
+        m_keepAliveTimer->stop();
+    }
+}
+
+bool NetworkStack::isOnline() const
+{
+    return m_online;
+}
+
+void NetworkStack::warmUp()
+{
+    QUrl url {QUrl::fromEncoded(m_baseUrl)};
+    qCDebug(logger) << "Opening a connection to" << url.host();
+    ++m_statistics.warmUps;
+    if (url.scheme() != QLatin1String("https")) {
+        m_network->connectToHost(url.host(), static_cast<quint16>(url.port(80)));
+        return;
+    }
+#ifndef QT_NO_SSL
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    // Negotiates HTTP/2 during the handshake
+    QSslConfiguration configuration {QSslConfiguration::defaultConfiguration()};
+    configuration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                           QSslConfiguration::NextProtocolHttp1_1});
+    m_network->connectToHostEncrypted(url.host(), static_cast<quint16>(url.port(443)), configuration);
+#else
+    m_network->connectToHostEncrypted(url.host(), static_cast<quint16>(url.port(443)));
+#endif
+#endif
+}
+
+NetworkStack::Statistics NetworkStack::statistics() const
+{
+    return m_statistics;
+}
+
+void NetworkStack::keepAlive()
+{
+    if (m_online && m_lastRequest.isValid() && m_lastRequest.elapsed() < IdleTimeout) {
+        warmUp();
+    }
+}
+
+void NetworkStack::countTransfer(QNetworkReply &reply)
+{
+    // The manager is notified before the executors, so the
+    // body is not read yet. The decompressed size is stored at
+    // the end of gzip data, so the body is not decompressed.
+    qint64 wireBytes {reply.bytesAvailable()};
+    qint64 decodedBytes {wireBytes};
+    if (reply.rawHeader("Content-Encoding") == "gzip") {
+        qint64 size {GzipDevice::decompressedSize(reply.peek(wireBytes))};
+        if (size >= 0) {
+            decodedBytes = size;
+        }
+    }
+
+    Transfer &transfer (m_statistics.transfers[reply.url().path().toUtf8()]);
+    ++transfer.replies;
+    transfer.wireBytes += wireBytes;
+    transfer.decodedBytes += decodedBytes;
+}
+
+}
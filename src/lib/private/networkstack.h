@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef NETWORKSTACK_H
+#define NETWORKSTACK_H
+
+#include <map>
+#include <memory>
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include "qobjectutils.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QNetworkRequest;
+class QTimer;
+
+namespace private_util {
+
+/**
+ * @brief Network access shared by the whole application
+ *
+ * QNetworkAccessManager keeps a pool of connections per host, that
+ * is only reused by the requests sent by the same manager. This
+ * class provides one manager, that is shared by the containers and
+ * by the authentification, see instance().
+ *
+ * Connections to Twitter are opened in advance, when the network
+ * comes online, see setOnline(), so that the first refresh does not
+ * wait for DNS, TCP and TLS. While requests are sent, like with
+ * periodic refreshes, connections are opened again every
+ * KeepAliveInterval, so that connections closed by the server are
+ * replaced before the next refresh. This stops when no request was
+ * sent during IdleTimeout.
+ *
+ * Requests prepared with prepare() use HTTP/2 when it is supported
+ * by Qt and by the server, and are then multiplexed on one connection.
+ *
+ * The size of the replies of the REST API is counted per path, both
+ * as received, and after decompression, see Statistics::transfers.
+ */
+class NetworkStack
+{
+public:
+    // Interval between two warm ups while requests are sent, in ms
+    static const int KeepAliveInterval = 60 * 1000;
+    // Time without requests after which connections are not kept alive, in ms
+    static const int IdleTimeout = 5 * 60 * 1000;
+    struct Transfer
+    {
+        int replies {0};
+        // Bytes of the bodies, as received
+        qint64 wireBytes {0};
+        // Bytes of the bodies, after decompression
+        qint64 decodedBytes {0};
+    };
+    struct Statistics
+    {
+        int requests {0};
+        // Encrypted connections that were opened, including warm ups
+        int connections {0};
+        int http2Requests {0};
+        int warmUps {0};
+        /**
+         * @brief Ratio of the requests sent on a connection that was already open
+         *
+         * Only encrypted connections are counted.
+         *
+         * @return ratio of requests that reused a connection.
+         */
+        double reuseRate() const;
+        // Transfers of the REST API, per path
+        std::map<QByteArray, Transfer> transfers {};
+    };
+    /**
+     * @brief Constructor
+     * @param baseUrl base URL of Twitter, see QueryExecutorFactory::baseUrl().
+     */
+    explicit NetworkStack(const QByteArray &baseUrl);
+    ~NetworkStack();
+    /**
+     * @brief Network stack shared by the application
+     *
+     * The stack is created when needed, and destroyed when
+     * it is not used anymore.
+     *
+     * @return shared network stack.
+     */
+    static std::shared_ptr<NetworkStack> instance();
+    /**
+     * @brief Prepare a request for the shared stack
+     *
+     * This allows HTTP/2, with Qt 5.8 or later.
+     *
+     * @param request request to prepare.
+     */
+    static void prepare(QNetworkRequest &request);
+    QNetworkAccessManager & network();
+    /**
+     * @brief Set if the network is online
+     *
+     * Connections are opened when the network comes online,
+     * and not kept alive while it is offline.
+     *
+     * @param online if the network is online.
+     */
+    void setOnline(bool online);
+    bool isOnline() const;
+    /**
+     * @brief Open a connection to Twitter in advance
+     *
+     * Nothing is done if a connection is already open.
+     */
+    void warmUp();
+    Statistics statistics() const;
+private:
+    void keepAlive();
+    void countTransfer(QNetworkReply &reply);
+    QByteArray m_baseUrl {};
+    QObjectPtr<QNetworkAccessManager> m_network {nullptr};
+    std::unique_ptr<QTimer> m_keepAliveTimer {};
+    QElapsedTimer m_lastRequest {};
+    bool m_online {false};
+    Statistics m_statistics {};
+};
+
+}
+
+#endif // NETWORKSTACK_H
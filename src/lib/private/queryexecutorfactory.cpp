@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "queryexecutorfactory.h"
+#include <QtCore/QLoggingCategory>
+#include "cachingqueryexecutor.h"
+#include "coalescingqueryexecutor.h"
+#include "networkqueryexecutor.h"
+#include "recordingqueryexecutor.h"
+#include "replayqueryexecutor.h"
+#include "twitterqueryutil.h"
+
+static const QLoggingCategory logger {"query-executor-factory"};
+
+namespace private_util {
+
+QByteArray QueryExecutorFactory::baseUrl()
+{
+    QByteArray url {qgetenv("TWABLET_API_URL")};
+    if (url.isEmpty()) {
+        return TwitterQueryUtil::defaultBaseUrl();
+    }
+    if (!url.endsWith('/')) {
+        url.append('/');
+    }
+    return url;
+}
+
+bool QueryExecutorFactory::isStreaming()
+{
+    return !qgetenv("TWABLET_STREAMING").isEmpty() && replayDir().isEmpty();
+}
+
+IQueryExecutor::ConstPtr QueryExecutorFactory::createTransport(QNetworkAccessManager &network)
+{
+    QString replayDirPath {replayDir()};
+    if (!replayDirPath.isEmpty()) {
+        qCDebug(logger) << "Replaying replies from" << replayDirPath;
+        return ReplayQueryExecutor::create(replayDirPath);
+    }
+    return NetworkQueryExecutor::create(network, TwitterQueryUtil::apiUrl(baseUrl()));
+}
+
+IQueryExecutor::SharedPtr QueryExecutorFactory::create(IQueryExecutor::ConstPtr &&transport)
+{
+    IQueryExecutor::ConstPtr executor {std::move(transport)};
+    // Recorded replies are not recorded, nor cached, again
+    if (replayDir().isEmpty()) {
+        executor = CachingQueryExecutor::create(std::move(executor), CachingQueryExecutor::defaultDirPath());
+        QString recordDirPath {QString::fromLocal8Bit(qgetenv("TWABLET_RECORD_DIR"))};
+        if (!recordDirPath.isEmpty()) {
+            qCDebug(logger) << "Recording replies in" << recordDirPath;
+            executor = RecordingQueryExecutor::create(std::move(executor), recordDirPath);
+        }
+    }
+    return IQueryExecutor::SharedPtr(CoalescingQueryExecutor::create(std::move(executor)));
+}
+
+QString QueryExecutorFactory::replayDir()
+{
+    return QString::fromLocal8Bit(qgetenv("TWABLET_REPLAY_DIR"));
+}
+
+}
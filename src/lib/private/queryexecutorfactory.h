@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef QUERYEXECUTORFACTORY_H
+#define QUERYEXECUTORFACTORY_H
+
+#include "iqueryexecutor.h"
+
+class QNetworkAccessManager;
+
+namespace private_util {
+
+/**
+ * @brief Creates the query executors used by the application
+ *
+ * The executors are configured at runtime with environment
+ * variables, so that the same binary can be profiled against
+ * a local server, or against recorded traffic.
+ *
+ * - TWABLET_API_URL sets the base URL of Twitter, see baseUrl()
+ * - TWABLET_REPLAY_DIR serves the replies recorded in a directory,
+ *   without using the network, see ReplayQueryExecutor
+ * - TWABLET_RECORD_DIR records the replies in a directory,
+ *   see RecordingQueryExecutor
+ * - TWABLET_STREAMING streams the timelines, see isStreaming()
+ *
+ * The transport can be wrapped in a RateLimitScheduler, that needs
+ * to see the replies of the network before they are recorded.
+ *
+ * Replies of GET queries are cached, see CachingQueryExecutor, and
+ * identical queries in flight are merged, see CoalescingQueryExecutor.
+ * Replies are recorded after they go through the cache, that needs the
+ * status and the validators of the network replies, while the recorded
+ * replies only keep their body. Cache hits are then recorded like
+ * network replies, so that a replay serves what the application received.
+ * The executor is meant to be shared between containers, with
+ * SharedQueryExecutor, so that queries are merged across containers.
+ */
+class QueryExecutorFactory
+{
+public:
+    /**
+     * @brief Base URL of Twitter
+     *
+     * This is the value of TWABLET_API_URL if set, or
+     * TwitterQueryUtil::defaultBaseUrl().
+     *
+     * @return base URL of Twitter.
+     */
+    static QByteArray baseUrl();
+    /**
+     * @brief If the timelines are streamed by default
+     *
+     * This is true if TWABLET_STREAMING is set, and when not
+     * replaying, see StreamDispatcher.
+     *
+     * @return if the timelines are streamed by default.
+     */
+    static bool isStreaming();
+    /**
+     * @brief Create the executor that sends the queries
+     *
+     * This is either a NetworkQueryExecutor, or a ReplayQueryExecutor.
+     *
+     * @param network network access manager used to send the queries.
+     * @return the executor that sends the queries.
+     */
+    static IQueryExecutor::ConstPtr createTransport(QNetworkAccessManager &network);
+    /**
+     * @brief Create the executor used by the containers
+     *
+     * The executor merges, records and caches the queries,
+     * before passing them to the transport.
+     *
+     * @param transport executor that sends the queries, see createTransport().
+     * @return the executor used by the containers.
+     */
+    static IQueryExecutor::SharedPtr create(IQueryExecutor::ConstPtr &&transport);
+private:
+    static QString replayDir();
+};
+
+}
+
+#endif // QUERYEXECUTORFACTORY_H
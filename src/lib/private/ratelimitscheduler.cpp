@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "ratelimitscheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <QtCore/QDateTime>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include "account.h"
+
+static const QLoggingCategory logger {"rate-limit-scheduler"};
+// Duration of a rate limit window, in seconds
+static const qint64 WINDOW_DURATION {15 * 60};
+
+namespace private_util {
+
+RateLimitScheduler::RateLimitScheduler(IQueryExecutor::ConstPtr &&queryExecutor, const Clock &clock)
+    : m_queryExecutor(std::move(queryExecutor))
+    , m_state(std::make_shared<State>())
+{
+    Q_ASSERT_X(m_queryExecutor, "RateLimitScheduler", "NULL query executor");
+    m_state->clock = clock ? clock : []() {
+        return QDateTime::currentMSecsSinceEpoch();
+    };
+    m_state->timer.reset(new QTimer());
+    m_state->timer->setSingleShot(true);
+    State *state {m_state.get()};
+    QObject::connect(m_state->timer.get(), &QTimer::timeout, [state]() {
+        state->processQueue();
+    });
+}
+
+RateLimitScheduler::~RateLimitScheduler()
+{
+    // Queued queries use the executor, that is destroyed
+    m_state->queue.clear();
+    m_state->timer->stop();
+}
+
+void RateLimitScheduler::execute(Query::RequestType type, const QByteArray &path,
+                                 const std::map<QByteArray, QByteArray> &parameters,
+                                 const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    execute(type, path, parameters, {}, account, callback);
+}
+
+void RateLimitScheduler::execute(Query::RequestType type, const QByteArray &path,
+                                 const std::map<QByteArray, QByteArray> &parameters,
+                                 const std::map<QByteArray, QByteArray> &headers,
+                                 const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    if (type != Query::Get) {
+        m_queryExecutor->execute(type, path, parameters, headers, account, callback);
+        return;
+    }
+
+    Key key {account.userId(), path};
+    std::shared_ptr<State> state {m_state};
+    const IQueryExecutor *queryExecutor {m_queryExecutor.get()};
+    Request request {key, priority(account, path, parameters), [state, queryExecutor, key, type, path,
+                                                                 parameters, headers, account, callback]() {
+        queryExecutor->execute(type, path, parameters, headers, account,
+                               [state, key, callback](QIODevice &reply, QNetworkReply::NetworkError error,
+                                                     const QString &errorMessage) {
+            state->update(key, reply);
+            callback(reply, error, errorMessage);
+            state->processQueue();
+        });
+    }};
+
+    // Queries do not overtake the queued queries with the same priority
+    if (!m_state->isQueued(key, request.priority) && m_state->canSend(key, request.priority)) {
+        request.send();
+        return;
+    }
+
+    const Limit &limit (m_state->limits[key]);
+    qCDebug(logger) << "Delaying" << path << "for account" << account.userId() << ":" << limit.remaining
+                    << "of" << limit.limit << "requests left, reset in"
+                    << limit.reset - m_state->clock() / 1000 << "s";
+    m_state->queue.push_back(std::move(request));
+    m_state->scheduleReset();
+}
+
+bool RateLimitScheduler::isDeferred(Query::RequestType type, const QByteArray &path,
+                                    const std::map<QByteArray, QByteArray> &parameters,
+                                    const Account &account) const
+{
+    if (type != Query::Get) {
+        return false;
+    }
+    Key key {account.userId(), path};
+    Priority queryPriority {priority(account, path, parameters)};
+    return m_state->isQueued(key, queryPriority) || m_state->isLimited(key, queryPriority);
+}
+
+void RateLimitScheduler::setHighPriority(const Account &account, const Query &query, bool highPriority)
+{
+    std::pair<QString, Query> entry {account.userId(), query};
+    if (highPriority) {
+        m_state->highPriority.insert(entry);
+    } else {
+        m_state->highPriority.erase(entry);
+    }
+}
+
+std::vector<RateLimitScheduler::Limit> RateLimitScheduler::limits() const
+{
+    std::vector<Limit> returned {};
+    for (const std::pair<const Key, Limit> &limit : m_state->limits) {
+        returned.push_back(limit.second);
+        for (const Request &request : m_state->queue) {
+            if (request.key == limit.first) {
+                ++returned.back().queued;
+            }
+        }
+    }
+    return returned;
+}
+
+void RateLimitScheduler::processQueue() const
+{
+    m_state->processQueue();
+}
+
+RateLimitScheduler::Priority RateLimitScheduler::priority(const Account &account, const QByteArray &path,
+                                                          const std::map<QByteArray, QByteArray> &parameters) const
+{
+    for (const std::pair<QString, Query> &entry : m_state->highPriority) {
+        if (entry.first != account.userId() || entry.second.path() != path) {
+            continue;
+        }
+        const Query::Parameters &queryParameters (entry.second.parameters());
+        bool matches {true};
+        for (const std::pair<QByteArray, QByteArray> &parameter : queryParameters) {
+            auto it = parameters.find(parameter.first);
+            if (it == std::end(parameters) || it->second != parameter.second) {
+                matches = false;
+                break;
+            }
+        }
+        if (matches) {
+            return High;
+        }
+    }
+    return Normal;
+}
+
+bool RateLimitScheduler::State::canSend(const Key &key, Priority priority)
+{
+    auto it = limits.find(key);
+    if (it == std::end(limits) || it->second.limit <= 0) {
+        return true;
+    }
+
+    Limit &limit (it->second);
+    qint64 now {clock() / 1000};
+    if (now >= limit.reset) {
+        // The next reply will tell the real state of the new window
+        limit.remaining = limit.limit;
+        limit.reset = now + WINDOW_DURATION;
+    }
+
+    if (isLimited(key, priority)) {
+        return false;
+    }
+    --limit.remaining;
+    return true;
+}
+
+bool RateLimitScheduler::State::isLimited(const Key &key, Priority priority) const
+{
+    auto it = limits.find(key);
+    if (it == std::end(limits) || it->second.limit <= 0) {
+        return false;
+    }
+
+    // A window that is over is refilled by the next query
+    const Limit &limit (it->second);
+    if (clock() / 1000 >= limit.reset) {
+        return false;
+    }
+    int reserve {static_cast<int>(std::ceil(limit.limit * ReserveRatio))};
+    return limit.remaining <= 0 || (priority == Normal && limit.remaining <= reserve);
+}
+
+bool RateLimitScheduler::State::isQueued(const Key &key, Priority priority) const
+{
+    for (const Request &request : queue) {
+        if (request.key == key && request.priority >= priority) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RateLimitScheduler::State::update(const Key &key, QIODevice &reply)
+{
+    QNetworkReply *networkReply {qobject_cast<QNetworkReply *>(&reply)};
+    if (networkReply == nullptr) {
+        return;
+    }
+
+    int status {networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()};
+    if (networkReply->hasRawHeader("x-rate-limit-limit")) {
+        Limit &limit (limits[key]);
+        limit.accountUserId = key.first;
+        limit.path = key.second;
+        limit.limit = networkReply->rawHeader("x-rate-limit-limit").toInt();
+        limit.remaining = networkReply->rawHeader("x-rate-limit-remaining").toInt();
+        limit.reset = networkReply->rawHeader("x-rate-limit-reset").toLongLong();
+    }
+    // Too many requests
+    if (status == 429) {
+        auto it = limits.find(key);
+        if (it != std::end(limits)) {
+            it->second.remaining = 0;
+        }
+        qCWarning(logger) << "Rate limit exceeded for" << key.second << "and account" << key.first;
+    }
+}
+
+void RateLimitScheduler::State::processQueue()
+{
+    // Requests are sent after the queue is updated, since
+    // their callbacks might be called while sending
+    std::vector<Request> requests {};
+    for (Priority priority : {High, Normal}) {
+        std::set<Key> blocked {};
+        for (auto it = std::begin(queue); it != std::end(queue);) {
+            if (it->priority != priority || blocked.count(it->key) > 0) {
+                ++it;
+                continue;
+            }
+            if (!canSend(it->key, priority)) {
+                blocked.insert(it->key);
+                ++it;
+                continue;
+            }
+            requests.push_back(std::move(*it));
+            it = queue.erase(it);
+        }
+    }
+    if (!queue.empty()) {
+        scheduleReset();
+    }
+    for (const Request &request : requests) {
+        request.send();
+    }
+}
+
+void RateLimitScheduler::State::scheduleReset()
+{
+    qint64 reset {0};
+    for (const Request &request : queue) {
+        const Limit &limit (limits[request.key]);
+        if (reset == 0 || limit.reset < reset) {
+            reset = limit.reset;
+        }
+    }
+    qint64 delay {std::max<qint64>(reset - clock() / 1000, 0) * 1000 + 1000};
+    if (!timer->isActive() || timer->remainingTime() > delay) {
+        timer->start(static_cast<int>(delay));
+    }
+}
+
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef RATELIMITSCHEDULER_H
+#define RATELIMITSCHEDULER_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include <QtCore/QString>
+#include "iqueryexecutor.h"
+
+class QTimer;
+
+namespace private_util {
+
+/**
+ * @brief An executor that schedules the queries within the rate limits
+ *
+ * Twitter limits the number of GET requests per account and per
+ * endpoint in a window of 15 minutes, and returns the state of the
+ * limit in the x-rate-limit-limit, x-rate-limit-remaining and
+ * x-rate-limit-reset headers of each reply.
+ *
+ * This executor keeps a bucket of tokens per account and per endpoint,
+ * that is updated from these headers, and refilled when the window is
+ * reset. A query is sent only if there are tokens left. Otherwise, it
+ * is queued until the window is reset.
+ *
+ * The last tokens of a bucket, see ReserveRatio, are reserved to the
+ * high priority queries, like the ones of the visible columns, see
+ * setHighPriority(). Other queries are delayed when only the reserved
+ * tokens are left. Queued queries are sent by priority, then in order.
+ *
+ * POST queries are not limited by these windows, and are always sent.
+ */
+class RateLimitScheduler final : public IQueryExecutor
+{
+public:
+    using Clock = std::function<qint64 ()>;
+    static constexpr double ReserveRatio = 0.2;
+    enum Priority
+    {
+        Normal,
+        High
+    };
+    struct Limit
+    {
+        QString accountUserId {};
+        QByteArray path {};
+        int limit {0};
+        int remaining {0};
+        // Time when the window is reset, in seconds since epoch
+        qint64 reset {0};
+        int queued {0};
+    };
+    /**
+     * @brief Constructor
+     * @param queryExecutor executor that is used to send the queries.
+     * @param clock clock returning the current time in ms since epoch, that can be replaced in tests.
+     */
+    explicit RateLimitScheduler(IQueryExecutor::ConstPtr &&queryExecutor, const Clock &clock = Clock());
+    ~RateLimitScheduler();
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override;
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const std::map<QByteArray, QByteArray> &headers,
+                 const Account &account, const Callback_t &callback) const override;
+    /**
+     * @brief If a query would be queued until a window is reset
+     *
+     * This does not use any token of the bucket.
+     */
+    bool isDeferred(Query::RequestType type, const QByteArray &path,
+                    const std::map<QByteArray, QByteArray> &parameters,
+                    const Account &account) const override;
+    /**
+     * @brief Set if the queries of a column have a high priority
+     *
+     * A request has the priority of the query if it is sent for the
+     * same account and path, and contains the parameters of the query.
+     *
+     * @param account account of the column.
+     * @param query query of the column.
+     * @param highPriority if the queries have a high priority.
+     */
+    void setHighPriority(const Account &account, const Query &query, bool highPriority);
+    /**
+     * @brief State of the rate limits
+     * @return state of the known rate limits, per account and per endpoint.
+     */
+    std::vector<Limit> limits() const;
+    /**
+     * @brief Send the queued queries that can be sent
+     *
+     * This is called when a window is reset, and when a reply
+     * updates a limit.
+     */
+    void processQueue() const;
+private:
+    using Key = std::pair<QString, QByteArray>;
+    struct Request
+    {
+        Key key {};
+        Priority priority {Normal};
+        std::function<void ()> send {};
+    };
+    struct State
+    {
+        bool canSend(const Key &key, Priority priority);
+        bool isLimited(const Key &key, Priority priority) const;
+        bool isQueued(const Key &key, Priority priority) const;
+        void update(const Key &key, QIODevice &reply);
+        void processQueue();
+        void scheduleReset();
+        Clock clock {};
+        std::map<Key, Limit> limits {};
+        std::deque<Request> queue {};
+        std::set<std::pair<QString, Query>> highPriority {};
+        std::unique_ptr<QTimer> timer {};
+    };
+    Priority priority(const Account &account, const QByteArray &path,
+                      const std::map<QByteArray, QByteArray> &parameters) const;
+    IQueryExecutor::ConstPtr m_queryExecutor {};
+    std::shared_ptr<State> m_state {};
+};
+
+}
+
+#endif // RATELIMITSCHEDULER_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "recordingqueryexecutor.h"
+#include <QtCore/QBuffer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLoggingCategory>
+#include "replayqueryexecutor.h"
+
+static const QLoggingCategory logger {"recording-query-executor"};
+
+namespace private_util {
+
+RecordingQueryExecutor::RecordingQueryExecutor(IQueryExecutor::ConstPtr &&queryExecutor, const QString &dirPath)
+    : m_queryExecutor(std::move(queryExecutor)), m_dirPath(dirPath)
+{
+    Q_ASSERT_X(m_queryExecutor, "RecordingQueryExecutor", "NULL query executor");
+}
+
+IQueryExecutor::ConstPtr RecordingQueryExecutor::create(IQueryExecutor::ConstPtr &&queryExecutor,
+                                                        const QString &dirPath)
+{
+    return IQueryExecutor::ConstPtr(new RecordingQueryExecutor(std::move(queryExecutor), dirPath));
+}
+
+void RecordingQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                     const std::map<QByteArray, QByteArray> &parameters,
+                                     const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    execute(type, path, parameters, {}, account, callback);
+}
+
+void RecordingQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                     const std::map<QByteArray, QByteArray> &parameters,
+                                     const std::map<QByteArray, QByteArray> &headers,
+                                     const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    QString fileName {ReplayQueryExecutor::fileName(m_dirPath, type, path, parameters)};
+    QString fallbackFileName {ReplayQueryExecutor::fallbackFileName(m_dirPath, path)};
+    m_queryExecutor->execute(type, path, parameters, headers, account,
+                             [fileName, fallbackFileName, callback](QIODevice &reply,
+                                                                    QNetworkReply::NetworkError error,
+                                                                    const QString &errorMessage) {
+        if (error != QNetworkReply::NoError) {
+            callback(reply, error, errorMessage);
+            return;
+        }
+
+        QBuffer buffer {};
+        buffer.setData(reply.readAll());
+        save(fileName, buffer.data());
+        save(fallbackFileName, buffer.data());
+        buffer.open(QIODevice::ReadOnly);
+        callback(buffer, error, errorMessage);
+    });
+}
+
+bool RecordingQueryExecutor::isDeferred(Query::RequestType type, const QByteArray &path,
+                                        const std::map<QByteArray, QByteArray> &parameters,
+                                        const Account &account) const
+{
+    return m_queryExecutor->isDeferred(type, path, parameters, account);
+}
+
+void RecordingQueryExecutor::save(const QString &fileName, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QFile file {fileName};
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(logger) << "Cannot record reply in" << fileName;
+        return;
+    }
+    file.write(data);
+}
+
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "refreshscheduler.h"
+#include <algorithm>
+#include <limits>
+#include <QtCore/QDateTime>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include "debughelper.h"
+#include "irepositorylistener.h"
+#include "tweetrepositorycontainer.h"
+
+static const QLoggingCategory logger {"refresh-scheduler"};
+// Weight of the previous refreshes in the rate of new tweets
+static const double RATE_DECAY {0.5};
+
+namespace private_util {
+
+const int RefreshScheduler::DefaultInterval;
+const int RefreshScheduler::MinimumInterval;
+const int RefreshScheduler::MaximumInterval;
+const int RefreshScheduler::MaximumVisibleInterval;
+const int RefreshScheduler::MaximumBackoff;
+const int RefreshScheduler::TargetTweets;
+
+// Observes the refreshes of a timeline
+class RefreshScheduler::Timeline final : public IRepositoryListener<Tweet>
+{
+public:
+    explicit Timeline(RefreshScheduler &parent, TweetRepository &repository)
+        : m_parent(parent), m_repository(&repository)
+        , m_nextRefresh(m_parent.m_clock() + DefaultInterval * 1000)
+    {
+        m_repository->addListener(*this);
+    }
+    ~Timeline()
+    {
+        if (m_repository != nullptr) {
+            m_repository->removeListener(*this);
+        }
+    }
+    DISABLE_COPY_DISABLE_MOVE(Timeline);
+    const TweetRepository * repository() const
+    {
+        return m_repository;
+    }
+    int interval() const
+    {
+        int returned {DefaultInterval};
+        // The rate is only known after a few refreshes
+        if (m_seconds >= MinimumInterval) {
+            double adapted {m_tweets > 0 ? TargetTweets * m_seconds / m_tweets : MaximumInterval};
+            returned = static_cast<int>(std::max<double>(std::min<double>(adapted, MaximumInterval), MinimumInterval));
+        }
+        if (m_visible) {
+            returned = std::min(returned, static_cast<int>(MaximumVisibleInterval));
+        }
+        return returned;
+    }
+    // Interval in ms, doubled after each failure
+    qint64 delay() const
+    {
+        qint64 returned {interval() * 1000LL};
+        for (int i = 0; i < m_failures && returned < MaximumBackoff * 1000LL; ++i) {
+            returned *= 2;
+        }
+        return std::min<qint64>(returned, MaximumBackoff * 1000LL);
+    }
+    qint64 nextRefresh() const
+    {
+        return m_nextRefresh;
+    }
+    void setNextRefresh(qint64 nextRefresh)
+    {
+        m_nextRefresh = nextRefresh;
+    }
+    void setVisible(bool visible)
+    {
+        m_visible = visible;
+        if (m_failures == 0) {
+            qint64 lastRefresh {m_lastRefresh > 0 ? m_lastRefresh : m_parent.m_clock()};
+            m_nextRefresh = std::min(m_nextRefresh, lastRefresh + delay());
+        }
+    }
+    void onAppend(const Tweet &item) override
+    {
+        Q_UNUSED(item)
+    }
+    void onAppend(const std::vector<Tweet> &items) override
+    {
+        Q_UNUSED(items)
+    }
+    void onPrepend(const std::vector<Tweet> &items) override
+    {
+        m_newTweets += static_cast<int>(items.size());
+    }
+    void onUpdate(int index, const Tweet &item) override
+    {
+        Q_UNUSED(index)
+        Q_UNUSED(item)
+    }
+    void onRemove(int index) override
+    {
+        Q_UNUSED(index)
+    }
+    void onMove(int from, int to) override
+    {
+        Q_UNUSED(from)
+        Q_UNUSED(to)
+    }
+    void onInvalidation() override
+    {
+        m_repository = nullptr;
+    }
+    void onStart() override
+    {
+    }
+    void onError(const QString &error) override
+    {
+        Q_UNUSED(error)
+        ++m_failures;
+        m_nextRefresh = m_parent.m_clock() + delay();
+        qCDebug(logger) << "Refresh failed" << m_failures << "times, next refresh in" << delay() / 1000 << "s";
+        m_parent.scheduleTimer();
+    }
+    void onFinish() override
+    {
+        qint64 now {m_parent.m_clock()};
+        // The tweets of the first refresh were not sent since the last one
+        if (m_lastRefresh > 0) {
+            m_tweets = m_tweets * RATE_DECAY + m_newTweets;
+            m_seconds = m_seconds * RATE_DECAY + (now - m_lastRefresh) / 1000.;
+        }
+        m_newTweets = 0;
+        m_failures = 0;
+        m_lastRefresh = now;
+        m_nextRefresh = now + delay();
+        qCDebug(logger) << "Refreshed, next refresh in" << interval() << "s";
+        m_parent.scheduleTimer();
+    }
+private:
+    RefreshScheduler &m_parent;
+    TweetRepository *m_repository {nullptr};
+    bool m_visible {false};
+    int m_failures {0};
+    int m_newTweets {0};
+    // New tweets, and the time it took to receive them, with the
+    // most recent refreshes weighting more
+    double m_tweets {0.};
+    double m_seconds {0.};
+    qint64 m_lastRefresh {0};
+    qint64 m_nextRefresh {0};
+};
+
+RefreshScheduler::RefreshScheduler(TweetRepositoryContainer &container, const Clock &clock)
+    : m_container(container)
+    , m_clock(clock ? clock : []() {
+        return QDateTime::currentMSecsSinceEpoch();
+    })
+    , m_timer(new QTimer())
+{
+    m_timer->setSingleShot(true);
+    QObject::connect(m_timer.get(), &QTimer::timeout, [this]() {
+        processTimelines();
+    });
+}
+
+RefreshScheduler::~RefreshScheduler()
+{
+    m_timer->stop();
+}
+
+void RefreshScheduler::setQueries(const Account &account, const std::set<Query> &queries)
+{
+    for (auto it = std::begin(m_timelines); it != std::end(m_timelines);) {
+        if (it->first.account().userId() == account.userId() && queries.count(it->first.query()) == 0) {
+            it = m_timelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const Query &query : queries) {
+        // Timelines are created again when their repository is replaced
+        TweetRepository *repository {m_container.repository(account, query)};
+        ContainerKey key {Account(account), Query(query)};
+        auto it = m_timelines.find(key);
+        if (it != std::end(m_timelines) && it->second->repository() == repository) {
+            continue;
+        }
+        if (it != std::end(m_timelines)) {
+            m_timelines.erase(it);
+        }
+        if (repository != nullptr) {
+            m_timelines.emplace(key, std::unique_ptr<Timeline>(new Timeline(*this, *repository)));
+        }
+    }
+    scheduleTimer();
+}
+
+void RefreshScheduler::setVisible(const Account &account, const Query &query, bool visible)
+{
+    auto it = m_timelines.find(ContainerKey{Account(account), Query(query)});
+    if (it != std::end(m_timelines)) {
+        it->second->setVisible(visible);
+        scheduleTimer();
+    }
+}
+
+void RefreshScheduler::setOnline(bool online)
+{
+    bool wasRunning {isRunning()};
+    m_online = online;
+    if (isRunning() && !wasRunning) {
+        processTimelines();
+    } else {
+        scheduleTimer();
+    }
+}
+
+void RefreshScheduler::setActive(bool active)
+{
+    bool wasRunning {isRunning()};
+    m_active = active;
+    if (isRunning() && !wasRunning) {
+        processTimelines();
+    } else {
+        scheduleTimer();
+    }
+}
+
+bool RefreshScheduler::isRunning() const
+{
+    return m_online && m_active;
+}
+
+int RefreshScheduler::interval(const Account &account, const Query &query) const
+{
+    const Timeline *timeline {this->timeline(account, query)};
+    return timeline != nullptr ? timeline->interval() : 0;
+}
+
+qint64 RefreshScheduler::nextRefresh(const Account &account, const Query &query) const
+{
+    const Timeline *timeline {this->timeline(account, query)};
+    return timeline != nullptr ? timeline->nextRefresh() : 0;
+}
+
+void RefreshScheduler::processTimelines()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    qint64 now {m_clock()};
+    for (const auto &it : m_timelines) {
+        Timeline &timeline {*it.second};
+        if (timeline.nextRefresh() <= now) {
+            // Streamed timelines are not loaded, and are checked again later
+            timeline.setNextRefresh(now + timeline.delay());
+            qCDebug(logger) << "Refresh:" << it.first;
+            m_container.queueRefresh(it.first.account(), it.first.query());
+        }
+    }
+    scheduleTimer();
+}
+
+const RefreshScheduler::Timeline * RefreshScheduler::timeline(const Account &account, const Query &query) const
+{
+    auto it = m_timelines.find(ContainerKey{Account(account), Query(query)});
+    return it != std::end(m_timelines) ? it->second.get() : nullptr;
+}
+
+void RefreshScheduler::scheduleTimer()
+{
+    if (!isRunning() || m_timelines.empty()) {
+        m_timer->stop();
+        return;
+    }
+
+    qint64 next {std::numeric_limits<qint64>::max()};
+    for (const auto &it : m_timelines) {
+        next = std::min(next, it.second->nextRefresh());
+    }
+    qint64 delay {std::min<qint64>(std::max<qint64>(next - m_clock(), 0), MaximumBackoff * 1000LL)};
+    m_timer->start(static_cast<int>(delay));
+}
+
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include "account.h"
+#include "containerkey.h"
+#include "globals.h"
+#include "query.h"
+
+class QTimer;
+class TweetRepositoryContainer;
+
+namespace private_util {
+
+/**
+ * @brief Refreshes the timelines automatically
+ *
+ * Each timeline is refreshed at its own interval, that is adapted
+ * to the rate of new tweets observed in the previous refreshes, so
+ * that a refresh loads about TargetTweets tweets. The interval is
+ * bounded by MinimumInterval and MaximumInterval, and visible
+ * timelines, see setVisible(), are refreshed at least every
+ * MaximumVisibleInterval.
+ *
+ * When a refresh fails, like when the rate limit is exceeded, the
+ * next one is delayed twice as long as the previous one, up to
+ * MaximumBackoff, until a refresh succeeds.
+ *
+ * Nothing is refreshed while the network is offline, see setOnline(),
+ * or while the application is in the background, see setActive().
+ * When both are set again, only the timelines whose refresh is overdue
+ * are refreshed, so that timelines that were refreshed recently are
+ * not loaded again.
+ *
+ * Refreshes are observed by listening to the repositories of the
+ * timelines, so that refreshes that are not made by this scheduler,
+ * like the ones requested by the user, are also taken into account.
+ */
+class RefreshScheduler
+{
+public:
+    using Clock = std::function<qint64 ()>;
+    // Intervals, in seconds
+    static const int DefaultInterval = 2 * 60;
+    static const int MinimumInterval = 60;
+    static const int MaximumInterval = 15 * 60;
+    static const int MaximumVisibleInterval = 3 * 60;
+    static const int MaximumBackoff = 60 * 60;
+    static const int TargetTweets = 20;
+    /**
+     * @brief Constructor
+     * @param container container of the timelines.
+     * @param clock clock returning the current time in ms since epoch, that can be replaced in tests.
+     */
+    explicit RefreshScheduler(TweetRepositoryContainer &container, const Clock &clock = Clock());
+    // Stops listening to the repositories, that are still alive
+    ~RefreshScheduler();
+    DISABLE_COPY_DISABLE_MOVE(RefreshScheduler);
+    /**
+     * @brief Set the timelines of an account
+     *
+     * Timelines that are added are refreshed after DefaultInterval,
+     * and an empty set removes the timelines of the account.
+     *
+     * @param account account of the timelines.
+     * @param queries queries of the timelines.
+     */
+    void setQueries(const Account &account, const std::set<Query> &queries);
+    /**
+     * @brief Set if a timeline is on screen
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @param visible if the timeline is on screen.
+     */
+    void setVisible(const Account &account, const Query &query, bool visible);
+    /**
+     * @brief Set if the network is online
+     * @param online if the network is online.
+     */
+    void setOnline(bool online);
+    /**
+     * @brief Set if the application is in the foreground
+     * @param active if the application is in the foreground.
+     */
+    void setActive(bool active);
+    /**
+     * @brief If the timelines are refreshed
+     * @return if the network is online and the application is in the foreground.
+     */
+    bool isRunning() const;
+    /**
+     * @brief Refresh interval of a timeline
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @return refresh interval, in seconds, or 0 if the timeline is unknown.
+     */
+    int interval(const Account &account, const Query &query) const;
+    /**
+     * @brief Time of the next refresh of a timeline
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @return time of the next refresh, in ms since epoch, or 0 if the timeline is unknown.
+     */
+    qint64 nextRefresh(const Account &account, const Query &query) const;
+    /**
+     * @brief Refresh the timelines whose refresh is due
+     *
+     * This is called by a timer, at the time of the next refresh,
+     * and when the scheduler is running again.
+     */
+    void processTimelines();
+private:
+    class Timeline;
+    const Timeline * timeline(const Account &account, const Query &query) const;
+    void scheduleTimer();
+    TweetRepositoryContainer &m_container;
+    Clock m_clock {};
+    bool m_online {false};
+    bool m_active {true};
+    std::map<ContainerKey, std::unique_ptr<Timeline>> m_timelines {};
+    std::unique_ptr<QTimer> m_timer {};
+};
+
+}
+
+#endif // REFRESHSCHEDULER_H
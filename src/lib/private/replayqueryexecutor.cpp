@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "replayqueryexecutor.h"
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QLoggingCategory>
+
+static const QLoggingCategory logger {"replay-query-executor"};
+
+namespace private_util {
+
+ReplayQueryExecutor::ReplayQueryExecutor(const QString &dirPath)
+    : m_dirPath(dirPath)
+{
+}
+
+IQueryExecutor::ConstPtr ReplayQueryExecutor::create(const QString &dirPath)
+{
+    return IQueryExecutor::ConstPtr(new ReplayQueryExecutor(dirPath));
+}
+
+void ReplayQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                  const std::map<QByteArray, QByteArray> &parameters,
+                                  const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    Q_UNUSED(account)
+    QFile file {fileName(m_dirPath, type, path, parameters)};
+    if (!file.exists()) {
+        file.setFileName(fallbackFileName(m_dirPath, path));
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(logger) << "No reply recorded for" << path;
+        QBuffer empty {};
+        empty.open(QIODevice::ReadOnly);
+        callback(empty, QNetworkReply::ContentNotFoundError,
+                 QLatin1String("No reply recorded for ") + QLatin1String(path));
+        return;
+    }
+    callback(file, QNetworkReply::NoError, QString());
+}
+
+QString ReplayQueryExecutor::fileName(const QString &dirPath, Query::RequestType type, const QByteArray &path,
+                                      const std::map<QByteArray, QByteArray> &parameters)
+{
+    QCryptographicHash hash {QCryptographicHash::Sha1};
+    hash.addData(type == Query::Post ? QByteArray("POST ") : QByteArray("GET "));
+    hash.addData(path);
+    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
+        hash.addData(QByteArray("&") + parameter.first + "=" + parameter.second);
+    }
+    return fallbackFileName(dirPath, path) + QLatin1Char('.') + QLatin1String(hash.result().toHex().left(16));
+}
+
+QString ReplayQueryExecutor::fallbackFileName(const QString &dirPath, const QByteArray &path)
+{
+    return QDir(dirPath).absoluteFilePath(QLatin1String(path));
+}
+
+}
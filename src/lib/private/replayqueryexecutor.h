@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef REPLAYQUERYEXECUTOR_H
+#define REPLAYQUERYEXECUTOR_H
+
+#include "iqueryexecutor.h"
+#include <QtCore/QString>
+
+namespace private_util {
+
+/**
+ * @brief An executor that serves recorded replies
+ *
+ * Replies are stored in a directory, that mirrors the paths
+ * of the queries. A query is answered with the reply recorded
+ * for the same request type, path and parameters, see fileName(),
+ * or with the last reply recorded for the same path, see
+ * fallbackFileName(). Replies are recorded with a
+ * RecordingQueryExecutor.
+ *
+ * No network is used, so that the application can be profiled
+ * against recorded traffic.
+ */
+class ReplayQueryExecutor final : public IQueryExecutor
+{
+public:
+    static IQueryExecutor::ConstPtr create(const QString &dirPath);
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override;
+    /**
+     * @brief Path of the reply recorded for a query
+     * @param dirPath directory containing the replies.
+     * @param type request type of the query.
+     * @param path path of the query.
+     * @param parameters parameters of the query.
+     * @return path of the reply.
+     */
+    static QString fileName(const QString &dirPath, Query::RequestType type, const QByteArray &path,
+                            const std::map<QByteArray, QByteArray> &parameters);
+    /**
+     * @brief Path of the last reply recorded for a path
+     * @param dirPath directory containing the replies.
+     * @param path path of the query.
+     * @return path of the reply.
+     */
+    static QString fallbackFileName(const QString &dirPath, const QByteArray &path);
+private:
+    explicit ReplayQueryExecutor(const QString &dirPath);
+    QString m_dirPath {};
+};
+
+}
+
+#endif // REPLAYQUERYEXECUTOR_H
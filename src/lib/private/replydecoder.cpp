@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "replydecoder.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+namespace private_util {
+
+static const QEvent::Type DONE_EVENT_TYPE {static_cast<QEvent::Type>(QEvent::registerEventType())};
+
+class ReplyDecoder::DoneEvent: public QEvent
+{
+public:
+    explicit DoneEvent(Task_t &&done)
+        : QEvent(DONE_EVENT_TYPE), m_done(std::move(done))
+    {
+    }
+    void run()
+    {
+        m_done();
+    }
+private:
+    Task_t m_done {};
+};
+
+// Decoder that completion tasks are posted to
+//
+// The runnables keep a reference on the target, and
+// the decoder clears it when it is destroyed, so that
+// nothing is posted to a destroyed object.
+class ReplyDecoder::Target
+{
+public:
+    explicit Target(ReplyDecoder *decoder)
+        : m_decoder(decoder)
+    {
+    }
+    void post(Task_t &&done)
+    {
+        QMutexLocker locker {&m_mutex};
+        if (m_decoder != nullptr) {
+            QCoreApplication::postEvent(m_decoder, new DoneEvent(std::move(done)));
+        }
+    }
+    void clear()
+    {
+        QMutexLocker locker {&m_mutex};
+        m_decoder = nullptr;
+    }
+private:
+    QMutex m_mutex {};
+    ReplyDecoder *m_decoder {nullptr};
+};
+
+class ReplyDecoder::Runnable: public QRunnable
+{
+public:
+    explicit Runnable(Task_t &&decode, Task_t &&done, const std::shared_ptr<Target> &target)
+        : m_decode(std::move(decode)), m_done(std::move(done)), m_target(target)
+    {
+        setAutoDelete(true);
+    }
+    void run() override
+    {
+        m_decode();
+        m_target->post(std::move(m_done));
+    }
+private:
+    Task_t m_decode {};
+    Task_t m_done {};
+    std::shared_ptr<Target> m_target {};
+};
+
+ReplyDecoder::ReplyDecoder(QThreadPool *threadPool, QObject *parent)
+    : QObject(parent), m_threadPool(threadPool), m_target(std::make_shared<Target>(this))
+{
+}
+
+ReplyDecoder::~ReplyDecoder()
+{
+    m_target->clear();
+}
+
+void ReplyDecoder::decode(Task_t &&decode, Task_t &&done)
+{
+    if (m_threadPool == nullptr) {
+        decode();
+        done();
+        return;
+    }
+    m_threadPool->start(new Runnable(std::move(decode), std::move(done), m_target));
+}
+
+void ReplyDecoder::customEvent(QEvent *event)
+{
+    if (event->type() == DONE_EVENT_TYPE) {
+        static_cast<DoneEvent *>(event)->run();
+    }
+}
+
+}
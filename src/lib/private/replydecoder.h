@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef REPLYDECODER_H
+#define REPLYDECODER_H
+
+#include <functional>
+#include <memory>
+#include <QtCore/QObject>
+#include "globals.h"
+
+class QThreadPool;
+
+namespace private_util {
+
+/**
+ * @brief Decodes replies in a thread pool
+ *
+ * This class runs decoding tasks in a thread pool, and
+ * runs the associated completion tasks in the thread
+ * of the decoder, once the decoding is done.
+ *
+ * Completion tasks are dropped if the decoder is
+ * destroyed before they are run.
+ *
+ * If no thread pool is provided, both tasks are run
+ * immediately.
+ */
+class ReplyDecoder final : public QObject
+{
+public:
+    using Task_t = std::function<void ()>;
+    explicit ReplyDecoder(QThreadPool *threadPool, QObject *parent = nullptr);
+    ~ReplyDecoder();
+    DISABLE_COPY_DISABLE_MOVE(ReplyDecoder);
+    void decode(Task_t &&decode, Task_t &&done);
+protected:
+    void customEvent(QEvent *event) override;
+private:
+    class Target;
+    class Runnable;
+    class DoneEvent;
+    QThreadPool *m_threadPool {nullptr};
+    std::shared_ptr<Target> m_target {};
+};
+
+}
+
+#endif // REPLYDECODER_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef REPOSITORYINDEX_H
+#define REPOSITORYINDEX_H
+
+#include <algorithm>
+#include <deque>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include "globals.h"
+#include "repository.h"
+
+namespace private_util {
+
+/**
+ * @brief Index of the positions of items in a repository
+ *
+ * This class listens to a repository, and keeps a reverse
+ * index from the id of an item to its positions in the
+ * repository, so that the rows that contain an item can be
+ * found without scanning the repository.
+ *
+ * Items are stored with a sequence number, that is the
+ * position of the item plus an offset that is decreased
+ * on prepend, so that appending, prepending, and removing
+ * items at both ends does not touch the rest of the index.
+ * The index is rebuilt when items are removed from the
+ * middle of the repository, or moved.
+ */
+template<class T>
+class RepositoryIndex final : public IRepositoryListener<T>
+{
+public:
+    using Id = typename std::decay<decltype(std::declval<const T &>().id())>::type;
+    explicit RepositoryIndex(Repository<T> &repository)
+        : m_repository(&repository)
+    {
+        rebuild();
+        m_repository->addListener(*this);
+    }
+    ~RepositoryIndex()
+    {
+        if (m_repository != nullptr) {
+            m_repository->removeListener(*this);
+        }
+    }
+    DISABLE_COPY_DISABLE_MOVE(RepositoryIndex);
+    /**
+     * @brief Positions of an item
+     * @param id id of the item.
+     * @return positions of the item in the repository.
+     */
+    std::vector<int> indexes(const Id &id) const
+    {
+        std::vector<int> returned {};
+        auto it = m_index.constFind(id);
+        if (it != m_index.constEnd()) {
+            for (qint64 sequence : it.value()) {
+                returned.push_back(static_cast<int>(sequence - m_front));
+            }
+        }
+        return returned;
+    }
+    void onAppend(const T &item) override
+    {
+        add(item.id(), m_front + static_cast<qint64>(m_ids.size()));
+        m_ids.push_back(item.id());
+    }
+    void onAppend(const std::vector<T> &items) override
+    {
+        for (const T &item : items) {
+            onAppend(item);
+        }
+    }
+    void onPrepend(const std::vector<T> &items) override
+    {
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            --m_front;
+            add(it->id(), m_front);
+            m_ids.push_front(it->id());
+        }
+    }
+    void onUpdate(int index, const T &item) override
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= m_ids.size()) {
+            return;
+        }
+        Id &id (m_ids[index]);
+        if (id != item.id()) {
+            remove(id, m_front + index);
+            id = item.id();
+            add(id, m_front + index);
+        }
+    }
+    void onRemove(int index) override
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= m_ids.size()) {
+            return;
+        }
+
+        // Removing at both ends, like when a repository is trimmed, is cheap
+        if (index == 0) {
+            remove(m_ids.front(), m_front);
+            m_ids.pop_front();
+            ++m_front;
+        } else if (static_cast<std::size_t>(index) == m_ids.size() - 1) {
+            remove(m_ids.back(), m_front + index);
+            m_ids.pop_back();
+        } else {
+            rebuild();
+        }
+    }
+    void onRemove(int first, int count) override
+    {
+        int last = first + count - 1;
+        if (count <= 0 || first < 0 || static_cast<std::size_t>(last) >= m_ids.size()) {
+            return;
+        }
+
+        // The repository is only read when rebuilding, and
+        // this is done once for the whole range
+        if (first == 0) {
+            for (int i = 0; i < count; ++i) {
+                onRemove(0);
+            }
+        } else if (static_cast<std::size_t>(last) == m_ids.size() - 1) {
+            for (int i = last; i >= first; --i) {
+                onRemove(i);
+            }
+        } else {
+            rebuild();
+        }
+    }
+    void onMove(int from, int to) override
+    {
+        Q_UNUSED(from);
+        Q_UNUSED(to);
+        rebuild();
+    }
+    void onInvalidation() override
+    {
+        m_repository = nullptr;
+        m_index.clear();
+        m_ids.clear();
+    }
+    void onStart() override {}
+    void onError(const QString &error) override
+    {
+        Q_UNUSED(error);
+    }
+    void onFinish() override {}
+private:
+    void add(const Id &id, qint64 sequence)
+    {
+        m_index[id].push_back(sequence);
+    }
+    void remove(const Id &id, qint64 sequence)
+    {
+        auto it = m_index.find(id);
+        if (it == m_index.end()) {
+            return;
+        }
+        std::vector<qint64> &sequences (it.value());
+        sequences.erase(std::remove(std::begin(sequences), std::end(sequences), sequence),
+                        std::end(sequences));
+        if (sequences.empty()) {
+            m_index.erase(it);
+        }
+    }
+    void rebuild()
+    {
+        m_index.clear();
+        m_ids.clear();
+        m_front = 0;
+        for (const T &item : *m_repository) {
+            onAppend(item);
+        }
+    }
+    Repository<T> *m_repository {nullptr};
+    QHash<Id, std::vector<qint64>> m_index {};
+    std::deque<Id> m_ids {};
+    qint64 m_front {0};
+};
+
+}
+
+#endif // REPOSITORYINDEX_H
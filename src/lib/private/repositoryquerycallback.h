@@ -32,6 +32,7 @@
 #ifndef REPOSITORYQUERYCALLBACK_H
 #define REPOSITORYQUERYCALLBACK_H
 
+#include <QtCore/QBuffer>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
@@ -39,98 +40,133 @@
 #include <QtNetwork/QNetworkReply>
 #include "repository.h"
 #include "irepositoryqueryhandler.h"
+#include "gzipdevice.h"
 
 static const QLoggingCategory rqcLogger {"repository-query-callback"};
 
 namespace private_util {
 
+/**
+ * @brief Treats the reply of a repository query
+ *
+ * A reply is treated in three steps. treatError() and
+ * apply() must be called in the thread of the repository,
+ * but decode() can be called from any thread, as it only
+ * touches the handler and the decoded items.
+ *
+ * The handler is shared, so that it stays alive if the
+ * repository is removed while the reply is being decoded.
+ */
 template<class T>
 class RepositoryQueryCallback
 {
 public:
+    using Ptr = std::shared_ptr<RepositoryQueryCallback<T>>;
     explicit RepositoryQueryCallback(typename IRepositoryQueryHandler<T>::RequestType requestType,
-                                     IRepositoryQueryHandler<T> &handler, Repository<T> &repository,
-                                     std::vector<T> &items, bool &loading)
-        : m_requestType(requestType), m_handler(handler), m_repository(repository)
-        , m_items(items), m_loading(loading)
+                                     const typename IRepositoryQueryHandler<T>::SharedPtr &handler)
+        : m_requestType(requestType), m_handler(handler)
     {
     }
-    void operator()(QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage)
+    DISABLE_COPY_DISABLE_MOVE(RepositoryQueryCallback);
+    const typename IRepositoryQueryHandler<T>::SharedPtr & handler() const
     {
-        class LoadingLock
-        {
-        public:
-            explicit LoadingLock(bool &loading)
-                : m_loading(loading)
-            {
-            }
-            ~LoadingLock()
-            {
-                m_loading = false;
-            }
-        private:
-            bool &m_loading;
-        };
-
-        LoadingLock loadingLock {m_loading};
+        return m_handler;
+    }
+    const std::vector<T> & items() const
+    {
+        return m_items;
+    }
+    std::vector<T> & items()
+    {
+        return m_items;
+    }
+    bool treatError(Repository<T> &repository, QIODevice &reply, QNetworkReply::NetworkError error,
+                    const QString &errorMessage)
+    {
+        if (error == QNetworkReply::NoError) {
+            return false;
+        }
 
-        if (error != QNetworkReply::NoError) {
-            qCWarning(rqcLogger) << "Network error";
-            qCWarning(rqcLogger) << "  Error code:" << error;
-            qCWarning(rqcLogger) << "  Error message (Qt):" << errorMessage;
-            const QByteArray &data {reply.readAll()};
-            qCWarning(rqcLogger) << "  Error message (Twitter):" << data;
+        qCWarning(rqcLogger) << "Network error";
+        qCWarning(rqcLogger) << "  Error code:" << error;
+        qCWarning(rqcLogger) << "  Error message (Qt):" << errorMessage;
+        const QByteArray &data {GzipDevice::decompress(reply.readAll())};
+        qCWarning(rqcLogger) << "  Error message (Twitter):" << data;
 
-            // Check if Twitter sent us an issue
-            QJsonDocument document {QJsonDocument::fromJson(data)};
-            if (document.isObject()) {
-                const QJsonObject &object {document.object()};
-                const QJsonArray &array {object.value(QLatin1String("errors")).toArray()};
-                if (array.count() == 1) {
-                    const QJsonObject &firstError {array.first().toObject()};
-                    if (firstError.value(QLatin1String("code")).toInt() == 88) {
-                        qCWarning(rqcLogger) << "  Parsed error: \"Rate limit exceeded\"";
-                        m_repository.error(QObject::tr("Twitter rate limit exceeded. Please try again later."));
-                        return;
-                    }
+        // Check if Twitter sent us an issue
+        QJsonDocument document {QJsonDocument::fromJson(data)};
+        if (document.isObject()) {
+            const QJsonObject &object {document.object()};
+            const QJsonArray &array {object.value(QLatin1String("errors")).toArray()};
+            if (array.count() == 1) {
+                const QJsonObject &firstError {array.first().toObject()};
+                if (firstError.value(QLatin1String("code")).toInt() == 88) {
+                    qCWarning(rqcLogger) << "  Parsed error: \"Rate limit exceeded\"";
+                    repository.error(QObject::tr("Twitter rate limit exceeded. Please try again later."));
+                    return true;
                 }
             }
+        }
 
-            m_repository.error(QObject::tr("Network error. Please try again later."));
+        repository.error(QObject::tr("Network error. Please try again later."));
+        return true;
+    }
+    void decode(const QByteArray &data)
+    {
+        QBuffer buffer {};
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        if (!GzipDevice::isCompressed(data)) {
+            m_returned = m_handler->treatReply(m_requestType, buffer, m_items, m_errorMessage, m_placement);
             return;
         }
 
-        QString newErrorMessage {};
-        typename IRepositoryQueryHandler<T>::Placement placement {IRepositoryQueryHandler<T>::Discard};
-        bool returned = m_handler.treatReply(m_requestType, reply.readAll(), m_items, newErrorMessage, placement);
-        if (!returned) {
-            qCWarning(rqcLogger) << "Parsing error: " << newErrorMessage;
-            m_repository.error(QObject::tr("Internal error"));
-            return;
-        } else {
-            qCDebug(rqcLogger) << "Finished. New data count:" << m_items.size();
-            switch (placement) {
-            case IRepositoryQueryHandler<T>::Append:
-                m_repository.append(m_items);
-                break;
-            case IRepositoryQueryHandler<T>::Prepend:
-                m_repository.prepend(m_items);
-                break;
-            case IRepositoryQueryHandler<T>::Discard:
-                break;
-            }
-            m_repository.finish();
+        // Compressed replies are inflated by chunks, while they are parsed
+        GzipDevice reply {buffer};
+        reply.open(QIODevice::ReadOnly);
+        m_returned = m_handler->treatReply(m_requestType, reply, m_items, m_errorMessage, m_placement);
+    }
+    bool apply(Repository<T> &repository)
+    {
+        if (!m_returned) {
+            qCWarning(rqcLogger) << "Parsing error: " << m_errorMessage;
+            repository.error(QObject::tr("Internal error"));
+            return false;
+        }
+
+        qCDebug(rqcLogger) << "Finished. New data count:" << m_items.size();
+
+        // The end of the repository that is far from
+        // the new items is trimmed
+        int trimmed {0};
+        switch (m_placement) {
+        case IRepositoryQueryHandler<T>::Append:
+            repository.append(m_items);
+            trimmed = repository.trimFront();
+            break;
+        case IRepositoryQueryHandler<T>::Prepend:
+            repository.prepend(m_items);
+            trimmed = repository.trimBack();
+            break;
+        case IRepositoryQueryHandler<T>::Discard:
+            break;
+        }
+        if (trimmed > 0) {
+            qCDebug(rqcLogger) << "Trimmed" << trimmed << "items";
+            m_handler->synchronize(repository);
         }
+        repository.finish();
+        return true;
     }
 private:
     typename IRepositoryQueryHandler<T>::RequestType m_requestType;
-    IRepositoryQueryHandler<T> &m_handler;
-    Repository<T> &m_repository;
-    std::vector<T> &m_items;
-    bool &m_loading;
+    typename IRepositoryQueryHandler<T>::SharedPtr m_handler {};
+    std::vector<T> m_items {};
+    typename IRepositoryQueryHandler<T>::Placement m_placement {IRepositoryQueryHandler<T>::Discard};
+    QString m_errorMessage {};
+    bool m_returned {false};
 };
 
 }
 
 #endif // REPOSITORYQUERYCALLBACK_H
-
@@ -30,16 +30,57 @@
  */
 
 #include "repositoryqueryhandlerutil.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
+#include "jsonreader.h"
 
 namespace private_util
 {
 
+static void updateCursors(IRepositoryQueryHandler<Tweet>::RequestType requestType,
+                          const std::vector<Tweet> &items,
+                          IRepositoryQueryHandler<Tweet>::Placement &placement,
+                          TwitterId &sinceId, TwitterId &maxId)
+{
+    if (!items.empty()) {
+        TwitterId newSinceId {std::begin(items)->id()};
+        TwitterId newMaxId {(std::end(items) - 1)->id().previous()};
+        switch (requestType) {
+        case IRepositoryQueryHandler<Tweet>::Refresh:
+            sinceId = newSinceId;
+            if (!maxId.isValid()) {
+                maxId = newMaxId;
+            }
+            placement = IRepositoryQueryHandler<Tweet>::Prepend;
+            break;
+        case IRepositoryQueryHandler<Tweet>::LoadMore:
+            if (!sinceId.isValid()) {
+                sinceId = newSinceId;
+            }
+            maxId = newMaxId;
+            placement = IRepositoryQueryHandler<Tweet>::Append;
+            break;
+        }
+
+    }
+}
+
+static void prepareTweets(std::vector<Tweet> &items)
+{
+#ifdef USE_PRECOMPUTED_TEXT
+    for (Tweet &tweet : items) {
+        tweet.prepareDisplayText();
+    }
+#else
+    Q_UNUSED(items)
+#endif
+}
+
 bool treatTweetReply(IRepositoryQueryHandler<Tweet>::RequestType requestType,
                      const QJsonArray &data, std::vector<Tweet> &items,
                      IRepositoryQueryHandler<Tweet>::Placement &placement,
-                     QString &sinceId, QString &maxId)
+                     TwitterId &sinceId, TwitterId &maxId)
 {
     items.reserve(data.size());
     for (const QJsonValue &item : data) {
@@ -48,29 +89,69 @@ bool treatTweetReply(IRepositoryQueryHandler<Tweet>::RequestType requestType,
         }
     }
 
-    QString newSinceId = !items.empty() ? std::begin(items)->id() : QString();
-    quint64 newMaxId = items.empty() ? 0 : (std::end(items) - 1)->id().toULongLong();
-    QString newMaxIdStr = newMaxId > 0 ? QString::number(newMaxId - 1) : QString();
-    if (!items.empty()) {
-        switch (requestType) {
-        case IRepositoryQueryHandler<Tweet>::Refresh:
-            sinceId = std::move(newSinceId);
-            if (maxId.isEmpty()) {
-                maxId = std::move(newMaxIdStr);
-            }
-            placement = IRepositoryQueryHandler<Tweet>::Prepend;
-            break;
-        case IRepositoryQueryHandler<Tweet>::LoadMore:
-            if (sinceId.isEmpty()) {
-                sinceId = std::move(newSinceId);
+    prepareTweets(items);
+    updateCursors(requestType, items, placement, sinceId, maxId);
+    return true;
+}
+
+bool treatTweetReply(IRepositoryQueryHandler<Tweet>::RequestType requestType,
+                     JsonReader &reader, std::vector<Tweet> &items, QString &errorMessage,
+                     IRepositoryQueryHandler<Tweet>::Placement &placement,
+                     TwitterId &sinceId, TwitterId &maxId)
+{
+    if (reader.beginArray()) {
+        while (reader.hasNext()) {
+            if (reader.peek() == JsonReader::Object) {
+                items.emplace_back(reader);
+            } else {
+                reader.skipValue();
             }
-            maxId = std::move(newMaxIdStr);
-            placement = IRepositoryQueryHandler<Tweet>::Append;
-            break;
         }
+    }
 
+    if (reader.hasError()) {
+        items.clear();
+        errorMessage = reader.errorString();
+        placement = IRepositoryQueryHandler<Tweet>::Discard;
+        return false;
     }
+
+    prepareTweets(items);
+    updateCursors(requestType, items, placement, sinceId, maxId);
     return true;
 }
 
+void saveTweetState(QDataStream &stream, const TwitterId &sinceId, const TwitterId &maxId)
+{
+    stream << sinceId << maxId;
+}
+
+void restoreTweetState(QDataStream &stream, const std::vector<Tweet> &items,
+                       TwitterId &sinceId, TwitterId &maxId)
+{
+    stream >> sinceId >> maxId;
+
+    // Only the most recent tweets are cached, so older tweets
+    // should be loaded from the last cached tweet
+    if (!items.empty()) {
+        maxId = (std::end(items) - 1)->id().previous();
+        if (!sinceId.isValid()) {
+            sinceId = std::begin(items)->id();
+        }
+    }
+}
+
+void synchronizeTweetState(const Repository<Tweet> &repository, TwitterId &sinceId, TwitterId &maxId)
+{
+    // Refreshing loads tweets that are newer than the first one, and
+    // loading more loads tweets that are older than the last one
+    if (repository.empty()) {
+        sinceId = TwitterId();
+        maxId = TwitterId();
+        return;
+    }
+    sinceId = std::begin(repository)->id();
+    maxId = (std::end(repository) - 1)->id().previous();
+}
+
 }
@@ -35,15 +35,26 @@
 #include "irepositoryqueryhandler.h"
 #include "tweet.h"
 
+class QDataStream;
 class QJsonArray;
 
 namespace private_util
 {
 
+class JsonReader;
+
 bool treatTweetReply(IRepositoryQueryHandler<Tweet>::RequestType requestType,
                      const QJsonArray &data, std::vector<Tweet> &items,
                      IRepositoryQueryHandler<Tweet>::Placement &placement,
-                     QString &sinceId, QString &maxId);
+                     TwitterId &sinceId, TwitterId &maxId);
+bool treatTweetReply(IRepositoryQueryHandler<Tweet>::RequestType requestType,
+                     JsonReader &reader, std::vector<Tweet> &items, QString &errorMessage,
+                     IRepositoryQueryHandler<Tweet>::Placement &placement,
+                     TwitterId &sinceId, TwitterId &maxId);
+void saveTweetState(QDataStream &stream, const TwitterId &sinceId, const TwitterId &maxId);
+void restoreTweetState(QDataStream &stream, const std::vector<Tweet> &items,
+                       TwitterId &sinceId, TwitterId &maxId);
+void synchronizeTweetState(const Repository<Tweet> &repository, TwitterId &sinceId, TwitterId &maxId);
 
 }
 
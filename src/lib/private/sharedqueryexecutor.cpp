@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "sharedqueryexecutor.h"
+
+namespace private_util {
+
+SharedQueryExecutor::SharedQueryExecutor(const IQueryExecutor::SharedPtr &queryExecutor)
+    : m_queryExecutor(queryExecutor)
+{
+    Q_ASSERT_X(m_queryExecutor, "SharedQueryExecutor", "NULL query executor");
+}
+
+IQueryExecutor::ConstPtr SharedQueryExecutor::create(const IQueryExecutor::SharedPtr &queryExecutor)
+{
+    return IQueryExecutor::ConstPtr(new SharedQueryExecutor(queryExecutor));
+}
+
+void SharedQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                  const std::map<QByteArray, QByteArray> &parameters,
+                                  const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    m_queryExecutor->execute(type, path, parameters, account, callback);
+}
+
+void SharedQueryExecutor::execute(Query::RequestType type, const QByteArray &path,
+                                  const std::map<QByteArray, QByteArray> &parameters,
+                                  const std::map<QByteArray, QByteArray> &headers,
+                                  const Account &account, const IQueryExecutor::Callback_t &callback) const
+{
+    m_queryExecutor->execute(type, path, parameters, headers, account, callback);
+}
+
+bool SharedQueryExecutor::isDeferred(Query::RequestType type, const QByteArray &path,
+                                     const std::map<QByteArray, QByteArray> &parameters,
+                                     const Account &account) const
+{
+    return m_queryExecutor->isDeferred(type, path, parameters, account);
+}
+
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "streamdispatcher.h"
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QStringList>
+#include "entityvisitor.h"
+#include "maputil.h"
+#include "tweetrepositorycontainer.h"
+#include "tweetstream.h"
+#include "twitterqueryutil.h"
+#include "usermentionentity.h"
+
+static const QLoggingCategory logger {"stream-dispatcher"};
+
+namespace private_util {
+
+StreamDispatcher::StreamDispatcher(QNetworkAccessManager &network, const QByteArray &baseUrl,
+                                   TweetRepositoryContainer &container)
+    : m_network(network)
+    , m_userStreamUrl(TwitterQueryUtil::userStreamUrl(baseUrl))
+    , m_filterStreamUrl(TwitterQueryUtil::filterStreamUrl(baseUrl))
+    , m_container(container)
+{
+}
+
+StreamDispatcher::~StreamDispatcher()
+{
+}
+
+void StreamDispatcher::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    qCDebug(logger) << "Streams enabled:" << enabled;
+    m_enabled = enabled;
+    for (auto &it : m_streams) {
+        updateStreams(it.second);
+    }
+}
+
+bool StreamDispatcher::isEnabled() const
+{
+    return m_enabled;
+}
+
+void StreamDispatcher::setQueries(const Account &account, const std::set<Query> &queries)
+{
+    std::set<Query> streamableQueries {};
+    for (const Query &query : queries) {
+        if (isStreamable(query)) {
+            streamableQueries.insert(query);
+        }
+    }
+
+    auto it = m_streams.find(account.userId());
+    if (it == std::end(m_streams)) {
+        if (streamableQueries.empty()) {
+            return;
+        }
+        it = m_streams.emplace(account.userId(), Streams()).first;
+    }
+
+    Streams &streams (it->second);
+    streams.account = account;
+    // Timelines that are not streamed anymore are polled again
+    for (const Query &query : streams.queries) {
+        if (streamableQueries.find(query) == std::end(streamableQueries)) {
+            m_container.setStreamed(account, query, false);
+        }
+    }
+    // New timelines are streamed at once if the user stream is already connected,
+    // while new searches are streamed when the filter stream is connected again
+    for (const Query &query : streamableQueries) {
+        if (streams.queries.find(query) == std::end(streams.queries)
+            && streamType(query) == UserStream && streams.userStream && streams.userStream->isConnected()) {
+            m_container.setStreamed(account, query, true);
+        }
+    }
+    streams.queries = std::move(streamableQueries);
+    updateStreams(streams);
+
+    if (streams.queries.empty()) {
+        m_streams.erase(it);
+    }
+}
+
+bool StreamDispatcher::isStreamed(const Account &account, const Query &query) const
+{
+    auto it = m_streams.find(account.userId());
+    if (it == std::end(m_streams) || it->second.queries.find(query) == std::end(it->second.queries)) {
+        return false;
+    }
+    switch (streamType(query)) {
+    case UserStream:
+        return it->second.userStream && it->second.userStream->isConnected();
+    case FilterStream:
+        return it->second.filterStream && it->second.filterStream->isConnected();
+    default:
+        return false;
+    }
+}
+
+bool StreamDispatcher::isStreamable(const Query &query)
+{
+    return streamType(query) != NoStream;
+}
+
+bool StreamDispatcher::matches(const Account &account, const Query &query, const Tweet &tweet)
+{
+    switch (streamType(query)) {
+    case UserStream:
+        if (query.path() == TweetRepositoryQuery::pathFromType(TweetRepositoryQuery::Mentions)) {
+            return mentions(tweet, account);
+        }
+        return true;
+    case FilterStream:
+    {
+        const QByteArray &q {getValue(query.parameters(), QByteArray{"q"})};
+        const QStringList &words {QString::fromUtf8(q).split(QLatin1Char(' '), QString::SkipEmptyParts)};
+        if (words.isEmpty()) {
+            return false;
+        }
+        const QString &text {tweet.text()};
+        for (const QString &word : words) {
+            if (!text.contains(word, Qt::CaseInsensitive)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+QByteArray StreamDispatcher::track(const std::set<Query> &queries)
+{
+    // Terms are separated by commas, and the words of a term by spaces
+    QByteArray returned {};
+    for (const Query &query : queries) {
+        if (streamType(query) != FilterStream) {
+            continue;
+        }
+        QByteArray term {getValue(query.parameters(), QByteArray{"q"})};
+        term = term.replace(',', ' ').simplified();
+        if (term.isEmpty()) {
+            continue;
+        }
+        if (!returned.isEmpty()) {
+            returned.append(',');
+        }
+        returned.append(term);
+    }
+    return returned;
+}
+
+bool StreamDispatcher::mentions(const Tweet &tweet, const Account &account)
+{
+    // The text would also match the screen names that start with the one of the account
+    class MentionVisitor: public EntityVisitor
+    {
+    public:
+        explicit MentionVisitor(const QString &userId)
+            : m_userId(userId)
+        {
+        }
+        bool mentioned {false};
+        void visitUserMention(const UserMentionEntity &entity) override
+        {
+            if (entity.id() == m_userId) {
+                mentioned = true;
+            }
+        }
+    private:
+        const QString &m_userId;
+    };
+
+    const QString &userId {account.userId()};
+    MentionVisitor visitor {userId};
+    for (const Entity::Ptr &entity : tweet.entities()) {
+        entity->accept(visitor);
+        if (visitor.mentioned) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StreamDispatcher::hasSearchOperators(const QByteArray &q)
+{
+    // The filter stream tracks words, and the searches that use
+    // operators, like "a OR b", "-a", "from:a", quoted phrases or
+    // hashtags, cannot be matched with the words of their query
+    for (const QByteArray &word : q.simplified().split(' ')) {
+        if (word == "OR" || word == "AND" || word.startsWith('-') || word.startsWith('+')
+            || word.startsWith('#') || word.startsWith('@') || word.startsWith('$')
+            || word.contains(':') || word.contains('"') || word.contains('(') || word.contains(')')
+            || word.contains('?') || word.contains('*')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+StreamDispatcher::StreamType StreamDispatcher::streamType(const Query &query)
+{
+    const QByteArray &path {query.path()};
+    if (path == TweetRepositoryQuery::pathFromType(TweetRepositoryQuery::Home)
+        || path == TweetRepositoryQuery::pathFromType(TweetRepositoryQuery::Mentions)) {
+        return UserStream;
+    } else if (path == TweetRepositoryQuery::pathFromType(TweetRepositoryQuery::Search)) {
+        // Searches with operators are polled
+        return hasSearchOperators(getValue(query.parameters(), QByteArray{"q"})) ? NoStream : FilterStream;
+    }
+    return NoStream;
+}
+
+void StreamDispatcher::updateStreams(Streams &streams)
+{
+    bool hasUserStream {false};
+    for (const Query &query : streams.queries) {
+        if (streamType(query) == UserStream) {
+            hasUserStream = true;
+        }
+    }
+
+    if (m_enabled && hasUserStream) {
+        if (!streams.userStream) {
+            streams.userStream = createStream(streams.account, UserStream, m_userStreamUrl,
+                                              Query::Parameters{{"with", "followings"}});
+        }
+    } else if (streams.userStream) {
+        streams.userStream->stop();
+        streams.userStream.reset();
+    }
+
+    // The filter stream is opened again when the terms change
+    const QByteArray &terms {m_enabled ? track(streams.queries) : QByteArray()};
+    if (terms != streams.track || (!terms.isEmpty() && !streams.filterStream)) {
+        if (streams.filterStream) {
+            streams.filterStream->stop();
+            streams.filterStream.reset();
+        }
+        streams.track = terms;
+        if (!terms.isEmpty()) {
+            streams.filterStream = createStream(streams.account, FilterStream, m_filterStreamUrl,
+                                                Query::Parameters{{"track", terms}});
+        }
+    }
+}
+
+std::unique_ptr<TweetStream> StreamDispatcher::createStream(const Account &account, StreamType type,
+                                                            const QByteArray &url, Query::Parameters &&parameters)
+{
+    QString userId {account.userId()};
+    std::unique_ptr<TweetStream> returned {new TweetStream(m_network, url, parameters, account,
+                                                           [this, userId, type](std::vector<Tweet> &&tweets) {
+        dispatch(userId, type, tweets);
+    }, [this, userId, type](bool connected) {
+        setConnected(userId, type, connected);
+    })};
+    returned->start();
+    return returned;
+}
+
+void StreamDispatcher::dispatch(const QString &userId, StreamType type, const std::vector<Tweet> &tweets)
+{
+    auto it = m_streams.find(userId);
+    if (it == std::end(m_streams)) {
+        return;
+    }
+
+    const Streams &streams (it->second);
+    for (const Query &query : streams.queries) {
+        if (streamType(query) != type) {
+            continue;
+        }
+        std::vector<Tweet> matchingTweets {};
+        for (const Tweet &tweet : tweets) {
+            if (matches(streams.account, query, tweet)) {
+                matchingTweets.push_back(tweet);
+            }
+        }
+        m_container.ingest(streams.account, query, matchingTweets);
+    }
+}
+
+void StreamDispatcher::setConnected(const QString &userId, StreamType type, bool connected)
+{
+    auto it = m_streams.find(userId);
+    if (it == std::end(m_streams)) {
+        return;
+    }
+
+    qCDebug(logger) << "Stream of" << userId << (type == UserStream ? "user" : "filter")
+                    << "connected:" << connected;
+    const Streams &streams (it->second);
+    for (const Query &query : streams.queries) {
+        if (streamType(query) != type) {
+            continue;
+        }
+        m_container.setStreamed(streams.account, query, connected);
+        // Tweets that were sent while the stream was not connected are loaded once
+        if (connected) {
+            m_container.refresh(streams.account, query);
+        }
+    }
+}
+
+}
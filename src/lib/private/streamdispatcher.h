@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef STREAMDISPATCHER_H
+#define STREAMDISPATCHER_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include "account.h"
+#include "globals.h"
+#include "query.h"
+#include "tweet.h"
+
+class QNetworkAccessManager;
+class TweetRepositoryContainer;
+
+namespace private_util {
+
+class TweetStream;
+
+/**
+ * @brief Streams the timelines of the accounts
+ *
+ * Instead of polling each timeline, this class opens at most two
+ * streams per account. The user stream feeds the home timeline and
+ * the mentions, and the filter stream tracks the terms of the
+ * searches. Each tweet that is received is inserted in the timelines
+ * that match it, see matches(), with TweetRepositoryContainer::ingest().
+ *
+ * While a stream is connected, its timelines are marked as streamed,
+ * so that TweetRepositoryContainer::refresh() does not poll them. They
+ * are refreshed once when the stream connects, to load the tweets that
+ * were sent while it was not connected, and are polled again if the
+ * stream is disconnected.
+ */
+class StreamDispatcher
+{
+public:
+    /**
+     * @brief Constructor
+     * @param network network access manager used by the streams.
+     * @param baseUrl base URL of Twitter, see QueryExecutorFactory::baseUrl().
+     * @param container container of the timelines.
+     */
+    explicit StreamDispatcher(QNetworkAccessManager &network, const QByteArray &baseUrl,
+                              TweetRepositoryContainer &container);
+    // Streams are closed without notifying the container
+    ~StreamDispatcher();
+    DISABLE_COPY_DISABLE_MOVE(StreamDispatcher);
+    /**
+     * @brief Set if the streams are opened
+     *
+     * Streams are only opened while this is enabled, and are
+     * closed otherwise, like when the network is offline.
+     *
+     * @param enabled if the streams are opened.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    /**
+     * @brief Set the timelines of an account
+     *
+     * Only the timelines that can be streamed, see isStreamable(),
+     * are streamed. An empty set closes the streams of the account.
+     *
+     * @param account account of the timelines.
+     * @param queries queries of the timelines.
+     */
+    void setQueries(const Account &account, const std::set<Query> &queries);
+    /**
+     * @brief If a timeline is streamed
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @return if the stream of the timeline is connected.
+     */
+    bool isStreamed(const Account &account, const Query &query) const;
+    /**
+     * @brief If a timeline can be streamed
+     *
+     * The home timeline, the mentions and the searches can be streamed,
+     * except the searches whose query uses operators, like "OR", "-",
+     * "from:" or quotes, that the filter stream cannot track.
+     *
+     * @param query query of the timeline.
+     * @return if the timeline can be streamed.
+     */
+    static bool isStreamable(const Query &query);
+    /**
+     * @brief If a streamed tweet belongs to a timeline
+     *
+     * Every tweet of the user stream belongs to the home timeline,
+     * and the tweets whose user mentions contain the id of the
+     * account belong to the mentions.
+     * A tweet of the filter stream belongs to the searches whose words
+     * are all contained in the tweet, like the terms tracked by Twitter.
+     *
+     * @param account account of the stream.
+     * @param query query of the timeline.
+     * @param tweet tweet that was received.
+     * @return if the tweet belongs to the timeline.
+     */
+    static bool matches(const Account &account, const Query &query, const Tweet &tweet);
+    /**
+     * @brief Terms tracked by the filter stream
+     * @param queries queries of the timelines.
+     * @return value of the track parameter, or an empty array if there is no search.
+     */
+    static QByteArray track(const std::set<Query> &queries);
+private:
+    enum StreamType
+    {
+        NoStream,
+        UserStream,
+        FilterStream
+    };
+    struct Streams
+    {
+        Account account {};
+        std::set<Query> queries {};
+        QByteArray track {};
+        std::unique_ptr<TweetStream> userStream {};
+        std::unique_ptr<TweetStream> filterStream {};
+    };
+    static StreamType streamType(const Query &query);
+    static bool mentions(const Tweet &tweet, const Account &account);
+    static bool hasSearchOperators(const QByteArray &q);
+    void updateStreams(Streams &streams);
+    std::unique_ptr<TweetStream> createStream(const Account &account, StreamType type,
+                                              const QByteArray &url, Query::Parameters &&parameters);
+    void dispatch(const QString &userId, StreamType type, const std::vector<Tweet> &tweets);
+    void setConnected(const QString &userId, StreamType type, bool connected);
+    QNetworkAccessManager &m_network;
+    QByteArray m_userStreamUrl {};
+    QByteArray m_filterStreamUrl {};
+    TweetRepositoryContainer &m_container;
+    bool m_enabled {false};
+    std::map<QString, Streams> m_streams {};
+};
+
+}
+
+#endif // STREAMDISPATCHER_H
@@ -33,21 +33,113 @@
 #define TIMEUTIL_H
 
 #include <QtCore/QDateTime>
-#include <QtCore/QLocale>
+#include <QtCore/QString>
 
 namespace private_util
 {
 
-static QDateTime fromUtc(const QString &timeUtc)
+static const qint64 INVALID_TIMESTAMP {-1};
+
+inline int parseDigits(const QChar *data, int count)
 {
-    QLocale locale (QLocale::English, QLocale::UnitedStates);
-    QDateTime utc {locale.toDateTime(timeUtc, QLatin1String("ddd MMM dd HH:mm:ss +0000 yyyy"))};
-    utc.setTimeSpec(Qt::UTC);
-    return utc.toLocalTime();
+    int value {0};
+    for (int i = 0; i < count; ++i) {
+        ushort digit {static_cast<ushort>(data[i].unicode() - '0')};
+        if (digit > 9) {
+            return -1;
+        }
+        value = value * 10 + digit;
+    }
+    return value;
 }
 
+inline int parseMonth(const QChar *data)
+{
+    static const char *MONTHS {"JanFebMarAprMayJunJulAugSepOctNovDec"};
+    for (int i = 0; i < 12; ++i) {
+        const char *month {MONTHS + 3 * i};
+        if (data[0] == QLatin1Char(month[0]) && data[1] == QLatin1Char(month[1])
+            && data[2] == QLatin1Char(month[2])) {
+            return i + 1;
+        }
+    }
+    return -1;
 }
 
+// Days from 1970-01-01 to a date in the proleptic Gregorian calendar
+inline qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+    const int era {(year >= 0 ? year : year - 399) / 400};
+    const int yearOfEra {year - era * 400};
+    const int dayOfYear {(153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1};
+    const int dayOfEra {yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear};
+    return static_cast<qint64>(era) * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @brief Parse a timestamp sent by Twitter
+ *
+ * Twitter timestamps use the fixed "ddd MMM dd HH:mm:ss +0000 yyyy"
+ * layout with English names, that is parsed directly, without using
+ * QLocale.
+ *
+ * @param timeUtc timestamp to parse.
+ * @return milliseconds since epoch, in UTC, or INVALID_TIMESTAMP.
+ */
+inline qint64 parseTimestamp(const QString &timeUtc)
+{
+    // Wed Aug 27 13:08:45 +0000 2008
+    if (timeUtc.size() != 30) {
+        return INVALID_TIMESTAMP;
+    }
+    const QChar *data {timeUtc.constData()};
+    if (data[3] != QLatin1Char(' ') || data[7] != QLatin1Char(' ') || data[10] != QLatin1Char(' ')
+        || data[13] != QLatin1Char(':') || data[16] != QLatin1Char(':') || data[19] != QLatin1Char(' ')
+        || data[25] != QLatin1Char(' ')) {
+        return INVALID_TIMESTAMP;
+    }
+
+    const int month {parseMonth(data + 4)};
+    const int day {parseDigits(data + 8, 2)};
+    const int hours {parseDigits(data + 11, 2)};
+    const int minutes {parseDigits(data + 14, 2)};
+    const int seconds {parseDigits(data + 17, 2)};
+    const int offset {parseDigits(data + 21, 4)};
+    const int year {parseDigits(data + 26, 4)};
+    if (month < 0 || day < 1 || day > 31 || hours < 0 || hours > 23 || minutes < 0 || minutes > 59
+        || seconds < 0 || seconds > 60 || offset < 0 || year < 0) {
+        return INVALID_TIMESTAMP;
+    }
+
+    int offsetSeconds {(offset / 100) * 3600 + (offset % 100) * 60};
+    if (data[20] == QLatin1Char('-')) {
+        offsetSeconds = -offsetSeconds;
+    } else if (data[20] != QLatin1Char('+')) {
+        return INVALID_TIMESTAMP;
+    }
+
+    const qint64 secondsSinceEpoch {daysFromCivil(year, month, day) * 86400
+                                    + hours * 3600 + minutes * 60 + seconds - offsetSeconds};
+    return secondsSinceEpoch * 1000;
+}
+
+/**
+ * @brief Convert a timestamp to local time
+ * @param timestamp milliseconds since epoch, in UTC, or INVALID_TIMESTAMP.
+ * @return local time, or an invalid QDateTime.
+ */
+inline QDateTime toLocalTime(qint64 timestamp)
+{
+    return timestamp != INVALID_TIMESTAMP ? QDateTime::fromMSecsSinceEpoch(timestamp) : QDateTime();
+}
+
+inline QDateTime fromUtc(const QString &timeUtc)
+{
+    return toLocalTime(parseTimestamp(timeUtc));
+}
+
+}
 
-#endif // TIMEUTIL_H
 
+#endif // TIMEUTIL_H
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "tweetstream.h"
+#include <algorithm>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include "jsonreader.h"
+#include "twitterqueryutil.h"
+
+static const QLoggingCategory logger {"tweet-stream"};
+
+namespace private_util {
+
+TweetStream::TweetStream(QNetworkAccessManager &network, const QByteArray &url,
+                         const Query::Parameters &parameters, const Account &account,
+                         Callback_t &&callback, StateCallback_t &&stateCallback)
+    : m_network(network), m_url(url), m_parameters(parameters)
+    , m_signingContext(TwitterQueryUtil::signingContext(account))
+    , m_callback(std::move(callback)), m_stateCallback(std::move(stateCallback))
+    , m_stallTimer(new QTimer()), m_reconnectTimer(new QTimer())
+{
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setInterval(StallTimeout);
+    QObject::connect(m_stallTimer.get(), &QTimer::timeout, [this]() {
+        qCWarning(logger) << "Stream stalled:" << m_url;
+        // Aborting finishes the reply, that connects again
+        if (m_reply) {
+            m_reply->abort();
+        }
+    });
+    m_reconnectTimer->setSingleShot(true);
+    QObject::connect(m_reconnectTimer.get(), &QTimer::timeout, [this]() {
+        connectToStream();
+    });
+}
+
+TweetStream::~TweetStream()
+{
+    m_running = false;
+    disconnectFromStream();
+}
+
+void TweetStream::start()
+{
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_reconnectDelay = 0;
+    connectToStream();
+}
+
+void TweetStream::stop()
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    m_reconnectTimer->stop();
+    disconnectFromStream();
+    setConnected(false);
+}
+
+bool TweetStream::isConnected() const
+{
+    return m_connected;
+}
+
+std::vector<Tweet> TweetStream::readLines(QByteArray &buffer)
+{
+    std::vector<Tweet> returned {};
+    int start {0};
+    int end {buffer.indexOf('\n')};
+    while (end >= 0) {
+        const QByteArray &line {QByteArray::fromRawData(buffer.constData() + start, end - start).trimmed()};
+        if (!line.isEmpty()) {
+            JsonReader reader {line};
+            if (reader.peek() == JsonReader::Object) {
+                Tweet tweet {reader};
+                // Messages that are not tweets do not have an id
+                if (!reader.hasError() && tweet.isValid()) {
+#ifdef USE_PRECOMPUTED_TEXT
+                    tweet.prepareDisplayText();
+#endif
+                    returned.push_back(std::move(tweet));
+                }
+            }
+        }
+        start = end + 1;
+        end = buffer.indexOf('\n', start);
+    }
+    buffer.remove(0, start);
+    return returned;
+}
+
+void TweetStream::connectToStream()
+{
+    qCDebug(logger) << "Connecting to stream:" << m_url << m_parameters;
+    m_reply.reset(m_network.get(TwitterQueryUtil::createStreamRequest(m_url, m_parameters, m_signingContext)));
+    m_readyReadConnection = QObject::connect(m_reply.get(), &QNetworkReply::readyRead, [this]() {
+        read();
+    });
+    m_finishedConnection = QObject::connect(m_reply.get(), &QNetworkReply::finished, [this]() {
+        finish();
+    });
+    m_stallTimer->start();
+}
+
+void TweetStream::disconnectFromStream()
+{
+    m_stallTimer->stop();
+    m_buffer.clear();
+    if (!m_reply) {
+        return;
+    }
+    QObject::disconnect(m_readyReadConnection);
+    QObject::disconnect(m_finishedConnection);
+    m_reply->abort();
+    m_reply.reset();
+}
+
+void TweetStream::read()
+{
+    m_stallTimer->start();
+    int status {m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()};
+    if (status != 200) {
+        // The error is treated when the reply is finished
+        return;
+    }
+
+    m_buffer.append(m_reply->readAll());
+    m_reconnectDelay = 0;
+    setConnected(true);
+    std::vector<Tweet> tweets {readLines(m_buffer)};
+    if (!tweets.empty()) {
+        qCDebug(logger) << "Received" << tweets.size() << "tweets from" << m_url;
+        m_callback(std::move(tweets));
+    }
+}
+
+void TweetStream::finish()
+{
+    int status {m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()};
+    qCWarning(logger) << "Stream closed:" << m_url << "status:" << status << "error:" << m_reply->errorString();
+    disconnectFromStream();
+    setConnected(false);
+    if (!m_running) {
+        return;
+    }
+
+    // Twitter asks clients that open too many streams to wait longer
+    int minimumDelay {(status == 420 || status == 429) ? RateLimitReconnectDelay : MinimumReconnectDelay};
+    m_reconnectDelay = std::min(std::max(m_reconnectDelay * 2, minimumDelay), static_cast<int>(MaximumReconnectDelay));
+    qCDebug(logger) << "Reconnecting to" << m_url << "in" << m_reconnectDelay << "ms";
+    m_reconnectTimer->start(m_reconnectDelay);
+}
+
+void TweetStream::setConnected(bool connected)
+{
+    if (m_connected == connected) {
+        return;
+    }
+    m_connected = connected;
+    if (m_stateCallback) {
+        m_stateCallback(m_connected);
+    }
+}
+
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef TWEETSTREAM_H
+#define TWEETSTREAM_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "account.h"
+#include "globals.h"
+#include "qobjectutils.h"
+#include "query.h"
+#include "tweet.h"
+#include "twitterdatautil.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+namespace private_util {
+
+/**
+ * @brief A stream of tweets
+ *
+ * This class keeps one long-lived connection to a streaming endpoint
+ * of Twitter, that sends one JSON message per line. Tweets are read
+ * as soon as their line is complete, and passed to the callback.
+ * Other messages, like deletions or the list of friends, and the
+ * blank lines sent to keep the connection alive, are ignored.
+ *
+ * When the connection is closed, or when nothing is received during
+ * StallTimeout, the stream connects again after a delay that doubles
+ * after each failed attempt, starting from MinimumReconnectDelay, or
+ * from RateLimitReconnectDelay when Twitter rejected the connection
+ * because too many streams were opened.
+ */
+class TweetStream
+{
+public:
+    using Callback_t = std::function<void (std::vector<Tweet> &&tweets)>;
+    using StateCallback_t = std::function<void (bool connected)>;
+    // Twitter sends a blank line every 30 s
+    static const int StallTimeout = 90 * 1000;
+    static const int MinimumReconnectDelay = 5 * 1000;
+    static const int RateLimitReconnectDelay = 60 * 1000;
+    static const int MaximumReconnectDelay = 5 * 60 * 1000;
+    /**
+     * @brief Constructor
+     * @param network network access manager used to connect.
+     * @param url URL of the stream.
+     * @param parameters parameters of the stream.
+     * @param account account used to sign the request.
+     * @param callback callback called with the tweets that are received.
+     * @param stateCallback callback called when the stream is connected or disconnected.
+     */
+    explicit TweetStream(QNetworkAccessManager &network, const QByteArray &url,
+                         const Query::Parameters &parameters, const Account &account,
+                         Callback_t &&callback, StateCallback_t &&stateCallback);
+    // The state callback is not called when the stream is destroyed
+    ~TweetStream();
+    DISABLE_COPY_DISABLE_MOVE(TweetStream);
+    void start();
+    void stop();
+    /**
+     * @brief If the stream is connected
+     *
+     * A stream is connected when it received data.
+     *
+     * @return if the stream is connected.
+     */
+    bool isConnected() const;
+    /**
+     * @brief Read the tweets of the complete lines of a stream
+     *
+     * The complete lines are removed from the buffer, and the
+     * last line, that is not complete yet, is kept.
+     *
+     * @param buffer data received from the stream.
+     * @return tweets that were read.
+     */
+    static std::vector<Tweet> readLines(QByteArray &buffer);
+private:
+    void connectToStream();
+    void disconnectFromStream();
+    void read();
+    void finish();
+    void setConnected(bool connected);
+    QNetworkAccessManager &m_network;
+    QByteArray m_url {};
+    Query::Parameters m_parameters {};
+    TwitterDataUtil::SigningContext m_signingContext;
+    Callback_t m_callback {};
+    StateCallback_t m_stateCallback {};
+    QObjectPtr<QNetworkReply> m_reply {nullptr};
+    QMetaObject::Connection m_readyReadConnection {};
+    QMetaObject::Connection m_finishedConnection {};
+    std::unique_ptr<QTimer> m_stallTimer {};
+    std::unique_ptr<QTimer> m_reconnectTimer {};
+    QByteArray m_buffer {};
+    int m_reconnectDelay {0};
+    bool m_running {false};
+    bool m_connected {false};
+};
+
+}
+
+#endif // TWEETSTREAM_H
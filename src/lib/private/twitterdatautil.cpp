@@ -32,80 +32,146 @@
 #include "twitterdatautil.h"
 
 #include <QtCore/QByteArray>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDateTime>
-#include <QtCore/QList>
-#include <QtCore/QMap>
-#include <QtCore/qmath.h>
-#include <QtCore/QMessageAuthenticationCode>
-#include <QtCore/QUrl>
 #include <QtCore/QUuid>
 
 namespace private_util
 {
 
+static const char *OAUTH_CONSUMER_KEY_KEY = "oauth_consumer_key";
+static const char *OAUTH_NONCE_KEY = "oauth_nonce";
+static const char *OAUTH_SIGNATURE_METHOD_KEY = "oauth_signature_method";
+static const char *OAUTH_TIMESTAMP_KEY = "oauth_timestamp";
+static const char *OAUTH_TOKEN_KEY = "oauth_token";
+static const char *OAUTH_VERSION_KEY = "oauth_version";
 static const char *OAUTH_SIGNATURE_METHOD = "HMAC-SHA1";
 static const char *OAUTH_VERSION = "1.0";
+// Block size of SHA1, used to pad the HMAC key
+static const int HMAC_BLOCK_SIZE {64};
 
-QByteArray TwitterDataUtil::authorizationHeader(const QByteArray &oauthConsumerKey,
+TwitterDataUtil::SigningContext::SigningContext(const QByteArray &oauthConsumerKey,
                                                 const QByteArray &oauthConsumerSecret,
-                                                const QByteArray &requestMethod,
-                                                const QByteArray &requestUrl,
-                                                const std::vector<std::pair<QByteArray, QByteArray>> &parameters,
                                                 const QByteArray &oauthToken,
-                                                const QByteArray &oauthTokenSecret,
-                                                const QByteArray &oauthNonce,
-                                                const QByteArray &oauthTimestamp)
+                                                const QByteArray &oauthTokenSecret)
+    : m_encodedConsumerKey(oauthConsumerKey.toPercentEncoding())
+    , m_encodedToken(oauthToken.toPercentEncoding())
 {
-    // Twitter requires all requests to be signed with an authorization header.
-    QByteArray nonce {oauthNonce};
-    if (nonce.isEmpty()) {
-        nonce = QUuid::createUuid().toByteArray().toBase64();
-    }
-    QByteArray timestamp {oauthTimestamp};
-    if (timestamp.isEmpty()) {
-        timestamp = QByteArray::number(qFloor(QDateTime::currentMSecsSinceEpoch() / 1000.0));
-    }
-
-    // now build up the encoded parameters map.  We use a map to perform alphabetical sorting.
-    QMap<QByteArray, QByteArray> encodedParams {};
-    encodedParams.insert(QByteArray("oauth_consumer_key").toPercentEncoding(), QByteArray(oauthConsumerKey).toPercentEncoding());
-    encodedParams.insert(QByteArray("oauth_nonce").toPercentEncoding(), nonce.toPercentEncoding());
-    encodedParams.insert(QByteArray("oauth_signature_method").toPercentEncoding(), QByteArray(OAUTH_SIGNATURE_METHOD).toPercentEncoding());
-    encodedParams.insert(QByteArray("oauth_timestamp").toPercentEncoding(), timestamp.toPercentEncoding());
-    encodedParams.insert(QByteArray("oauth_version").toPercentEncoding(), QByteArray(OAUTH_VERSION).toPercentEncoding());
-    if (!oauthToken.isEmpty()) {
-        encodedParams.insert(QByteArray("oauth_token").toPercentEncoding(), oauthToken.toPercentEncoding());
-    }
-    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
-        encodedParams.insert(parameter.first, parameter.second);
+    QByteArray signingKey {oauthConsumerSecret.toPercentEncoding() + '&' + oauthTokenSecret.toPercentEncoding()};
+    if (signingKey.size() > HMAC_BLOCK_SIZE) {
+        signingKey = QCryptographicHash::hash(signingKey, QCryptographicHash::Sha1);
     }
+    signingKey.append(QByteArray(HMAC_BLOCK_SIZE - signingKey.size(), '\0'));
 
-    QByteArray parametersByteArray {};
-    QList<QByteArray> keys = encodedParams.keys();
-    for (const QByteArray &key : keys) {
-        parametersByteArray += key + QByteArray("=") + encodedParams.value(key) + QByteArray("&");
+    m_innerPad.resize(HMAC_BLOCK_SIZE);
+    m_outerPad.resize(HMAC_BLOCK_SIZE);
+    for (int i = 0; i < HMAC_BLOCK_SIZE; ++i) {
+        m_innerPad[i] = static_cast<char>(signingKey.at(i) ^ 0x36);
+        m_outerPad[i] = static_cast<char>(signingKey.at(i) ^ 0x5c);
     }
-    parametersByteArray.chop(1);
+}
 
-    QByteArray signatureBaseString {requestMethod.toUpper() + QByteArray("&") + requestUrl.toPercentEncoding() + QByteArray("&") + parametersByteArray.toPercentEncoding()};
-    QByteArray signingKey {oauthConsumerSecret.toPercentEncoding() + QByteArray("&") + oauthTokenSecret.toPercentEncoding()};
+QByteArray TwitterDataUtil::SigningContext::authorizationHeader(const QByteArray &requestMethod,
+                                                                const QByteArray &requestUrl,
+                                                                const std::map<QByteArray, QByteArray> &parameters,
+                                                                const std::map<QByteArray, QByteArray> &postData,
+                                                                const QByteArray &oauthNonce,
+                                                                const QByteArray &oauthTimestamp) const
+{
+    // Twitter requires all requests to be signed with an authorization header.
+    // Hexadecimal nonces and timestamps do not need to be percent-encoded.
+    QByteArray nonce {oauthNonce.isEmpty() ? QUuid::createUuid().toRfc4122().toHex() : oauthNonce.toPercentEncoding()};
+    QByteArray timestamp {oauthTimestamp.isEmpty() ? QByteArray::number(QDateTime::currentMSecsSinceEpoch() / 1000)
+                                                   : oauthTimestamp.toPercentEncoding()};
 
-    QByteArray oauthSignature {QMessageAuthenticationCode::hash(signatureBaseString, signingKey, QCryptographicHash::Sha1).toBase64()};
-    encodedParams.insert(QByteArray("oauth_signature").toPercentEncoding(), oauthSignature.toPercentEncoding());
+    // The parameter string contains the OAuth parameters and the parameters
+    // of the request, sorted by key. They are all sorted already, and are merged.
+    const QByteArray signatureMethod {QByteArray::fromRawData(OAUTH_SIGNATURE_METHOD, qstrlen(OAUTH_SIGNATURE_METHOD))};
+    const QByteArray version {QByteArray::fromRawData(OAUTH_VERSION, qstrlen(OAUTH_VERSION))};
+    const std::pair<const char *, const QByteArray *> oauthParameters[] {
+        {OAUTH_CONSUMER_KEY_KEY, &m_encodedConsumerKey},
+        {OAUTH_NONCE_KEY, &nonce},
+        {OAUTH_SIGNATURE_METHOD_KEY, &signatureMethod},
+        {OAUTH_TIMESTAMP_KEY, &timestamp},
+        {OAUTH_TOKEN_KEY, &m_encodedToken},
+        {OAUTH_VERSION_KEY, &version}
+    };
+    QByteArray parameterString {};
+    parameterString.reserve(256);
+    auto append = [&parameterString](const char *key, const QByteArray &value) {
+        parameterString.append(key).append('=').append(value).append('&');
+    };
+    auto parameterIt = std::begin(parameters);
+    auto postDataIt = std::begin(postData);
+    auto appendUntil = [&](const char *bound) {
+        while (true) {
+            bool hasParameter {parameterIt != std::end(parameters) && (bound == nullptr || parameterIt->first < bound)};
+            bool hasPostData {postDataIt != std::end(postData) && (bound == nullptr || postDataIt->first < bound)};
+            if (hasParameter && (!hasPostData || !(postDataIt->first < parameterIt->first))) {
+                append(parameterIt->first.constData(), parameterIt->second);
+                ++parameterIt;
+            } else if (hasPostData) {
+                append(postDataIt->first.constData(), postDataIt->second);
+                ++postDataIt;
+            } else {
+                return;
+            }
+        }
+    };
+    for (const std::pair<const char *, const QByteArray *> &oauthParameter : oauthParameters) {
+        appendUntil(oauthParameter.first);
+        // Requests without a token, like the ones of the OAuth flow, do not have oauth_token
+        if (!oauthParameter.second->isEmpty()) {
+            append(oauthParameter.first, *oauthParameter.second);
+        }
+    }
+    appendUntil(nullptr);
+    parameterString.chop(1);
 
-    // now generate the Authorization header from the encoded parameters map.
-    // we need to remove the query items from the encoded parameters map first.
-    QByteArray authHeader = QByteArray("OAuth ");
+    QByteArray signatureBaseString {requestMethod.toUpper()};
+    signatureBaseString.reserve(signatureBaseString.size() + 3 * (requestUrl.size() + parameterString.size()) + 2);
+    signatureBaseString.append('&').append(requestUrl.toPercentEncoding());
+    signatureBaseString.append('&').append(parameterString.toPercentEncoding());
 
-    for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
-        encodedParams.remove(parameter.first);
+    QByteArray authHeader {"OAuth "};
+    authHeader.reserve(512);
+    authHeader.append(OAUTH_CONSUMER_KEY_KEY).append("=\"").append(m_encodedConsumerKey).append("\", ");
+    authHeader.append(OAUTH_NONCE_KEY).append("=\"").append(nonce).append("\", ");
+    authHeader.append("oauth_signature=\"").append(sign(signatureBaseString).toPercentEncoding()).append("\", ");
+    authHeader.append(OAUTH_SIGNATURE_METHOD_KEY).append("=\"").append(OAUTH_SIGNATURE_METHOD).append("\", ");
+    authHeader.append(OAUTH_TIMESTAMP_KEY).append("=\"").append(timestamp).append("\", ");
+    if (!m_encodedToken.isEmpty()) {
+        authHeader.append(OAUTH_TOKEN_KEY).append("=\"").append(m_encodedToken).append("\", ");
     }
-    keys = encodedParams.keys();
-    foreach (const QByteArray &key, keys) {
-        authHeader += key + "=\"" + encodedParams.value(key) + "\", ";
-    } 
-    authHeader.chop(2);
+    authHeader.append(OAUTH_VERSION_KEY).append("=\"").append(OAUTH_VERSION).append('"');
     return authHeader;
 }
 
+QByteArray TwitterDataUtil::SigningContext::sign(const QByteArray &signatureBaseString) const
+{
+    // HMAC-SHA1, with the padded keys computed once
+    QCryptographicHash innerHash {QCryptographicHash::Sha1};
+    innerHash.addData(m_innerPad);
+    innerHash.addData(signatureBaseString);
+    QCryptographicHash outerHash {QCryptographicHash::Sha1};
+    outerHash.addData(m_outerPad);
+    outerHash.addData(innerHash.result());
+    return outerHash.result().toBase64();
+}
+
+QByteArray TwitterDataUtil::authorizationHeader(const QByteArray &oauthConsumerKey,
+                                                const QByteArray &oauthConsumerSecret,
+                                                const QByteArray &requestMethod,
+                                                const QByteArray &requestUrl,
+                                                const std::vector<std::pair<QByteArray, QByteArray>> &parameters,
+                                                const QByteArray &oauthToken,
+                                                const QByteArray &oauthTokenSecret,
+                                                const QByteArray &oauthNonce,
+                                                const QByteArray &oauthTimestamp)
+{
+    SigningContext context {oauthConsumerKey, oauthConsumerSecret, oauthToken, oauthTokenSecret};
+    std::map<QByteArray, QByteArray> parametersMap (std::begin(parameters), std::end(parameters));
+    return context.authorizationHeader(requestMethod, requestUrl, parametersMap, {}, oauthNonce, oauthTimestamp);
+}
+
 }
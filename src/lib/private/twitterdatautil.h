@@ -32,6 +32,7 @@
 #ifndef TWITTERDATAUTIL_P_H
 #define TWITTERDATAUTIL_P_H
 
+#include <map>
 #include <utility>
 #include <vector>
 #include <QtCore/QByteArray>
@@ -41,6 +42,45 @@ namespace private_util
 
 class TwitterDataUtil {
 public:
+    /**
+     * @brief Precomputed OAuth signing data of an account
+     *
+     * The consumer key, the token and the constant OAuth
+     * parameters are percent-encoded once, and the HMAC-SHA1
+     * key is padded once, so that signing a request only
+     * hashes the signature base string.
+     *
+     * Parameters must already be percent-encoded.
+     */
+    class SigningContext
+    {
+    public:
+        explicit SigningContext() = default;
+        explicit SigningContext(const QByteArray &oauthConsumerKey, const QByteArray &oauthConsumerSecret,
+                                const QByteArray &oauthToken = QByteArray(),
+                                const QByteArray &oauthTokenSecret = QByteArray());
+        /**
+         * @brief Build the Authorization header of a request
+         * @param requestMethod method of the request, like GET or POST.
+         * @param requestUrl URL of the request, without the query.
+         * @param parameters parameters of the query.
+         * @param postData parameters of the body, for POST requests.
+         * @param oauthNonce nonce, or an empty string to generate one.
+         * @param oauthTimestamp timestamp, or an empty string to use the current time.
+         * @return Authorization header.
+         */
+        QByteArray authorizationHeader(const QByteArray &requestMethod, const QByteArray &requestUrl,
+                                       const std::map<QByteArray, QByteArray> &parameters,
+                                       const std::map<QByteArray, QByteArray> &postData = {},
+                                       const QByteArray &oauthNonce = QByteArray(),
+                                       const QByteArray &oauthTimestamp = QByteArray()) const;
+    private:
+        QByteArray sign(const QByteArray &signatureBaseString) const;
+        QByteArray m_encodedConsumerKey {};
+        QByteArray m_encodedToken {};
+        QByteArray m_innerPad {};
+        QByteArray m_outerPad {};
+    };
     static QByteArray authorizationHeader(const QByteArray &oauthConsumerKey,
                                           const QByteArray &oauthConsumerSecret,
                                           const QByteArray &requestMethod,
@@ -34,6 +34,7 @@
 #include <QtCore/QUrlQuery>
 #include <QtNetwork/QNetworkAccessManager>
 #include "account.h"
+#include "networkstack.h"
 #include "twitter-secrets.h"
 #include "twitterdatautil.h"
 
@@ -41,26 +42,76 @@ namespace private_util
 {
 
 #ifndef USE_MOCK_SERVER
-static const char *TWITTER_API_URL = "https://api.twitter.com/1.1/";
+static const char *TWITTER_BASE_URL = "https://api.twitter.com/";
 #else
-static const char *TWITTER_API_URL = "http://localhost:8000/";
+static const char *TWITTER_BASE_URL = "http://localhost:8000/";
 #endif
+static const char *TWITTER_API_PATH = "1.1/";
+static const char *TWITTER_OAUTH_PATH = "oauth/";
+// Streams are served by other hosts than the REST API
+static const char *TWITTER_URL = "https://api.twitter.com/";
+static const char *TWITTER_USER_STREAM_URL = "https://userstream.twitter.com/1.1/user.json";
+static const char *TWITTER_FILTER_STREAM_URL = "https://stream.twitter.com/1.1/statuses/filter.json";
+static const char *USER_STREAM_PATH = "user.json";
+static const char *FILTER_STREAM_PATH = "statuses/filter.json";
 
-QNetworkReply * TwitterQueryUtil::get(QNetworkAccessManager &network, const QByteArray &path,
+QByteArray TwitterQueryUtil::defaultBaseUrl()
+{
+    return QByteArray(TWITTER_BASE_URL);
+}
+
+QByteArray TwitterQueryUtil::apiUrl(const QByteArray &baseUrl)
+{
+    return baseUrl + TWITTER_API_PATH;
+}
+
+QByteArray TwitterQueryUtil::oauthUrl(const QByteArray &baseUrl)
+{
+    return baseUrl + TWITTER_OAUTH_PATH;
+}
+
+QByteArray TwitterQueryUtil::userStreamUrl(const QByteArray &baseUrl)
+{
+    if (baseUrl == TWITTER_URL) {
+        return QByteArray(TWITTER_USER_STREAM_URL);
+    }
+    return apiUrl(baseUrl) + USER_STREAM_PATH;
+}
+
+QByteArray TwitterQueryUtil::filterStreamUrl(const QByteArray &baseUrl)
+{
+    if (baseUrl == TWITTER_URL) {
+        return QByteArray(TWITTER_FILTER_STREAM_URL);
+    }
+    return apiUrl(baseUrl) + FILTER_STREAM_PATH;
+}
+
+TwitterDataUtil::SigningContext TwitterQueryUtil::signingContext(const Account &account)
+{
+    return TwitterDataUtil::SigningContext(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET,
+                                           account.token(), account.tokenSecret());
+}
+
+QNetworkReply * TwitterQueryUtil::get(QNetworkAccessManager &network, const QByteArray &apiUrl,
+                                      const QByteArray &path,
                                       const std::map<QByteArray, QByteArray> &parameters,
-                                      const Account &account)
+                                      const TwitterDataUtil::SigningContext &signingContext,
+                                      const std::map<QByteArray, QByteArray> &headers)
 {
-    QNetworkRequest request {createGetRequest(path, parameters, account)};
+    QNetworkRequest request {createGetRequest(apiUrl, path, parameters, signingContext)};
+    for (const std::pair<QByteArray, QByteArray> &header : headers) {
+        request.setRawHeader(header.first, header.second);
+    }
     return network.get(request);
 }
 
-QNetworkReply * TwitterQueryUtil::post(QNetworkAccessManager &network,
+QNetworkReply * TwitterQueryUtil::post(QNetworkAccessManager &network, const QByteArray &apiUrl,
                                        const QByteArray &path,
                                        const std::map<QByteArray, QByteArray> &parameters,
                                        const std::map<QByteArray, QByteArray> &postData,
-                                       const Account &account)
+                                       const TwitterDataUtil::SigningContext &signingContext)
 {
-    QNetworkRequest request {createPostRequest(path, parameters, postData, account)};
+    QNetworkRequest request {createPostRequest(apiUrl, path, parameters, postData, signingContext)};
     QUrlQuery postDataQuery {};
     for (const std::pair<QByteArray, QByteArray> &parameter : postData) {
         postDataQuery.addQueryItem(QLatin1String(parameter.first), QLatin1String(parameter.second));
@@ -68,18 +119,14 @@ QNetworkReply * TwitterQueryUtil::post(QNetworkAccessManager &network,
     return network.post(request, postDataQuery.toString(QUrl::FullyEncoded).toLatin1());
 }
 
-QNetworkRequest TwitterQueryUtil::createRequest(const QByteArray &type, const QByteArray &path,
+QNetworkRequest TwitterQueryUtil::createRequest(const QByteArray &type, const QByteArray &apiUrl,
+                                                const QByteArray &path,
                                                 const std::map<QByteArray, QByteArray> &parameters,
                                                 const std::map<QByteArray, QByteArray> &postData,
-                                                const Account &account)
+                                                const TwitterDataUtil::SigningContext &signingContext)
 {
-    QByteArray url {QByteArray(TWITTER_API_URL) + path};
-    std::map<QByteArray, QByteArray> fullParameters (std::begin(parameters), std::end(parameters));
-    fullParameters.insert(std::begin(postData), std::end(postData));
-    std::vector<std::pair<QByteArray, QByteArray>> parametersVector (std::begin(fullParameters), std::end(fullParameters));
-
-    QByteArray header {TwitterDataUtil::authorizationHeader(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET, type, url,
-                                                            parametersVector, account.token(), account.tokenSecret())};
+    QByteArray url {apiUrl + path};
+    QByteArray header {signingContext.authorizationHeader(type, url, parameters, postData)};
     QUrl urlObject {QUrl::fromEncoded(url)};
     QUrlQuery query {};
     for (const std::pair<QByteArray, QByteArray> &parameter : parameters) {
@@ -89,22 +136,34 @@ QNetworkRequest TwitterQueryUtil::createRequest(const QByteArray &type, const QB
 
     QNetworkRequest request {urlObject};
     request.setRawHeader("Authorization", header);
+    // Replies are then not decompressed by Qt, but while they are parsed, see GzipDevice
+    request.setRawHeader("Accept-Encoding", "gzip");
+    NetworkStack::prepare(request);
+    return request;
+}
+
+QNetworkRequest TwitterQueryUtil::createStreamRequest(const QByteArray &url,
+                                                   const std::map<QByteArray, QByteArray> &parameters,
+                                                   const TwitterDataUtil::SigningContext &signingContext)
+{
+    QNetworkRequest request {createRequest("GET", url, QByteArray(), parameters, {}, signingContext)};
+    request.setRawHeader("Accept-Encoding", "identity");
     return request;
 }
 
-QNetworkRequest TwitterQueryUtil::createGetRequest(const QByteArray &path,
+QNetworkRequest TwitterQueryUtil::createGetRequest(const QByteArray &apiUrl, const QByteArray &path,
                                                    const std::map<QByteArray, QByteArray> &parameters,
-                                                   const Account &account)
+                                                   const TwitterDataUtil::SigningContext &signingContext)
 {
-    return createRequest("GET", path, parameters, {}, account);
+    return createRequest("GET", apiUrl, path, parameters, {}, signingContext);
 }
 
-QNetworkRequest TwitterQueryUtil::createPostRequest(const QByteArray &path,
+QNetworkRequest TwitterQueryUtil::createPostRequest(const QByteArray &apiUrl, const QByteArray &path,
                                                     const std::map<QByteArray, QByteArray> &parameters,
                                                     const std::map<QByteArray, QByteArray> &postData,
-                                                    const Account &account)
+                                                    const TwitterDataUtil::SigningContext &signingContext)
 {
-    QNetworkRequest request {createRequest("POST", path, parameters, postData, account)};
+    QNetworkRequest request {createRequest("POST", apiUrl, path, parameters, postData, signingContext)};
     request.setHeader(QNetworkRequest::ContentTypeHeader, QLatin1String("application/x-www-form-urlencoded"));
     return request;
 }
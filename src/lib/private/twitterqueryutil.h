@@ -34,6 +34,7 @@
 
 #include <map>
 #include <QtNetwork/QNetworkRequest>
+#include "twitterdatautil.h"
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -45,25 +46,91 @@ namespace private_util
 class TwitterQueryUtil
 {
 public:
-    static QNetworkReply * get(QNetworkAccessManager &network, const QByteArray &path,
+    /**
+     * @brief Default base URL of Twitter
+     *
+     * The REST API and the OAuth endpoints are relative
+     * to this URL, see apiUrl() and oauthUrl().
+     *
+     * @return default base URL of Twitter.
+     */
+    static QByteArray defaultBaseUrl();
+    /**
+     * @brief URL of the REST API
+     * @param baseUrl base URL of Twitter.
+     * @return URL of the REST API.
+     */
+    static QByteArray apiUrl(const QByteArray &baseUrl);
+    /**
+     * @brief URL of the OAuth endpoints
+     * @param baseUrl base URL of Twitter.
+     * @return URL of the OAuth endpoints.
+     */
+    static QByteArray oauthUrl(const QByteArray &baseUrl);
+    /**
+     * @brief URL of the user stream
+     *
+     * Twitter serves the streams from other hosts. Other
+     * base URLs, like a local server, serve them with the
+     * REST API.
+     *
+     * @param baseUrl base URL of Twitter.
+     * @return URL of the stream of the home timeline.
+     */
+    static QByteArray userStreamUrl(const QByteArray &baseUrl);
+    /**
+     * @brief URL of the filter stream
+     * @param baseUrl base URL of Twitter.
+     * @return URL of the stream of the tweets matching keywords.
+     */
+    static QByteArray filterStreamUrl(const QByteArray &baseUrl);
+    /**
+     * @brief Create the signing context of an account
+     *
+     * The context can be reused for all the requests of
+     * the account, see TwitterDataUtil::SigningContext.
+     *
+     * @param account account used to sign the requests.
+     * @return signing context of the account.
+     */
+    static TwitterDataUtil::SigningContext signingContext(const Account &account);
+    static QNetworkReply * get(QNetworkAccessManager &network, const QByteArray &apiUrl,
+                               const QByteArray &path,
                                const std::map<QByteArray, QByteArray> &parameters,
-                               const Account &account);
-    static QNetworkReply * post(QNetworkAccessManager &network, const QByteArray &path,
+                               const TwitterDataUtil::SigningContext &signingContext,
+                               const std::map<QByteArray, QByteArray> &headers = {});
+    static QNetworkReply * post(QNetworkAccessManager &network, const QByteArray &apiUrl,
+                                const QByteArray &path,
                                 const std::map<QByteArray, QByteArray> &parameters,
                                 const std::map<QByteArray, QByteArray> &postData,
-                                const Account &account);
+                                const TwitterDataUtil::SigningContext &signingContext);
+    /**
+     * @brief Create the request of a stream
+     *
+     * Lines are read as soon as they are received, so
+     * streams are not compressed.
+     *
+     * @param url URL of the stream.
+     * @param parameters parameters of the stream.
+     * @param signingContext signing context of the account.
+     * @return request of the stream.
+     */
+    static QNetworkRequest createStreamRequest(const QByteArray &url,
+                                               const std::map<QByteArray, QByteArray> &parameters,
+                                               const TwitterDataUtil::SigningContext &signingContext);
 private:
-    static QNetworkRequest createRequest(const QByteArray &type, const QByteArray &path,
+    static QNetworkRequest createRequest(const QByteArray &type, const QByteArray &apiUrl,
+                                         const QByteArray &path,
                                          const std::map<QByteArray, QByteArray> &parameters,
                                          const std::map<QByteArray, QByteArray> &postData,
-                                         const Account &account);
-    static QNetworkRequest createGetRequest(const QByteArray &path,
+                                         const TwitterDataUtil::SigningContext &signingContext);
+    static QNetworkRequest createGetRequest(const QByteArray &apiUrl, const QByteArray &path,
                                             const std::map<QByteArray, QByteArray> &parameters,
-                                            const Account &account);
-    static QNetworkRequest createPostRequest(const QByteArray &path,
+                                            const TwitterDataUtil::SigningContext &signingContext);
+    static QNetworkRequest createPostRequest(const QByteArray &apiUrl, const QByteArray &path,
                                              const std::map<QByteArray, QByteArray> &parameters,
                                              const std::map<QByteArray, QByteArray> &postData,
-                                             const Account &account);
+                                             const TwitterDataUtil::SigningContext &signingContext);
 };
 
 }
@@ -45,7 +45,7 @@ QVariant AccountModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<AccountObject> &account = m_items[row];
+    AccountObject *account {item(row)};
     switch (role) {
     case NameRole:
         return account->name();
@@ -54,7 +54,7 @@ QVariant AccountModel::data(const QModelIndex &index, int role) const
         return account->screenName();
         break;
     case AccountRole:
-        return QVariant::fromValue(account.get());
+        return QVariant::fromValue(account);
         break;
     default:
         return QVariant();
@@ -64,16 +64,14 @@ QVariant AccountModel::data(const QModelIndex &index, int role) const
 
 AccountObject * AccountModel::get(const QString &userId) const
 {
-    auto it = std::find_if(std::begin(m_items), std::end(m_items), [userId](const QObjectPtr<AccountObject> &object) {
-        return object->userId() == userId;
-    });
-    return it == std::end(m_items) ? nullptr : it->get();
+    int index {getIndex(userId)};
+    return index != -1 ? item(index) : nullptr;
 }
 
 int AccountModel::getIndex(const QString &userId) const
 {
-    for (size_t i = 0; i < m_items.size(); ++i) {
-        if (m_items[i]->userId() == userId) {
+    for (int i = 0; i < rowCount(); ++i) {
+        if (item(i)->userId() == userId) {
             return i;
         }
     }
@@ -51,7 +51,7 @@ void AccountSelectionModel::setCurrentIndex(int currentIndex)
         emit currentIndexChanged();
 
         if (m_currentIndex >= 0 && m_currentIndex < rowCount()) {
-            setSelection(m_items.at(m_currentIndex).get());
+            setSelection(item(m_currentIndex));
         } else {
             setSelection(nullptr);
         }
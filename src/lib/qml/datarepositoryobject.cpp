@@ -30,9 +30,12 @@
  */
 
 #include "datarepositoryobject.h"
+#include <algorithm>
+#include <QtCore/QThreadPool>
 #include <QtCore/QVariantMap>
 #include "private/conversionutil.h"
-#include "private/networkqueryexecutor.h"
+#include "private/queryexecutorfactory.h"
+#include "private/sharedqueryexecutor.h"
 #include "accountobject.h"
 #include "query.h"
 #include "querytypeobject.h"
@@ -43,12 +46,15 @@ namespace qml
 
 DataRepositoryObject::DataRepositoryObject(QObject *parent)
     : QObject(parent)
-    , m_network(new QNetworkAccessManager())
-    , m_tweetRepositoryContainer(private_util::NetworkQueryExecutor::create(*m_network))
-    , m_userRepositoryContainer(private_util::NetworkQueryExecutor::create(*m_network))
-    , m_listRepositoryContainer(private_util::NetworkQueryExecutor::create(*m_network))
-    , m_itemQueryContainer(private_util::NetworkQueryExecutor::create(*m_network))
-{
+    , m_networkStack(private_util::NetworkStack::instance())
+    , m_rateLimitScheduler(std::make_shared<private_util::RateLimitScheduler>(private_util::QueryExecutorFactory::createTransport(m_networkStack->network())))
+    , m_queryExecutor(private_util::QueryExecutorFactory::create(private_util::SharedQueryExecutor::create(m_rateLimitScheduler)))
+    , m_tweetRepositoryContainer(private_util::SharedQueryExecutor::create(m_queryExecutor), QThreadPool::globalInstance())
+    , m_userRepositoryContainer(private_util::SharedQueryExecutor::create(m_queryExecutor), QThreadPool::globalInstance())
+    , m_listRepositoryContainer(private_util::SharedQueryExecutor::create(m_queryExecutor), QThreadPool::globalInstance())
+    , m_itemQueryContainer(private_util::SharedQueryExecutor::create(m_queryExecutor))
+{
+    m_tweetRepositoryContainer.setCache(TimelineCache(TimelineCache::defaultDirPath()));
     m_loadSaveManager.load(m_accounts);
     for (const Account &account : m_accounts) {
         m_accountsMapping.emplace(account.userId(), account);
@@ -57,6 +63,12 @@ DataRepositoryObject::DataRepositoryObject(QObject *parent)
     for (const Layout &layout : m_layouts) {
         m_tweetRepositoryContainer.referenceQuery(account(layout.accountUserId()), layout.query());
     }
+    m_streamDispatcher.reset(new private_util::StreamDispatcher(m_networkStack->network(),
+                                                                private_util::QueryExecutorFactory::baseUrl(),
+                                                                m_tweetRepositoryContainer));
+    m_streaming = private_util::QueryExecutorFactory::isStreaming();
+    m_refreshScheduler.reset(new private_util::RefreshScheduler(m_tweetRepositoryContainer));
+    updateTimelines();
 }
 
 bool DataRepositoryObject::hasAccounts() const
@@ -133,6 +145,43 @@ ItemQueryContainer * DataRepositoryObject::itemQueryContainer()
     return &m_itemQueryContainer;
 }
 
+QVariantList DataRepositoryObject::rateLimits() const
+{
+    QVariantList returned {};
+    for (const private_util::RateLimitScheduler::Limit &limit : m_rateLimitScheduler->limits()) {
+        QVariantMap entry {};
+        entry.insert(QLatin1String("accountUserId"), limit.accountUserId);
+        entry.insert(QLatin1String("path"), QString::fromLatin1(limit.path));
+        entry.insert(QLatin1String("limit"), limit.limit);
+        entry.insert(QLatin1String("remaining"), limit.remaining);
+        entry.insert(QLatin1String("reset"), limit.reset);
+        entry.insert(QLatin1String("queued"), limit.queued);
+        returned.append(entry);
+    }
+    return returned;
+}
+
+QVariantMap DataRepositoryObject::networkStatistics() const
+{
+    const private_util::NetworkStack::Statistics &statistics (m_networkStack->statistics());
+    QVariantMap returned {};
+    returned.insert(QLatin1String("requests"), statistics.requests);
+    returned.insert(QLatin1String("connections"), statistics.connections);
+    returned.insert(QLatin1String("http2Requests"), statistics.http2Requests);
+    returned.insert(QLatin1String("warmUps"), statistics.warmUps);
+    returned.insert(QLatin1String("reuseRate"), statistics.reuseRate());
+    QVariantMap transfers {};
+    for (const std::pair<QByteArray, private_util::NetworkStack::Transfer> &transfer : statistics.transfers) {
+        QVariantMap entry {};
+        entry.insert(QLatin1String("replies"), transfer.second.replies);
+        entry.insert(QLatin1String("wireBytes"), transfer.second.wireBytes);
+        entry.insert(QLatin1String("decodedBytes"), transfer.second.decodedBytes);
+        transfers.insert(QString::fromUtf8(transfer.first), entry);
+    }
+    returned.insert(QLatin1String("transfers"), transfers);
+    return returned;
+}
+
 int DataRepositoryObject::addAccount(const QString &name, const QString &userId,
                                      const QString &screenName,
                                      const QString &token, const QString &tokenSecret)
@@ -168,7 +217,10 @@ void DataRepositoryObject::removeAccount(int index)
     }
 
     bool oldHasAccounts = hasAccounts();
-    const QString accountUserId {(std::begin(m_accounts) + index)->userId()};
+    const Account removedAccount {*(std::begin(m_accounts) + index)};
+    const QString accountUserId {removedAccount.userId()};
+    m_streamDispatcher->setQueries(removedAccount, {});
+    m_refreshScheduler->setQueries(removedAccount, {});
     m_accountsMapping.erase(accountUserId);
     m_accounts.remove(index);
     m_loadSaveManager.save(m_accounts);
@@ -181,8 +233,13 @@ void DataRepositoryObject::removeAccount(int index)
     }
     std::sort(std::begin(removedIndexes), std::end(removedIndexes), [](int first, int second) { return first > second; });
 
-    for (int i : removedIndexes) {
-        dereferenceLayoutTweetList(i);
+    {
+        // Layouts are removed from the end, so that
+        // adjacent layouts are notified as one range
+        LayoutRepository::Transaction transaction {m_layouts};
+        for (int i : removedIndexes) {
+            dereferenceLayoutTweetList(i);
+        }
     }
     m_loadSaveManager.save(m_layouts);
 
@@ -216,6 +273,7 @@ void DataRepositoryObject::addLayout(const QString &name, const QString &account
     m_tweetRepositoryContainer.referenceQuery(account(accountUserId), query);
     m_layouts.append(std::move(Layout(name, accountUserId, std::move(query))));
     m_loadSaveManager.save(m_layouts);
+    updateTimelines();
     refresh();
 }
 
@@ -239,6 +297,7 @@ void DataRepositoryObject::addDefaultLayouts(int accountIndex, const QString &ho
         m_layouts.append(Layout{mentionsName, userId, std::move(query)});
     }
     m_loadSaveManager.save(m_layouts);
+    updateTimelines();
     refresh();
 }
 
@@ -259,14 +318,21 @@ void DataRepositoryObject::updateLayout(int index, const QString &name, int acco
         std::move(private_util::convertParameters(parameters))
     };
 
-    const Layout &oldLayout {*(std::begin(m_layouts) + index)};
+    const Layout oldLayout {*(std::begin(m_layouts) + index)};
+    bool oldWasVisible {isTimelineVisible(oldLayout.accountUserId(), oldLayout.query())};
+    bool newWasVisible {isTimelineVisible(accountUserId, query)};
     m_tweetRepositoryContainer.dereferenceQuery(account(oldLayout.accountUserId()), oldLayout.query());
 
     Layout layout {name, accountUserId, std::move(query)};
     m_tweetRepositoryContainer.referenceQuery(account(layout.accountUserId()), layout.query());
-
     m_layouts.update(index, std::move(layout));
     m_loadSaveManager.save(m_layouts);
+    updateTimelines();
+
+    // The layout keeps its visibility, that moves to its new timeline
+    const Layout &updatedLayout {*(std::begin(m_layouts) + index)};
+    updateTimelineVisibility(oldLayout.accountUserId(), oldLayout.query(), oldWasVisible);
+    updateTimelineVisibility(updatedLayout.accountUserId(), updatedLayout.query(), newWasVisible);
     refresh();
 }
 
@@ -278,6 +344,7 @@ void DataRepositoryObject::updateLayoutUnread(int index, int unread)
     Layout layout {*(std::begin(m_layouts) + index)};
     layout.setUnread(unread);
     m_layouts.update(index, std::move(layout));
+    updateRefreshPriorities();
 }
 
 void DataRepositoryObject::removeLayout(int index)
@@ -288,16 +355,73 @@ void DataRepositoryObject::removeLayout(int index)
 
     dereferenceLayoutTweetList(index);
     m_loadSaveManager.save(m_layouts);
+    updateTimelines();
 }
 
 void DataRepositoryObject::moveLayout(int from, int to)
 {
+    if (from < 0 || from >= m_layouts.size() || to < 0 || to > m_layouts.size()
+        || to == from || to == from + 1) {
+        return;
+    }
+
+    // The visible layouts follow the move
+    int toIndex {(to < from) ? to : to - 1};
+    std::set<int> visibleLayouts {};
+    for (int index : m_visibleLayouts) {
+        if (index == from) {
+            visibleLayouts.insert(toIndex);
+        } else if (from < index && index <= toIndex) {
+            visibleLayouts.insert(index - 1);
+        } else if (toIndex <= index && index < from) {
+            visibleLayouts.insert(index + 1);
+        } else {
+            visibleLayouts.insert(index);
+        }
+    }
+    m_visibleLayouts = std::move(visibleLayouts);
+
     m_layouts.move(from, to);
     m_loadSaveManager.save(m_layouts);
 }
 
+void DataRepositoryObject::setLayoutVisible(int index, bool visible)
+{
+    if (index < 0 || index >= m_layouts.size()) {
+        return;
+    }
+    const Layout &layout {*(std::begin(m_layouts) + index)};
+    bool wasVisible {isTimelineVisible(layout.accountUserId(), layout.query())};
+    if (visible) {
+        m_visibleLayouts.insert(index);
+    } else {
+        m_visibleLayouts.erase(index);
+    }
+    updateTimelineVisibility(layout.accountUserId(), layout.query(), wasVisible);
+    updateRefreshPriorities();
+}
+
+void DataRepositoryObject::setOnline(bool online)
+{
+    m_networkStack->setOnline(online);
+    m_streamDispatcher->setEnabled(m_streaming && online);
+    m_refreshScheduler->setOnline(online);
+}
+
+void DataRepositoryObject::setStreaming(bool streaming)
+{
+    m_streaming = streaming;
+    m_streamDispatcher->setEnabled(m_streaming && m_networkStack->isOnline());
+}
+
+void DataRepositoryObject::setActive(bool active)
+{
+    m_refreshScheduler->setActive(active);
+}
+
 void DataRepositoryObject::refresh()
 {
+    updateRefreshPriorities();
     m_tweetRepositoryContainer.refresh();
 }
 
@@ -401,7 +525,7 @@ void DataRepositoryObject::loadMore(QObject *query)
 
 void DataRepositoryObject::setTweetRetweeted(const QString &tweetId)
 {
-    Tweet tweet = m_tweetRepositoryContainer.tweet(tweetId);
+    Tweet tweet = m_tweetRepositoryContainer.tweet(TwitterId::fromString(tweetId));
     if (tweet.isValid()) {
         tweet.setRetweeted(true);
         m_tweetRepositoryContainer.updateTweet(tweet);
@@ -410,7 +534,7 @@ void DataRepositoryObject::setTweetRetweeted(const QString &tweetId)
 
 void DataRepositoryObject::setTweetFavorited(const QString &tweetId, bool favorited)
 {
-    Tweet tweet = m_tweetRepositoryContainer.tweet(tweetId);
+    Tweet tweet = m_tweetRepositoryContainer.tweet(TwitterId::fromString(tweetId));
     if (tweet.isValid()) {
         tweet.setFavorited(favorited);
         m_tweetRepositoryContainer.updateTweet(tweet);
@@ -429,9 +553,86 @@ bool DataRepositoryObject::addLayoutCheckAccount(int accountIndex, QString &user
 
 void DataRepositoryObject::dereferenceLayoutTweetList(int index)
 {
-    const Layout &layout {*(std::begin(m_layouts) + index)};
+    const Layout layout {*(std::begin(m_layouts) + index)};
+    bool wasVisible {isTimelineVisible(layout.accountUserId(), layout.query())};
+
+    // The indexes of the next visible layouts are shifted
+    std::set<int> visibleLayouts {};
+    for (int visibleIndex : m_visibleLayouts) {
+        if (visibleIndex < index) {
+            visibleLayouts.insert(visibleIndex);
+        } else if (visibleIndex > index) {
+            visibleLayouts.insert(visibleIndex - 1);
+        }
+    }
+    m_visibleLayouts = std::move(visibleLayouts);
+
     m_tweetRepositoryContainer.dereferenceQuery(account(layout.accountUserId()), layout.query());
     m_layouts.remove(index);
+    updateTimelineVisibility(layout.accountUserId(), layout.query(), wasVisible);
+}
+
+bool DataRepositoryObject::isTimelineVisible(const QString &accountUserId, const Query &query) const
+{
+    for (int index : m_visibleLayouts) {
+        const Layout &layout {*(std::begin(m_layouts) + index)};
+        if (layout.accountUserId() == accountUserId && layout.query() == query) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DataRepositoryObject::updateTimelineVisibility(const QString &accountUserId, const Query &query,
+                                                    bool wasVisible)
+{
+    // The schedulers are only notified when the last visible layout
+    // of a timeline is hidden, or the first one is shown
+    bool visible {isTimelineVisible(accountUserId, query)};
+    if (visible == wasVisible) {
+        return;
+    }
+    m_rateLimitScheduler->setHighPriority(account(accountUserId), query, visible);
+    m_refreshScheduler->setVisible(account(accountUserId), query, visible);
+}
+
+void DataRepositoryObject::updateRefreshPriorities()
+{
+    // Layouts can share a timeline, that gets the highest priority
+    std::map<std::pair<QString, Query>, TweetRepositoryContainer::RefreshPriority> priorities {};
+    for (int i = 0; i < m_layouts.size(); ++i) {
+        const Layout &layout {*(std::begin(m_layouts) + i)};
+        std::pair<QString, Query> key {layout.accountUserId(), layout.query()};
+        TweetRepositoryContainer::RefreshPriority priority {TweetRepositoryContainer::Background};
+        if (m_visibleLayouts.count(i) > 0) {
+            priority = TweetRepositoryContainer::Visible;
+        } else if (layout.unread() > 0) {
+            priority = TweetRepositoryContainer::Unread;
+        }
+        auto it = priorities.find(key);
+        if (it == std::end(priorities)) {
+            priorities.emplace(key, priority);
+        } else {
+            it->second = std::max(it->second, priority);
+        }
+    }
+    for (const auto &it : priorities) {
+        m_tweetRepositoryContainer.setRefreshPriority(account(it.first.first), it.first.second, it.second);
+    }
+}
+
+void DataRepositoryObject::updateTimelines()
+{
+    for (const Account &account : m_accounts) {
+        std::set<Query> queries {};
+        for (const Layout &layout : m_layouts) {
+            if (layout.accountUserId() == account.userId()) {
+                queries.insert(layout.query());
+            }
+        }
+        m_streamDispatcher->setQueries(account, queries);
+        m_refreshScheduler->setQueries(account, queries);
+    }
 }
 
 }
@@ -32,6 +32,7 @@
 #ifndef DATAREPOSITORYOBJECT_H
 #define DATAREPOSITORYOBJECT_H
 
+#include <set>
 #include <QtCore/QObject>
 #include "qobjectutils.h"
 #include "loadsavemanager.h"
@@ -46,6 +47,10 @@
 #include "iuserrepositorycontainerobject.h"
 #include "ilistrepositorycontainerobject.h"
 #include "iitemquerycontainerobject.h"
+#include "private/networkstack.h"
+#include "private/ratelimitscheduler.h"
+#include "private/refreshscheduler.h"
+#include "private/streamdispatcher.h"
 
 namespace qml
 {
@@ -85,6 +90,28 @@ public:
     void dereferenceListRepositoryQuery(const Account &account, const Query &query) override;
     Account account(const QString &accountUserId) const override;
     ItemQueryContainer * itemQueryContainer() override;
+    /**
+     * @brief State of the rate limits
+     *
+     * Each entry contains the account, the path, the limit, the
+     * remaining requests, the time of the reset in seconds since
+     * epoch, and the number of queued requests.
+     *
+     * @return state of the rate limits, per account and per endpoint.
+     */
+    Q_INVOKABLE QVariantList rateLimits() const;
+    /**
+     * @brief Statistics of the network connections
+     *
+     * Contains the number of requests, of opened connections, of
+     * requests sent with HTTP/2, of warm ups, and the ratio of
+     * requests that reused a connection. "transfers" contains, per
+     * path, the number of replies, and their size as received
+     * ("wireBytes") and after decompression ("decodedBytes").
+     *
+     * @return statistics of the network connections.
+     */
+    Q_INVOKABLE QVariantMap networkStatistics() const;
 signals:
     void hasAccountsChanged();
 public slots:
@@ -105,6 +132,46 @@ public slots:
     void updateLayoutUnread(int index, int unread);
     void removeLayout(int index);
     void moveLayout(int from, int to);
+    /**
+     * @brief Set if a layout is on screen
+     *
+     * Visible layouts are refreshed first, and can use the
+     * requests that are reserved in the rate limits.
+     *
+     * @param index index of the layout.
+     * @param visible if the layout is on screen.
+     */
+    void setLayoutVisible(int index, bool visible);
+    /**
+     * @brief Set if the network is online
+     *
+     * Connections to Twitter are opened in advance when the
+     * network comes online, and the timelines are only refreshed
+     * automatically while it is online.
+     *
+     * @param online if the network is online.
+     */
+    void setOnline(bool online);
+    /**
+     * @brief Set if the timelines are streamed
+     *
+     * While the network is online, the home timelines, the mentions
+     * and the searches receive their tweets from streams, instead of
+     * being refreshed, see private_util::StreamDispatcher.
+     *
+     * @param streaming if the timelines are streamed.
+     */
+    void setStreaming(bool streaming);
+    /**
+     * @brief Set if the application is in the foreground
+     *
+     * The timelines are refreshed automatically, at an interval that
+     * depends on their activity, only while the application is in
+     * the foreground, see private_util::RefreshScheduler.
+     *
+     * @param active if the application is in the foreground.
+     */
+    void setActive(bool active);
     void refresh();
     void refresh(QObject *query);
     void loadMore(QObject *query);
@@ -114,16 +181,32 @@ public slots:
 private:
     bool addLayoutCheckAccount(int accountIndex, QString &userId);
     void dereferenceLayoutTweetList(int index);
+    bool isTimelineVisible(const QString &accountUserId, const Query &query) const;
+    void updateTimelineVisibility(const QString &accountUserId, const Query &query, bool wasVisible);
+    void updateRefreshPriorities();
+    void updateTimelines();
 
-    QObjectPtr<QNetworkAccessManager> m_network {nullptr};
+    // Shared with the authentification, so that connections are reused
+    std::shared_ptr<private_util::NetworkStack> m_networkStack {};
+    std::shared_ptr<private_util::RateLimitScheduler> m_rateLimitScheduler {};
+    // Shared between the containers, so that identical queries are merged
+    IQueryExecutor::SharedPtr m_queryExecutor {};
     LoadSaveManager m_loadSaveManager {};
     AccountRepository m_accounts {};
     std::map<QString, const Account &> m_accountsMapping {};
     LayoutRepository m_layouts {};
+    // Indexes of the layouts that are on screen. Layouts can share
+    // a timeline, that is visible while one of them is on screen.
+    std::set<int> m_visibleLayouts {};
     TweetRepositoryContainer m_tweetRepositoryContainer;
     UserRepositoryContainer m_userRepositoryContainer;
     ListRepositoryContainer m_listRepositoryContainer;
     ItemQueryContainer m_itemQueryContainer;
+    // Destroyed before the containers it feeds
+    std::unique_ptr<private_util::StreamDispatcher> m_streamDispatcher {};
+    bool m_streaming {false};
+    // Destroyed before the repositories it listens to
+    std::unique_ptr<private_util::RefreshScheduler> m_refreshScheduler {};
 };
 
 }
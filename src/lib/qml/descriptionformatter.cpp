@@ -60,7 +60,9 @@ void DescriptionFormatter::format()
     if (m_user == nullptr) {
         return;
     }
-    doFormat(m_user->description(), m_user->data().descriptionEntities());
+    const User &data {m_user->data()};
+    doFormat(QString(QLatin1String("description/%1")).arg(data.id().toString()), m_user->description(),
+             data.descriptionEntities());
 }
 
 }
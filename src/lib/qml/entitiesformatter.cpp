@@ -30,15 +30,32 @@
  */
 
 #include "entitiesformatter.h"
-#include "mediaentity.h"
-#include "urlentity.h"
-#include "usermentionentity.h"
-#include "hashtagentity.h"
-#include "entityvisitor.h"
+#include <QtCore/QCache>
+#include "private/entityformatutil.h"
 
 namespace qml
 {
 
+namespace
+{
+
+struct FormattedText
+{
+    QString input;
+    QString text;
+};
+
+}
+
+static const int CACHE_MAXIMUM_COST {1 << 20};
+
+// Used from the main thread only, like the formatters
+static QCache<QString, FormattedText> & formattedTextCache()
+{
+    static QCache<QString, FormattedText> cache {CACHE_MAXIMUM_COST};
+    return cache;
+}
+
 EntitiesFormatter::EntitiesFormatter(QObject *parent)
     : QObject(parent)
 {
@@ -59,100 +76,35 @@ QString EntitiesFormatter::text() const
     return m_text;
 }
 
-void EntitiesFormatter::doFormat(const QString &input, Entity::List &&entities, bool includeLinks)
+void EntitiesFormatter::doFormat(const QString &cacheKey, const QString &input,
+                                 const Entity::List &entities, bool includeLinks)
 {
-    class FormatterVisitor: public EntityVisitor
-    {
-    public:
-        explicit FormatterVisitor(const QString &text, bool includeLinks)
-            : m_text(text), m_includeLinks(includeLinks)
-        {
-        }
-        QString text() const
-        {
-            return m_text;
-        }
-        void visitMedia(const MediaEntity &entity) override
-        {
-            if (!entity.isValid()) {
-                return;
-            }
-
-            QString after {};
-            if (m_includeLinks) {
-                after = QString(QLatin1String("<a href=\"%1\">%2</a>")).arg(entity.expandedUrl(), entity.displayUrl());
-            } else {
-                after = entity.displayUrl();
-            }
-            m_text.replace(entity.text(), after);
-        }
-        void visitUrl(const UrlEntity &entity) override
-        {
-            if (!entity.isValid()) {
-                return;
-            }
-
-            QString after {};
-            if (m_includeLinks) {
-                after = QString(QLatin1String("<a href=\"%1\">%2</a>")).arg(entity.expandedUrl(), entity.displayUrl());
-            } else {
-                after = entity.displayUrl();
-            }
-            m_text.replace(entity.text(), after);
-        }
-        void visitUserMention(const UserMentionEntity &entity) override
-        {
-            if (!entity.isValid()) {
-                return;
-            }
-
-            if (m_includeLinks) {
-                QString after {QString(QLatin1String("<a href=\"user://%1\">@%2</a>")).arg(entity.id(), entity.screenName())};
-                m_text.replace(entity.text(), after, Qt::CaseInsensitive);
-            }
-        }
-        void visitHashtag(const HashtagEntity &entity) override
-        {
-            if (!entity.isValid()) {
-                return;
-            }
-
-            if (m_includeLinks) {
-                QString before {QString(QLatin1String("#%1")).arg(entity.text())};
-                QString after {QString(QLatin1String("<a href=\"hashtag://%1\">#%1</a>")).arg(entity.text())};
-                m_text.replace(before, after, Qt::CaseInsensitive);
-            }
-        }
-    private:
-        QString m_text {};
-        bool m_includeLinks {false};
-    };
-
     if (!m_complete) {
         return;
     }
 
-    // Be sure to render the longer entities first
-    std::sort(std::begin(entities), std::end(entities), [](const Entity::Ptr &first, const Entity::Ptr &second) {
-        return (first->text().count() > second->text().count());
-    });
-
-    // Use HTML escaped to provide correct formatting for styled Label
-    QString escapedString {input};
-    escapedString.replace(QLatin1String{"&lt;"}, QLatin1String{"<"});
-    escapedString.replace(QLatin1String{"&gt;"}, QLatin1String{">"});
-    escapedString.replace(QLatin1String{"&amp;"}, QLatin1String{"&"});
-    escapedString = escapedString.toHtmlEscaped();
-
-    FormatterVisitor visitor {escapedString, includeLinks};
-    for (const Entity::Ptr &entity : entities) {
-        if (entity) {
-            entity->accept(visitor);
+    QString text {};
+    QCache<QString, FormattedText> &cache (formattedTextCache());
+    const FormattedText *cached {cacheKey.isEmpty() ? nullptr : cache.object(cacheKey)};
+    if (cached != nullptr && cached->input == input) {
+        text = cached->text;
+    } else {
+        text = private_util::formatEntities(input, entities, includeLinks);
+        if (!cacheKey.isEmpty()) {
+            cache.insert(cacheKey, new FormattedText {input, text}, input.size() + text.size());
         }
     }
+    setFormattedText(text);
+}
+
+void EntitiesFormatter::setFormattedText(const QString &text)
+{
+    if (!m_complete) {
+        return;
+    }
 
-    if (m_text != visitor.text()) {
-        m_text = visitor.text();
+    if (m_text != text) {
+        m_text = text;
         emit textChanged();
     }
 }
@@ -36,14 +36,16 @@
 #include <QtQml/QQmlParserStatus>
 #include "entity.h"
 
-class MediaEntity;
-class UrlEntity;
-class UserMentionEntity;
-class HashtagEntity;
-
 namespace qml
 {
 
+/**
+ * @brief Base class for formatters that display a text with entities
+ *
+ * Formatted texts are cached with a key provided by subclasses,
+ * so that delegates that are created again, like when scrolling
+ * back, do not format the same text again.
+ */
 class EntitiesFormatter : public QObject, public QQmlParserStatus
 {
     Q_OBJECT
@@ -58,7 +60,20 @@ signals:
 protected:
     explicit EntitiesFormatter(QObject *parent = 0);
     virtual void format() = 0;
-    void doFormat(const QString &input, Entity::List &&entities, bool includeLinks = true);
+    /**
+     * @brief Format a text and its entities
+     * @param cacheKey key used to cache the formatted text, or an empty string.
+     * @param input text to format.
+     * @param entities entities in the text.
+     * @param includeLinks if entities should be formatted as links.
+     */
+    void doFormat(const QString &cacheKey, const QString &input, const Entity::List &entities,
+                  bool includeLinks = true);
+    /**
+     * @brief Set a text that is already formatted
+     * @param text formatted text.
+     */
+    void setFormattedText(const QString &text);
 private:
     bool m_complete {false};
     QString m_text {};
@@ -45,7 +45,7 @@ QVariant LayoutModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<LayoutObject> &layout = m_items[row];
+    LayoutObject *layout {item(row)};
     switch (role) {
     case NameRole:
         return layout->name();
@@ -60,7 +60,7 @@ QVariant LayoutModel::data(const QModelIndex &index, int role) const
         return layout->unread();
         break;
     case LayoutRole:
-        return QVariant::fromValue(layout.get());
+        return QVariant::fromValue(layout);
         break;
     default:
         return QVariant();
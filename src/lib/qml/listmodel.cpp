@@ -45,13 +45,13 @@ QVariant ListModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<ListObject> &list = m_items[row];
+    ListObject *list {item(row)};
     switch (role) {
     case IdRole:
         return list->id();
         break;
     case ItemRole:
-        return QVariant::fromValue(list.get());
+        return QVariant::fromValue(list);
         break;
     default:
         return QVariant();
@@ -32,21 +32,40 @@
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "globals.h"
 #include "imodel.h"
 #include "irepositorylistener.h"
 #include "qobjectutils.h"
 #include "datarepositoryobjectmap.h"
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
 
 static QLoggingCategory mLogging {"model"};
 
 namespace qml
 {
 
+/**
+ * @brief Base class for models that display a repository
+ *
+ * This model mirrors the items of a repository, and wraps
+ * them in QObjects of type O, to be displayed in QML.
+ *
+ * In lazy mode, only the items are stored, and the QObject
+ * wrapper of an item is created the first time it is needed.
+ * When more than maximumObjectCount() wrappers exist, the
+ * least recently used ones are released, and the views are
+ * notified that their rows changed, so that delegates that
+ * are still displayed get a new wrapper.
+ */
 template<class T, class O>
 class Model: public IModel, public IRepositoryListener<T>
 {
 public:
+    static const int DefaultMaximumObjectCount = 100;
     ~Model()
     {
         if (m_internalRepository != nullptr) {
@@ -123,13 +142,128 @@ protected:
     explicit Model(QObject *parent = 0)
         : IModel(parent) , IRepositoryListener<T>()
     {
+        m_releaseTimer.setSingleShot(true);
+        QObject::connect(&m_releaseTimer, &QTimer::timeout, [this]() {
+            notifyReleasedObjects();
+        });
+    }
+    /**
+     * @brief Item at a given row
+     * @param row row of the item, that should be valid.
+     * @return item at the given row.
+     */
+    const T & itemData(int row) const
+    {
+        return m_items[row].data;
+    }
+    /**
+     * @brief QObject wrapper of the item at a given row
+     *
+     * In lazy mode, the wrapper is created if needed.
+     *
+     * @param row row of the item, that should be valid.
+     * @return QObject wrapper of the item at the given row.
+     */
+    O * item(int row) const
+    {
+        Item &entry (m_items[row]);
+        entry.lastAccess = ++m_accessCount;
+        if (!entry.object) {
+            entry.object.reset(O::create(entry.data, const_cast<Model<T, O> *>(this)));
+            ++m_objectCount;
+            releaseObjects();
+        }
+        return entry.object.get();
+    }
+    bool isLazy() const
+    {
+        return m_lazy;
+    }
+    void setLazy(bool lazy)
+    {
+        m_lazy = lazy;
+    }
+    int maximumObjectCount() const
+    {
+        return m_maximumObjectCount;
+    }
+    void setMaximumObjectCount(int maximumObjectCount)
+    {
+        m_maximumObjectCount = maximumObjectCount;
     }
-    std::deque<QObjectPtr<O>> m_items {};
 private:
+    struct Item
+    {
+        explicit Item(const T &inputData)
+            : data(inputData)
+        {
+        }
+        DISABLE_COPY_DEFAULT_MOVE(Item);
+        T data;
+        QObjectPtr<O> object {nullptr};
+        quint64 lastAccess {0};
+        bool released {false};
+    };
+    Item createItem(const T &data)
+    {
+        Item returned {data};
+        if (!m_lazy) {
+            returned.object.reset(O::create(data, this));
+            ++m_objectCount;
+        }
+        return returned;
+    }
+    void releaseObjects() const
+    {
+        if (!m_lazy || m_objectCount <= m_maximumObjectCount) {
+            return;
+        }
+
+        // Wrappers are released in batches, keeping the
+        // most recently used ones, that are likely to be
+        // displayed
+        std::vector<quint64> accesses {};
+        for (const Item &entry : m_items) {
+            if (entry.object) {
+                accesses.push_back(entry.lastAccess);
+            }
+        }
+        std::size_t keptCount {static_cast<std::size_t>(std::max(m_maximumObjectCount * 3 / 4, 1))};
+        auto threshold = std::end(accesses) - keptCount;
+        std::nth_element(std::begin(accesses), threshold, std::end(accesses));
+        for (Item &entry : m_items) {
+            if (entry.object && entry.lastAccess < *threshold) {
+                entry.object.reset();
+                entry.released = true;
+                --m_objectCount;
+            }
+        }
+        qCDebug(mLogging) << "Released wrappers. Remaining:" << m_objectCount;
+
+        // Wrappers are released while the views are reading the
+        // data, so they are notified later
+        m_releaseTimer.start(0);
+    }
+    void notifyReleasedObjects()
+    {
+        int first {-1};
+        for (int i = 0; i <= rowCount(); ++i) {
+            bool released {i < rowCount() && m_items[i].released && !m_items[i].object};
+            if (i < rowCount()) {
+                m_items[i].released = false;
+            }
+            if (released && first < 0) {
+                first = i;
+            } else if (!released && first >= 0) {
+                emit dataChanged(this->index(first), this->index(i - 1));
+                first = -1;
+            }
+        }
+    }
     void onAppend(const T &item) override
     {
         beginInsertRows(QModelIndex(), rowCount(), rowCount());
-        m_items.emplace_back(O::create(item, this));
+        m_items.emplace_back(createItem(item));
         emit countChanged();
         endInsertRows();
     }
@@ -137,7 +271,7 @@ private:
     {
         beginInsertRows(QModelIndex(), rowCount(), rowCount() + items.size() - 1);
         for (const T &entry : items) {
-            m_items.emplace_back(O::create(entry, this));
+            m_items.emplace_back(createItem(entry));
         }
         emit countChanged();
         endInsertRows();
@@ -147,7 +281,7 @@ private:
         emit prependPre();
         beginInsertRows(QModelIndex(), 0, items.size() - 1);
         for (auto it = items.rbegin(); it != items.rend(); ++it) {
-            m_items.emplace_front(O::create(*it, this));
+            m_items.emplace_front(createItem(*it));
         }
         emit countChanged();
         endInsertRows();
@@ -158,9 +292,28 @@ private:
         if (index < 0 || index >= rowCount()) {
             return;
         }
-        m_items[index]->update(item);
+        Item &entry (m_items[index]);
+        entry.data = item;
+        if (entry.object) {
+            entry.object->update(item);
+        }
         emit dataChanged(this->index(index), this->index(index));
     }
+    void onUpdate(int first, const std::vector<T> &items) override
+    {
+        int last = first + static_cast<int>(items.size()) - 1;
+        if (items.empty() || first < 0 || last >= rowCount()) {
+            return;
+        }
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            Item &entry (m_items[first + i]);
+            entry.data = items[i];
+            if (entry.object) {
+                entry.object->update(items[i]);
+            }
+        }
+        emit dataChanged(this->index(first), this->index(last));
+    }
 
     void onRemove(int index) override
     {
@@ -169,10 +322,30 @@ private:
         }
 
         beginRemoveRows(QModelIndex(), index, index);
+        if (m_items[index].object) {
+            --m_objectCount;
+        }
         m_items.erase(std::begin(m_items) + index);
         emit countChanged();
         endRemoveRows();
     }
+    void onRemove(int first, int count) override
+    {
+        int last = first + count - 1;
+        if (count <= 0 || first < 0 || last >= rowCount()) {
+            return;
+        }
+
+        beginRemoveRows(QModelIndex(), first, last);
+        auto begin = std::begin(m_items) + first;
+        auto end = begin + count;
+        m_objectCount -= std::count_if(begin, end, [](const Item &entry) {
+            return static_cast<bool>(entry.object);
+        });
+        m_items.erase(begin, end);
+        emit countChanged();
+        endRemoveRows();
+    }
     void onMove(int from, int to) override
     {
         if (!m_localMove) {
@@ -203,10 +376,11 @@ private:
         if (!m_complete) {
             return;
         }
-        std::deque<QObjectPtr<O>> newItems;
+        std::deque<Item> newItems;
+        m_objectCount = 0;
         if (m_internalRepository != nullptr) {
             for (const T &item : *m_internalRepository) {
-                newItems.emplace_back(O::create(item, this));
+                newItems.emplace_back(createItem(item));
             }
         }
 
@@ -290,7 +464,7 @@ private:
 
         int toIndex = (to < from) ? to : to - 1;
 
-        QObjectPtr<O> item = std::move(*(std::begin(m_items) + from));
+        Item item = std::move(*(std::begin(m_items) + from));
         m_items.erase(std::begin(m_items) + from);
         m_items.insert(std::begin(m_items) + toIndex, std::move(item));
         endMoveRows();
@@ -305,6 +479,12 @@ private:
     QString m_internalAccountUserId {};
     Query m_internalQuery {};
     Repository<T> *m_internalRepository {nullptr};
+    bool m_lazy {false};
+    int m_maximumObjectCount {DefaultMaximumObjectCount};
+    mutable std::deque<Item> m_items {};
+    mutable int m_objectCount {0};
+    mutable quint64 m_accessCount {0};
+    mutable QTimer m_releaseTimer {};
 };
 
 }
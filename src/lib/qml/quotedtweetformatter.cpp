@@ -60,7 +60,8 @@ void QuotedTweetFormatter::format()
     if (m_tweet == nullptr) {
         return;
     }
-    doFormat(m_tweet->text(), m_tweet->data().entities(), false);
+    const QuotedTweet &data {m_tweet->data()};
+    doFormat(QString(QLatin1String("quoted/%1")).arg(data.id().toString()), m_tweet->text(), data.entities(), false);
 }
 
 }
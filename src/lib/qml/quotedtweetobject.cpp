@@ -37,7 +37,7 @@ namespace qml
 QuotedTweetObject::QuotedTweetObject(const QuotedTweet &data, QObject *parent)
     : QObject(parent), m_data{std::move(data)}
 {
-    m_user = UserObject::create(m_data.user(), this);
+    m_user = UserObject::create(m_data.sharedUser(), this);
     m_media.reset(MediaModel::create(m_data.entities(), this));
 }
 
@@ -48,7 +48,7 @@ QuotedTweetObject * QuotedTweetObject::create(const QuotedTweet &data, QObject *
 
 QString QuotedTweetObject::id() const
 {
-    return m_data.id();
+    return m_data.id().toString();
 }
 
 QString QuotedTweetObject::text() const
@@ -60,7 +60,12 @@ void TweetFormatter::format()
     if (m_tweet == nullptr) {
         return;
     }
-    doFormat(m_tweet->text(), m_tweet->data().entities());
+    const Tweet &data {m_tweet->data()};
+    if (!data.displayText().isNull()) {
+        setFormattedText(data.displayText());
+        return;
+    }
+    doFormat(QString(QLatin1String("tweet/%1")).arg(data.id().toString()), m_tweet->text(), data.entities());
 }
 
 }
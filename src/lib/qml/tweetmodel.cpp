@@ -37,6 +37,8 @@ namespace qml
 TweetModel::TweetModel(QObject *parent) :
     Model<Tweet, TweetObject>(parent)
 {
+    // Tweet wrappers are expensive, and only created for displayed tweets
+    setLazy(true);
 }
 
 QVariant TweetModel::data(const QModelIndex &index, int role) const
@@ -45,13 +47,12 @@ QVariant TweetModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<TweetObject> &tweet = m_items[row];
     switch (role) {
     case IdRole:
-        return tweet->id();
+        return itemData(row).id().toString();
         break;
     case ItemRole:
-        return QVariant::fromValue(tweet.get());
+        return QVariant::fromValue(item(row));
         break;
     default:
         return QVariant();
@@ -31,6 +31,7 @@
 
 #include "tweetobject.h"
 #include <QtCore/QRegularExpression>
+#include "private/entityformatutil.h"
 
 namespace qml
 {
@@ -38,9 +39,9 @@ namespace qml
 TweetObject::TweetObject(const Tweet &data, QObject *parent)
     : QObject(parent), m_data{std::move(data)}
 {
-    m_user.reset(UserObject::create(m_data.user(), this));
+    m_user.reset(UserObject::create(m_data.sharedUser(), this));
     if (m_data.retweetingUser().isValid()) {
-        m_retweetingUser.reset(UserObject::create(m_data.retweetingUser(), this));
+        m_retweetingUser.reset(UserObject::create(m_data.sharedRetweetingUser(), this));
     }
     QRegularExpression urlParser {QLatin1String("<a[^>]*>([^<]*)</a>")};
     QRegularExpressionMatch match {urlParser.match(m_data.source())};
@@ -58,12 +59,12 @@ TweetObject * TweetObject::create(const Tweet &data, QObject *parent)
 
 QString TweetObject::id() const
 {
-    return m_data.id();
+    return m_data.id().toString();
 }
 
 QString TweetObject::originalId() const
 {
-    return m_data.originalId();
+    return m_data.originalId().toString();
 }
 
 QString TweetObject::text() const
@@ -71,6 +72,12 @@ QString TweetObject::text() const
     return m_data.text();
 }
 
+QString TweetObject::plainText() const
+{
+    const QString plainText {m_data.plainText()};
+    return !plainText.isNull() ? plainText : private_util::formatPlainText(m_data.text(), m_data.entities());
+}
+
 UserObject * TweetObject::user() const
 {
     return m_user.get();
@@ -108,7 +115,7 @@ bool TweetObject::isRetweeted() const
 
 QString TweetObject::inReplyTo() const
 {
-    return m_data.inReplyTo();
+    return m_data.inReplyTo().toString();
 }
 
 QString TweetObject::source() const
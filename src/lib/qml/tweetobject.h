@@ -47,6 +47,7 @@ class TweetObject : public QObject
     Q_PROPERTY(QString id READ id CONSTANT)
     Q_PROPERTY(QString originalId READ originalId CONSTANT)
     Q_PROPERTY(QString text READ text CONSTANT)
+    Q_PROPERTY(QString plainText READ plainText CONSTANT)
     Q_PROPERTY(qml::UserObject * user READ user CONSTANT)
     Q_PROPERTY(qml::UserObject * retweetingUser READ retweetingUser CONSTANT)
     Q_PROPERTY(QDateTime timestamp READ timestamp CONSTANT)
@@ -65,6 +66,7 @@ public:
     QString id() const;
     QString originalId() const;
     QString text() const;
+    QString plainText() const;
     UserObject * user() const;
     UserObject * retweetingUser() const;
     QDateTime timestamp() const;
@@ -31,9 +31,13 @@
 
 #include "twitterauthentification.h"
 #include "twitter-secrets.h"
+#include "private/networkstack.h"
+#include "private/queryexecutorfactory.h"
 #include "private/twitterdatautil.h"
+#include "private/twitterqueryutil.h"
 #include "qobjectutils.h"
 #include <QtCore/QLoggingCategory>
+#include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 
 static const QLoggingCategory logger {"twitter-authentification"};
@@ -41,11 +45,11 @@ static const QLoggingCategory logger {"twitter-authentification"};
 namespace qml
 {
 
-static const char *TWITTER_API_REQUEST_TOKEN = "https://api.twitter.com/oauth/request_token";
+static const char *TWITTER_API_REQUEST_TOKEN = "request_token";
 static const char *TWITTER_API_REQUEST_TOKEN_PARAM_KEY = "oauth_callback";
 static const char *TWITTER_API_REQUEST_TOKEN_PARAM_VALUE = "oob";
-static const char *TWITTER_API_AUTHORIZE = "https://api.twitter.com/oauth/authorize";
-static const char *TWITTER_API_ACCESS_TOKEN = "https://api.twitter.com/oauth/access_token";
+static const char *TWITTER_API_AUTHORIZE = "authorize";
+static const char *TWITTER_API_ACCESS_TOKEN = "access_token";
 static const char *TWITTER_API_ACCESS_TOKEN_PARAM_KEY = "oauth_verifier";
 static const char *TWITTER_API_OAUTH_TOKEN_KEY = "oauth_token";
 static const char *TWITTER_API_OAUTH_TOKEN_SECRET_KEY = "oauth_token_secret";
@@ -55,10 +59,20 @@ static const char *TWITTER_API_OAUTH_USER_ID_KEY = "user_id";
 static const char *TWITTER_API_OAUTH_SCREEN_NAME_KEY = "screen_name";
 
 TwitterAuthentification::TwitterAuthentification(QObject *parent)
-    : QObject(parent), m_network{new QNetworkAccessManager()}
+    : QObject(parent), m_networkStack{private_util::NetworkStack::instance()}
+    , m_oauthUrl(private_util::TwitterQueryUtil::oauthUrl(private_util::QueryExecutorFactory::baseUrl()))
 {
 }
 
+TwitterAuthentification::~TwitterAuthentification()
+{
+    for (QNetworkReply *reply : m_replies) {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
 QString TwitterAuthentification::pin() const
 {
     return m_pin;
@@ -95,16 +109,19 @@ QString TwitterAuthentification::screenName() const
 void TwitterAuthentification::startRequest()
 {
     std::vector<std::pair<QByteArray, QByteArray>> args {{TWITTER_API_REQUEST_TOKEN_PARAM_KEY, TWITTER_API_REQUEST_TOKEN_PARAM_VALUE}};
-    QByteArray header {private_util::TwitterDataUtil::authorizationHeader(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET, "POST", TWITTER_API_REQUEST_TOKEN, args)};
+    QByteArray requestTokenUrl {m_oauthUrl + TWITTER_API_REQUEST_TOKEN};
+    QByteArray header {private_util::TwitterDataUtil::authorizationHeader(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET, "POST", requestTokenUrl, args)};
     qCDebug(logger) << "The authentification header for the start request is:" << header;
 
-    QByteArray url {QByteArray(TWITTER_API_REQUEST_TOKEN) + "?" + TWITTER_API_REQUEST_TOKEN_PARAM_KEY + "=" + TWITTER_API_REQUEST_TOKEN_PARAM_VALUE};
+    QByteArray url {requestTokenUrl + "?" + TWITTER_API_REQUEST_TOKEN_PARAM_KEY + "=" + TWITTER_API_REQUEST_TOKEN_PARAM_VALUE};
     QNetworkRequest request {QUrl(QLatin1String(url))};
     request.setRawHeader("Authorization", header);
     request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("application/x-www-form-urlencoded"));
+    private_util::NetworkStack::prepare(request);
 
-    QNetworkReply *reply {m_network->post(request, QByteArray())};
-    connect(reply, &QNetworkReply::finished, [reply, this]() {
+    QNetworkReply *reply {track(m_networkStack->network().post(request, QByteArray()))};
+    connect(reply, &QNetworkReply::finished, this, [reply, this]() {
+        m_replies.erase(reply);
         QObjectPtr<QNetworkReply> replyPtr {reply};
         if (replyPtr->error() != QNetworkReply::NoError) {
             qCDebug(logger) << "Error happened. Code:" << reply->error();
@@ -130,7 +147,7 @@ void TwitterAuthentification::startRequest()
         m_tempTokenSecret = std::move(dataMap.value(TWITTER_API_OAUTH_TOKEN_SECRET_KEY));
 
         // Now we need to continue the PIN based authentification
-        QByteArray url {QByteArray(TWITTER_API_AUTHORIZE) + "?" + TWITTER_API_OAUTH_TOKEN_KEY + "=" + m_tempToken};
+        QByteArray url {m_oauthUrl + TWITTER_API_AUTHORIZE + "?" + TWITTER_API_OAUTH_TOKEN_KEY + "=" + m_tempToken};
         qCDebug(logger) << "Sending url" << url;
         emit sendAuthorize(QUrl(QLatin1String(url)));
     });
@@ -145,15 +162,18 @@ void TwitterAuthentification::continueRequest()
     qCDebug(logger) << "Continuing request with pin:" << m_pin;
 
     std::vector<std::pair<QByteArray, QByteArray>> args {{TWITTER_API_ACCESS_TOKEN_PARAM_KEY, m_pin.toLocal8Bit()}};
-    QByteArray header = private_util::TwitterDataUtil::authorizationHeader(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET, "POST", TWITTER_API_ACCESS_TOKEN, args, m_tempToken, m_tempTokenSecret);
+    QByteArray accessTokenUrl {m_oauthUrl + TWITTER_API_ACCESS_TOKEN};
+    QByteArray header = private_util::TwitterDataUtil::authorizationHeader(TWITTER_CONSUMER_KEY, TWITTER_CONSUMER_SECRET, "POST", accessTokenUrl, args, m_tempToken, m_tempTokenSecret);
     qCDebug(logger) << "The authentification header for the continue request is:" << header;
 
-    QNetworkRequest request (QUrl(QLatin1String(TWITTER_API_ACCESS_TOKEN) + QLatin1String("?") + QLatin1String(TWITTER_API_ACCESS_TOKEN_PARAM_KEY) + QLatin1String("=") + m_pin));
+    QNetworkRequest request (QUrl(QLatin1String(accessTokenUrl) + QLatin1String("?") + QLatin1String(TWITTER_API_ACCESS_TOKEN_PARAM_KEY) + QLatin1String("=") + m_pin));
     request.setRawHeader("Authorization", header);
     request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("application/x-www-form-urlencoded"));
+    private_util::NetworkStack::prepare(request);
 
-    QNetworkReply *reply {m_network->post(request, QByteArray())};
-    connect(reply, &QNetworkReply::finished, [reply, this]() {
+    QNetworkReply *reply {track(m_networkStack->network().post(request, QByteArray()))};
+    connect(reply, &QNetworkReply::finished, this, [reply, this]() {
+        m_replies.erase(reply);
         QObjectPtr<QNetworkReply> replyPtr {reply};
         if (replyPtr->error() != QNetworkReply::NoError) {
             qCWarning(logger) << "Network error. Code:" << replyPtr->error();
@@ -184,6 +204,12 @@ void TwitterAuthentification::continueRequest()
     });
 }
 
+QNetworkReply * TwitterAuthentification::track(QNetworkReply *reply)
+{
+    m_replies.insert(reply);
+    return reply;
+}
+
 void TwitterAuthentification::setData(QString &&token, QString &&tokenSecret,
                                       QString &&userId, QString &&screenName)
 {
@@ -32,11 +32,17 @@
 #ifndef TWITTERAUTHENTIFICATION_H
 #define TWITTERAUTHENTIFICATION_H
 
+#include <memory>
+#include <set>
 #include <QtCore/QObject>
-#include <QtNetwork/QNetworkAccessManager>
 #include "globals.h"
 #include "qobjectutils.h"
 
+class QNetworkReply;
+namespace private_util {
+class NetworkStack;
+}
+
 namespace qml
 {
 
@@ -50,6 +56,7 @@ class TwitterAuthentification : public QObject
     Q_PROPERTY(QString screenName READ screenName NOTIFY nameChanged)
 public:
     explicit TwitterAuthentification(QObject *parent = 0);
+    ~TwitterAuthentification();
     DISABLE_COPY_DISABLE_MOVE(TwitterAuthentification);
     QString pin() const;
     void setPin(const QString &pin);
@@ -71,7 +78,9 @@ signals:
     void done();
 private:
     void setData(QString &&token, QString &&tokenSecret, QString &&userId, QString &&screenName);
-    QObjectPtr<QNetworkAccessManager> m_network {nullptr};
+    QNetworkReply * track(QNetworkReply *reply);
+    std::shared_ptr<private_util::NetworkStack> m_networkStack {};
+    QByteArray m_oauthUrl {};
     QByteArray m_tempToken {};
     QByteArray m_tempTokenSecret {};
     QString m_pin {};
@@ -79,6 +88,8 @@ private:
     QString m_tokenSecret {};
     QString m_userId {};
     QString m_screenName {};
+    // Replies of the shared manager, that are aborted when this object is destroyed
+    std::set<QNetworkReply *> m_replies {};
 };
 
 }
@@ -45,13 +45,13 @@ QVariant UserModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<UserObject> &user = m_items[row];
+    UserObject *user {item(row)};
     switch (role) {
     case IdRole:
         return user->id();
         break;
     case ItemRole:
-        return QVariant::fromValue(user.get());
+        return QVariant::fromValue(user);
         break;
     default:
         return QVariant();
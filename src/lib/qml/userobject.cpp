@@ -37,45 +37,55 @@
 namespace qml
 {
 
-UserObject::UserObject(const User &data, QObject *parent)
-    : QObject(parent), m_data{data}
+UserObject::UserObject(std::shared_ptr<const User> &&data, QObject *parent)
+    : QObject(parent), m_data{std::move(data)}
 {
     initializeUrl();
 }
 
 UserObject * UserObject::create(const User &data, QObject *parent)
 {
-    return new UserObject(data, parent);
+    return new UserObject(std::make_shared<const User>(data), parent);
+}
+
+UserObject * UserObject::create(const User::Ptr &data, QObject *parent)
+{
+    // Users that are shared with the tweets are not copied
+    std::shared_ptr<const User> shared {data};
+    if (!shared) {
+        shared = std::make_shared<const User>();
+    }
+    return new UserObject(std::move(shared), parent);
 }
 
 bool UserObject::isValid() const
 {
-    return m_data.isValid();
+    return m_data->isValid();
 }
 
 QString UserObject::id() const
 {
-    return m_data.id();
+    return m_data->id().toString();
 }
 
 QString UserObject::name() const
 {
-    return m_data.name();
+    return m_data->name();
 }
 
 QString UserObject::screenName() const
 {
-    return m_data.screenName();
+    return m_data->screenName();
 }
 
 QString UserObject::description() const
 {
-    return m_data.description();
+    return m_data->description();
 }
 
 QString UserObject::location() const
 {
-    return m_data.location();
+    return m_data->location();
 }
 
 QString UserObject::displayUrl() const
@@ -90,74 +100,77 @@ QString UserObject::url() const
 
 bool UserObject::isProtected() const
 {
-    return m_data.isProtected();
+    return m_data->isProtected();
 }
 
 bool UserObject::isFollowing() const
 {
-    return m_data.isFollowing();
+    return m_data->isFollowing();
 }
 
 int UserObject::statusesCount() const
 {
-    return m_data.statusesCount();
+    return m_data->statusesCount();
 }
 
 int UserObject::followersCount() const
 {
-    return m_data.followersCount();
+    return m_data->followersCount();
 }
 
 int UserObject::friendsCount() const
 {
-    return m_data.friendsCount();
+    return m_data->friendsCount();
 }
 
 int UserObject::listedCount() const
 {
-    return m_data.listedCount();
+    return m_data->listedCount();
 }
 
 int UserObject::favouritesCount() const
 {
-    return m_data.favouritesCount();
+    return m_data->favouritesCount();
 }
 
 QString UserObject::imageUrl() const
 {
-    return m_data.imageUrl();
+    return m_data->imageUrl();
 }
 
 QString UserObject::imageUrlLarge() const
 {
-    return m_data.imageUrlLarge();
+    return m_data->imageUrlLarge();
 }
 
 QString UserObject::bannerUrl() const
 {
-    return m_data.bannerUrl();
+    return m_data->bannerUrl();
 }
 
 QString UserObject::bannerUrlLarge() const
 {
-    return m_data.bannerUrlLarge();
+    return m_data->bannerUrlLarge();
 }
 
 int UserObject::tweetsPerDay() const
 {
-    qint64 days {m_data.createdAt().daysTo(QDateTime::currentDateTime())};
-    return static_cast<double>(m_data.statusesCount()) / static_cast<double>(days);
+    qint64 days {m_data->createdAt().daysTo(QDateTime::currentDateTime())};
+    return static_cast<double>(m_data->statusesCount()) / static_cast<double>(days);
 }
 
 User UserObject::data() const
 {
-    return m_data;
+    return *m_data;
 }
 
 void UserObject::update(const User &other)
 {
-    if (m_data.isFollowing() != other.isFollowing()) {
-        m_data.setFollowing(other.isFollowing());
+    if (m_data->isFollowing() != other.isFollowing()) {
+        // The data might be shared with tweets, so it is copied before being modified
+        User data {*m_data};
+        data.setFollowing(other.isFollowing());
+        m_data = std::make_shared<const User>(std::move(data));
         emit followingChanged();
     }
 }
@@ -180,15 +193,15 @@ void UserObject::initializeUrl()
         }
     };
 
-    if (m_data.urlEntities().size() != 1) {
+    if (m_data->urlEntities().size() != 1) {
         return;
     }
 
     UrlVisitor visitor {};
-    Entity::Ptr entity {*std::begin(m_data.urlEntities())};
+    Entity::Ptr entity {*std::begin(m_data->urlEntities())};
     entity->accept(visitor);
 
-    if (visitor.text != m_data.url()) {
+    if (visitor.text != m_data->url()) {
         return;
     }
 
@@ -64,6 +64,7 @@ class UserObject : public QObject
 public:
     DISABLE_COPY_DISABLE_MOVE(UserObject);
     static UserObject * create(const User &data, QObject *parent = 0);
+    static UserObject * create(const User::Ptr &data, QObject *parent = 0);
     bool isValid() const;
     QString id() const;
     QString name() const;
@@ -89,9 +90,9 @@ public:
 signals:
     void followingChanged();
 private:
-    explicit UserObject(const User &data, QObject *parent = 0);
+    explicit UserObject(std::shared_ptr<const User> &&data, QObject *parent = 0);
     void initializeUrl();
-    User m_data {};
+    std::shared_ptr<const User> m_data {};
     QString m_displayUrl {};
     QString m_url {};
 };
@@ -30,25 +30,56 @@
  */
 
 #include "quotedtweet.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QJsonObject>
+#include "private/jsonreader.h"
+#include "userstore.h"
 
 QuotedTweet::QuotedTweet(const QJsonObject &json)
 {
-    m_id = std::move(json.value(QLatin1String("id_str")).toString());
+    m_id = TwitterId::fromString(json.value(QLatin1String("id_str")).toString());
     m_text = std::move(json.value(QLatin1String("text")).toString());
-    m_user = std::move(User(json.value(QLatin1String("user")).toObject()));
+    User user {json.value(QLatin1String("user")).toObject()};
+    if (user.isValid()) {
+        m_user = std::make_shared<User>(std::move(user));
+    }
 
     QJsonObject entities {json.value(QLatin1String("entities")).toObject()};
     QJsonObject extendedEntities {json.value(QLatin1String("extended_entities")).toObject()};
     m_entities = Entity::create(entities, extendedEntities);
 }
 
+QuotedTweet::QuotedTweet(private_util::JsonReader &reader)
+{
+    Entity::List entities {};
+    Entity::List extendedEntities {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "id_str") {
+                m_id = TwitterId::fromString(reader.readString());
+            } else if (name == "text") {
+                m_text = reader.readString();
+            } else if (name == "user") {
+                m_user = std::make_shared<User>(reader);
+            } else if (name == "entities") {
+                entities = Entity::create(reader);
+            } else if (name == "extended_entities") {
+                extendedEntities = Entity::createExtended(reader);
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    m_entities = Entity::merge(std::move(entities), std::move(extendedEntities));
+}
+
 bool QuotedTweet::isValid() const
 {
-    return !m_id.isEmpty();
+    return m_id.isValid();
 }
 
-QString QuotedTweet::id() const
+TwitterId QuotedTweet::id() const
 {
     return m_id;
 }
@@ -58,7 +89,12 @@ QString QuotedTweet::text() const
     return m_text;
 }
 
-User QuotedTweet::user() const
+const User & QuotedTweet::user() const
+{
+    return m_user ? *m_user : User::null();
+}
+
+User::Ptr QuotedTweet::sharedUser() const
 {
     return m_user;
 }
@@ -68,4 +104,30 @@ Entity::List QuotedTweet::entities() const
     return m_entities;
 }
 
+void QuotedTweet::internUsers(UserStore &store, bool newer)
+{
+    m_user = store.intern(m_user, newer);
+}
+
+QDataStream & operator<<(QDataStream &stream, const QuotedTweet &quotedTweet)
+{
+    stream << quotedTweet.m_id;
+    stream << quotedTweet.m_text;
+    stream << quotedTweet.user();
+    stream << quotedTweet.m_entities;
+    return stream;
+}
 
+QDataStream & operator>>(QDataStream &stream, QuotedTweet &quotedTweet)
+{
+    User user {};
+    stream >> quotedTweet.m_id;
+    stream >> quotedTweet.m_text;
+    stream >> user;
+    stream >> quotedTweet.m_entities;
+    quotedTweet.m_user.reset();
+    if (user.isValid()) {
+        quotedTweet.m_user = std::make_shared<User>(std::move(user));
+    }
+    return stream;
+}
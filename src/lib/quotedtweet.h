@@ -33,8 +33,10 @@
 #define QUOTEDTWEET_H
 
 #include "globals.h"
+#include "twitterid.h"
 #include "user.h"
 
+class UserStore;
 /**
  * @brief A quoted tweet
  *
@@ -57,6 +59,15 @@ public:
      * @param json JSON object to parse.
      */
     explicit QuotedTweet(const QJsonObject &json);
+    /**
+     * @brief Constructs a quoted tweet from a JSON reader
+     *
+     * This constructor reads the next value of the
+     * JSON reader, like QuotedTweet(const QJsonObject &).
+     *
+     * @param reader JSON reader to read from.
+     */
+    explicit QuotedTweet(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(QuotedTweet);
     /**
      * @brief If the quoted tweet instance is valid
@@ -70,7 +81,7 @@ public:
      * @brief Id of the quoted tweet
      * @return id of the quoted tweet.
      */
-    QString id() const;
+    TwitterId id() const;
     /**
      * @brief Text of the quoted tweet
      * @return text of the quoted tweet.
@@ -80,16 +91,29 @@ public:
      * @brief User who sent the quoted tweet
      * @return user who sent the quoted tweet.
      */
-    User user() const;
+    const User & user() const;
+    /**
+     * @brief Shared instance of user()
+     * @return shared instance of user(), or null.
+     */
+    User::Ptr sharedUser() const;
     /**
      * @brief Entities contained in this tweet
      * @return entities contained in this tweet.
      */
     Entity::List entities() const;
+    /**
+     * @brief Share the user of this quoted tweet through a store
+     * @param store store to intern the user in.
+     * @param newer if the user of this quoted tweet is more recent than the stored one.
+     */
+    void internUsers(UserStore &store, bool newer = true);
+    friend QDataStream & operator<<(QDataStream &stream, const QuotedTweet &quotedTweet);
+    friend QDataStream & operator>>(QDataStream &stream, QuotedTweet &quotedTweet);
 private:
-    QString m_id {};
+    TwitterId m_id {};
     QString m_text {};
-    User m_user {};
+    User::Ptr m_user {};
     Entity::List m_entities;
 };
 
@@ -34,23 +34,53 @@
 
 #include <deque>
 #include <set>
+#include <vector>
 #include <QtCore/QString>
 #include "globals.h"
 #include "irepositorylistener.h"
 
 /**
  * @brief A generic container
+ *
+ * Changes can be grouped in a transaction, see Transaction. Inside
+ * a transaction, updates and removals are not notified immediately,
+ * but are merged into ranges, and sent to the listeners when the
+ * transaction ends.
  */
 template<class T>
 class Repository
 {
 public:
     using List = std::deque<T>;
+    /**
+     * @brief Groups the changes made to a Repository
+     *
+     * The changes are notified when the last living Transaction
+     * is destroyed.
+     */
+    class Transaction
+    {
+    public:
+        explicit Transaction(Repository<T> &repository)
+            : m_repository(repository)
+        {
+            m_repository.beginTransaction();
+        }
+        DISABLE_COPY_DISABLE_MOVE(Transaction);
+        ~Transaction()
+        {
+            m_repository.endTransaction();
+        }
+    private:
+        Repository<T> &m_repository;
+    };
     explicit Repository() {}
     DISABLE_COPY_DEFAULT_MOVE(Repository);
     ~Repository()
     {
-        for (IRepositoryListener<T> *listener : m_listeners) {
+        // Listeners are removed while iterating
+        const std::set<IRepositoryListener<T> *> listeners {m_listeners};
+        for (IRepositoryListener<T> *listener : listeners) {
             listener->onInvalidation();
             removeListener(*listener);
         }
@@ -71,8 +101,58 @@ public:
     {
         return m_data.size();
     }
+    /**
+     * @brief Maximum number of items
+     *
+     * Repositories whose maximum size is 0 are not bounded.
+     *
+     * @return maximum number of items.
+     */
+    int maximumSize() const
+    {
+        return m_maximumSize;
+    }
+    /**
+     * @brief Set the maximum number of items
+     *
+     * Items are not removed when setting the maximum
+     * size, but when calling trimFront() or trimBack().
+     *
+     * @param maximumSize maximum number of items.
+     */
+    void setMaximumSize(int maximumSize)
+    {
+        m_maximumSize = maximumSize > 0 ? maximumSize : 0;
+    }
+    /**
+     * @brief Remove the first items that exceed the maximum size
+     * @return number of removed items.
+     */
+    int trimFront()
+    {
+        int count {excess()};
+        Transaction transaction {*this};
+        for (int i = 0; i < count; ++i) {
+            remove(0);
+        }
+        return count;
+    }
+    /**
+     * @brief Remove the last items that exceed the maximum size
+     * @return number of removed items.
+     */
+    int trimBack()
+    {
+        int count {excess()};
+        Transaction transaction {*this};
+        for (int i = 0; i < count; ++i) {
+            remove(size() - 1);
+        }
+        return count;
+    }
     T & append(T &&data)
     {
+        flush();
         m_data.emplace_back(data);
         for (IRepositoryListener<T> *listener : m_listeners) {
             listener->onAppend(*(std::end(m_data) - 1));
@@ -81,6 +161,7 @@ public:
     }
     void append(const std::vector<T> &data)
     {
+        flush();
         for (const T &entry : data) {
             m_data.emplace_back(entry);
         }
@@ -90,6 +171,7 @@ public:
     }
     void prepend(const std::vector<T> &data)
     {
+        flush();
         for (auto it = data.rbegin(); it != data.rend(); ++it) {
             m_data.emplace_front(*it);
         }
@@ -103,6 +185,11 @@ public:
             return;
         }
         m_data[index] = std::move(data);
+        if (m_transactionCount > 0) {
+            flushRemovals();
+            m_pendingUpdates.insert(index);
+            return;
+        }
         for (IRepositoryListener<T> *listener : m_listeners) {
             listener->onUpdate(index, *(std::begin(m_data) + index));
         }
@@ -112,6 +199,21 @@ public:
         if (index < 0 || static_cast<std::size_t>(index) >= m_data.size()) {
             return;
         }
+        if (m_transactionCount > 0) {
+            flushUpdates();
+            // Removing the item that follows, or the item that precedes
+            // the pending range extends it
+            if (m_pendingRemovalCount > 0 && index != m_pendingRemovalFirst
+                && index != m_pendingRemovalFirst - 1) {
+                flushRemovals();
+            }
+            if (m_pendingRemovalCount == 0 || index < m_pendingRemovalFirst) {
+                m_pendingRemovalFirst = index;
+            }
+            ++m_pendingRemovalCount;
+            m_data.erase(std::begin(m_data) + index);
+            return;
+        }
         m_data.erase(std::begin(m_data) + index);
         for (IRepositoryListener<T> *listener : m_listeners) {
             listener->onRemove(index);
@@ -128,6 +230,7 @@ public:
             return;
         }
 
+        flush();
         int toIndex = (to < from) ? to : to - 1;
 
         T data {*(std::begin(m_data) + from)};
@@ -137,6 +240,32 @@ public:
             listener->onMove(from, to);
         }
     }
+    /**
+     * @brief Start a transaction
+     *
+     * Transactions can be nested. Prefer using Transaction
+     * rather than calling this method directly.
+     */
+    void beginTransaction()
+    {
+        ++m_transactionCount;
+    }
+    /**
+     * @brief End a transaction
+     *
+     * Pending changes are notified when the outermost
+     * transaction ends.
+     */
+    void endTransaction()
+    {
+        if (m_transactionCount == 0) {
+            return;
+        }
+        --m_transactionCount;
+        if (m_transactionCount == 0) {
+            flush();
+        }
+    }
     void start()
     {
         m_status = Loading;
@@ -184,6 +313,47 @@ public:
 protected:
     std::deque<T> m_data {};
 private:
+    void flush()
+    {
+        flushUpdates();
+        flushRemovals();
+    }
+    void flushUpdates()
+    {
+        // Contiguous rows are sent as a single range
+        auto it = std::begin(m_pendingUpdates);
+        while (it != std::end(m_pendingUpdates)) {
+            int first {*it};
+            std::vector<T> items {};
+            int current {first};
+            while (it != std::end(m_pendingUpdates) && *it == current) {
+                items.push_back(*(std::begin(m_data) + current));
+                ++it;
+                ++current;
+            }
+            for (IRepositoryListener<T> *listener : m_listeners) {
+                listener->onUpdate(first, items);
+            }
+        }
+        m_pendingUpdates.clear();
+    }
+    void flushRemovals()
+    {
+        if (m_pendingRemovalCount == 0) {
+            return;
+        }
+        int first {m_pendingRemovalFirst};
+        int count {m_pendingRemovalCount};
+        m_pendingRemovalFirst = 0;
+        m_pendingRemovalCount = 0;
+        for (IRepositoryListener<T> *listener : m_listeners) {
+            listener->onRemove(first, count);
+        }
+    }
+    int excess() const
+    {
+        return m_maximumSize > 0 && size() > m_maximumSize ? size() - m_maximumSize : 0;
+    }
     enum Status {
         Idle,
         Loading,
@@ -192,6 +362,11 @@ private:
     std::set<IRepositoryListener<T> *> m_listeners {};
     Status m_status {Idle};
     QString m_lastError {};
+    int m_maximumSize {0};
+    int m_transactionCount {0};
+    std::set<int> m_pendingUpdates {};
+    int m_pendingRemovalFirst {0};
+    int m_pendingRemovalCount {0};
 };
 
 #endif // REPOSITORY_H
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "timelinecache.h"
+#include <algorithm>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+
+static const QLoggingCategory logger {"timeline-cache"};
+static const quint32 MAGIC {0x54574c43}; // "TWLC"
+static const quint32 VERSION {4};
+
+static QByteArray serializeKey(const ContainerKey &key)
+{
+    QByteArray returned {};
+    QDataStream stream {&returned, QIODevice::WriteOnly};
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    const Query::Parameters &parameters (key.query().parameters());
+    stream << key.account().userId() << static_cast<qint32>(key.query().requestType())
+           << key.query().path() << static_cast<quint32>(parameters.size());
+    for (const auto &parameter : parameters) {
+        stream << parameter.first << parameter.second;
+    }
+    return returned;
+}
+
+TimelineCache::TimelineCache(const QString &dirPath, int maximumCount)
+    : m_dirPath(dirPath), m_maximumCount(maximumCount)
+{
+}
+
+QString TimelineCache::defaultDirPath()
+{
+    QDir dir {QStandardPaths::writableLocation(QStandardPaths::CacheLocation)};
+    return dir.absoluteFilePath(QLatin1String("timelines"));
+}
+
+bool TimelineCache::isValid() const
+{
+    return !m_dirPath.isEmpty();
+}
+
+bool TimelineCache::load(const ContainerKey &key, std::vector<Tweet> &tweets,
+                         IRepositoryQueryHandler<Tweet> &handler) const
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    QFile file {filePath(key)};
+    if (!file.exists()) {
+        return false;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(logger) << "Failed to open cache file" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream {&file};
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic {0};
+    quint32 version {0};
+    stream >> magic >> version;
+    if (magic != MAGIC || version != VERSION) {
+        qCDebug(logger) << "Ignoring cache file with unknown format" << file.fileName();
+        return false;
+    }
+
+    // The key is stored to detect collisions between file names
+    QByteArray storedKey {};
+    stream >> storedKey;
+    if (storedKey != serializeKey(key)) {
+        qCDebug(logger) << "Ignoring cache file of another timeline" << file.fileName();
+        return false;
+    }
+
+    QByteArray state {};
+    quint32 count {0};
+    stream >> state >> count;
+    std::vector<Tweet> returned {};
+    returned.reserve(std::min<quint32>(count, m_maximumCount));
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Tweet tweet {};
+        stream >> tweet;
+        returned.push_back(std::move(tweet));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(logger) << "Failed to read cache file" << file.fileName();
+        return false;
+    }
+
+    QDataStream stateStream {state};
+    stateStream.setVersion(QDataStream::Qt_5_0);
+    handler.restoreState(stateStream, returned);
+    tweets = std::move(returned);
+    qCDebug(logger) << "Loaded" << tweets.size() << "tweets from" << file.fileName();
+    return true;
+}
+
+bool TimelineCache::save(const ContainerKey &key, const TweetRepository &repository,
+                         const IRepositoryQueryHandler<Tweet> &handler) const
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    if (!QDir::root().mkpath(m_dirPath)) {
+        qCWarning(logger) << "Failed to create cache dir" << m_dirPath;
+        return false;
+    }
+
+    QByteArray state {};
+    {
+        QDataStream stateStream {&state, QIODevice::WriteOnly};
+        stateStream.setVersion(QDataStream::Qt_5_0);
+        handler.saveState(stateStream);
+    }
+
+    QSaveFile file {filePath(key)};
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(logger) << "Failed to open cache file" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream {&file};
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 count {static_cast<quint32>(std::min(repository.size(), m_maximumCount))};
+    stream << MAGIC << VERSION << serializeKey(key) << state << count;
+    auto end = std::begin(repository) + count;
+    for (auto it = std::begin(repository); it != end; ++it) {
+        stream << *it;
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qCWarning(logger) << "Failed to write cache file" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+bool TimelineCache::remove(const ContainerKey &key) const
+{
+    if (!isValid()) {
+        return false;
+    }
+    QFile file {filePath(key)};
+    return !file.exists() || file.remove();
+}
+
+QString TimelineCache::filePath(const ContainerKey &key) const
+{
+    const QByteArray &hash {QCryptographicHash::hash(serializeKey(key), QCryptographicHash::Sha1).toHex()};
+    return QDir(m_dirPath).absoluteFilePath(QString::fromLatin1(hash) + QLatin1String(".cache"));
+}
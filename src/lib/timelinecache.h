@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TIMELINECACHE_H
+#define TIMELINECACHE_H
+
+#include <vector>
+#include <QtCore/QString>
+#include "containerkey.h"
+#include "globals.h"
+#include "irepositoryqueryhandler.h"
+#include "tweetrepository.h"
+
+/**
+ * @brief An on-disk cache of timelines
+ *
+ * This class stores the most recent tweets of a
+ * timeline, with the state of its query handler, so
+ * that the timeline can be displayed on startup,
+ * before being refreshed.
+ *
+ * Each timeline is stored in its own file, in a
+ * binary format that is written with QDataStream.
+ *
+ * A cache that is constructed without a directory
+ * is invalid, and does not store anything.
+ */
+class TimelineCache
+{
+public:
+    static const int DefaultMaximumCount = 200;
+    explicit TimelineCache() = default;
+    /**
+     * @brief Constructs a cache in a directory
+     * @param dirPath directory where the timelines are stored.
+     * @param maximumCount maximum number of tweets that are stored per timeline.
+     */
+    explicit TimelineCache(const QString &dirPath, int maximumCount = DefaultMaximumCount);
+    DEFAULT_COPY_DEFAULT_MOVE(TimelineCache);
+    static QString defaultDirPath();
+    bool isValid() const;
+    /**
+     * @brief Load a timeline
+     * @param key key of the timeline.
+     * @param tweets loaded tweets, from the most recent to the oldest.
+     * @param handler handler whose state is restored.
+     * @return if the timeline could be loaded.
+     */
+    bool load(const ContainerKey &key, std::vector<Tweet> &tweets,
+              IRepositoryQueryHandler<Tweet> &handler) const;
+    /**
+     * @brief Save a timeline
+     *
+     * Only the first tweets of the repository, that are
+     * the most recent ones, are saved.
+     *
+     * @param key key of the timeline.
+     * @param repository repository to save.
+     * @param handler handler whose state is saved.
+     * @return if the timeline could be saved.
+     */
+    bool save(const ContainerKey &key, const TweetRepository &repository,
+              const IRepositoryQueryHandler<Tweet> &handler) const;
+    bool remove(const ContainerKey &key) const;
+private:
+    QString filePath(const ContainerKey &key) const;
+    QString m_dirPath {};
+    int m_maximumCount {DefaultMaximumCount};
+};
+
+#endif // TIMELINECACHE_H
@@ -30,11 +30,17 @@
  */
 
 #include "tweet.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QJsonObject>
+#include "private/entityformatutil.h"
+#include "private/jsonreader.h"
 #include "private/timeutil.h"
+#include "userstore.h"
 
 Tweet::Tweet(const QJsonObject &json)
 {
+    Data &data (detach());
+
     // Use the retweeted status when possible
     QJsonObject tweet {json};
     QJsonObject retweetedTweet {json.value(QLatin1String("retweeted_status")).toObject()};
@@ -43,109 +49,279 @@ Tweet::Tweet(const QJsonObject &json)
         displayedTweet = retweetedTweet;
 
         // Adding the retweeting user when retweeting
-        m_retweetingUser = std::move(User(tweet.value(QLatin1String("user")).toObject()));
+        data.retweetingUser = std::make_shared<User>(tweet.value(QLatin1String("user")).toObject());
     }
 
-    m_id = std::move(tweet.value(QLatin1String("id_str")).toString());
-    m_originalId = std::move(displayedTweet.value(QLatin1String("id_str")).toString());
-    m_text = std::move(displayedTweet.value(QLatin1String("text")).toString());
-    m_favoriteCount = displayedTweet.value(QLatin1String("favorite_count")).toInt();
-    m_favorited = displayedTweet.value(QLatin1String("favorited")).toBool();
-    m_retweetCount = displayedTweet.value(QLatin1String("retweet_count")).toInt();
-    m_retweeted = displayedTweet.value(QLatin1String("retweeted")).toBool();
-    m_inReplyTo = std::move(displayedTweet.value(QLatin1String("in_reply_to_status_id")).toString());
-    m_source = std::move(tweet.value(QLatin1String("source")).toString());
-    m_timestamp = std::move(private_util::fromUtc(displayedTweet.value(QLatin1String("created_at")).toString()));
-    m_user = std::move(User(displayedTweet.value(QLatin1String("user")).toObject()));
+    data.id = TwitterId::fromString(tweet.value(QLatin1String("id_str")).toString());
+    data.originalId = TwitterId::fromString(displayedTweet.value(QLatin1String("id_str")).toString());
+    data.text = std::move(displayedTweet.value(QLatin1String("text")).toString());
+    data.favoriteCount = displayedTweet.value(QLatin1String("favorite_count")).toInt();
+    data.favorited = displayedTweet.value(QLatin1String("favorited")).toBool();
+    data.retweetCount = displayedTweet.value(QLatin1String("retweet_count")).toInt();
+    data.retweeted = displayedTweet.value(QLatin1String("retweeted")).toBool();
+    data.inReplyTo = TwitterId::fromString(displayedTweet.value(QLatin1String("in_reply_to_status_id_str")).toString());
+    data.source = std::move(tweet.value(QLatin1String("source")).toString());
+    data.timestamp = private_util::parseTimestamp(displayedTweet.value(QLatin1String("created_at")).toString());
+    data.user = std::make_shared<User>(displayedTweet.value(QLatin1String("user")).toObject());
 
     QJsonObject entities {displayedTweet.value(QLatin1String("entities")).toObject()};
     QJsonObject extendedEntities {displayedTweet.value(QLatin1String("extended_entities")).toObject()};
-    m_entities = Entity::create(entities, extendedEntities);
-    m_quotedStatus = std::move(QuotedTweet(displayedTweet.value(QLatin1String("quoted_status")).toObject()));
+    data.entities = Entity::create(entities, extendedEntities);
+    data.quotedStatus = std::move(QuotedTweet(displayedTweet.value(QLatin1String("quoted_status")).toObject()));
+}
+
+Tweet::Tweet(private_util::JsonReader &reader)
+{
+    Data &data (detach());
+    Tweet retweetedTweet {};
+    QString createdAt {};
+    Entity::List entities {};
+    Entity::List extendedEntities {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "id_str") {
+                data.id = TwitterId::fromString(reader.readString());
+            } else if (name == "text") {
+                data.text = reader.readString();
+            } else if (name == "favorite_count") {
+                data.favoriteCount = reader.readInt();
+            } else if (name == "favorited") {
+                data.favorited = reader.readBool();
+            } else if (name == "retweet_count") {
+                data.retweetCount = reader.readInt();
+            } else if (name == "retweeted") {
+                data.retweeted = reader.readBool();
+            } else if (name == "in_reply_to_status_id_str") {
+                data.inReplyTo = TwitterId::fromString(reader.readString());
+            } else if (name == "source") {
+                data.source = reader.readString();
+            } else if (name == "created_at") {
+                createdAt = reader.readString();
+            } else if (name == "user") {
+                data.user = std::make_shared<User>(reader);
+            } else if (name == "entities") {
+                entities = Entity::create(reader);
+            } else if (name == "extended_entities") {
+                extendedEntities = Entity::createExtended(reader);
+            } else if (name == "quoted_status") {
+                data.quotedStatus = std::move(QuotedTweet(reader));
+            } else if (name == "retweeted_status") {
+                retweetedTweet = std::move(Tweet(reader));
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    data.originalId = data.id;
+    data.timestamp = private_util::parseTimestamp(createdAt);
+    data.entities = Entity::merge(std::move(entities), std::move(extendedEntities));
+
+    // Use the retweeted status when possible
+    if (retweetedTweet.isValid()) {
+        Data &retweetedData (retweetedTweet.detach());
+
+        // Adding the retweeting user when retweeting
+        data.retweetingUser = std::move(data.user);
+
+        data.originalId = retweetedData.originalId;
+        data.text = std::move(retweetedData.text);
+        data.favoriteCount = retweetedData.favoriteCount;
+        data.favorited = retweetedData.favorited;
+        data.retweetCount = retweetedData.retweetCount;
+        data.retweeted = retweetedData.retweeted;
+        data.inReplyTo = retweetedData.inReplyTo;
+        data.timestamp = retweetedData.timestamp;
+        data.user = std::move(retweetedData.user);
+        data.entities = std::move(retweetedData.entities);
+        data.quotedStatus = std::move(retweetedData.quotedStatus);
+    }
 }
 
 bool Tweet::isValid() const
 {
-    return !m_id.isEmpty();
+    return m_data->id.isValid();
 }
 
-QString Tweet::id() const
+TwitterId Tweet::id() const
 {
-    return m_id;
+    return m_data->id;
 }
 
-QString Tweet::originalId() const
+TwitterId Tweet::originalId() const
 {
-    return m_originalId;
+    return m_data->originalId;
 }
 
 QString Tweet::text() const
 {
-    return m_text;
+    return m_data->text;
 }
 
-User Tweet::user() const
+const User & Tweet::user() const
 {
-    return m_user;
+    return m_data->user ? *m_data->user : User::null();
 }
 
-User Tweet::retweetingUser() const
+const User & Tweet::retweetingUser() const
 {
-    return m_retweetingUser;
+    return m_data->retweetingUser ? *m_data->retweetingUser : User::null();
+}
+
+User::Ptr Tweet::sharedUser() const
+{
+    return m_data->user;
+}
+
+User::Ptr Tweet::sharedRetweetingUser() const
+{
+    return m_data->retweetingUser;
 }
 
 QDateTime Tweet::timestamp() const
 {
-    return m_timestamp;
+    return private_util::toLocalTime(m_data->timestamp);
 }
 
 int Tweet::favoriteCount() const
 {
-    return m_favoriteCount;
+    return m_data->favoriteCount;
 }
 
 bool Tweet::isFavorited() const
 {
-    return m_favorited;
+    return m_data->favorited;
 }
 
 void Tweet::setFavorited(bool favorited)
 {
-    m_favorited = favorited;
+    detach().favorited = favorited;
 }
 
 int Tweet::retweetCount() const
 {
-    return m_retweetCount;
+    return m_data->retweetCount;
 }
 
 bool Tweet::isRetweeted() const
 {
-    return m_retweeted;
+    return m_data->retweeted;
 }
 
 void Tweet::setRetweeted(bool retweeted)
 {
-    m_retweeted = retweeted;
+    detach().retweeted = retweeted;
 }
 
-QString Tweet::inReplyTo() const
+TwitterId Tweet::inReplyTo() const
 {
-    return m_inReplyTo;
+    return m_data->inReplyTo;
 }
 
 QString Tweet::source() const
 {
-    return m_source;
+    return m_data->source;
 }
 
 Entity::List Tweet::entities() const
 {
-    return m_entities;
+    return m_data->entities;
 }
 
 QuotedTweet Tweet::quotedStatus() const
 {
-    return m_quotedStatus;
+    return m_data->quotedStatus;
+}
+
+QString Tweet::displayText() const
+{
+    return m_data->displayText;
+}
+
+QString Tweet::plainText() const
+{
+    return m_data->plainText;
 }
 
+void Tweet::prepareDisplayText()
+{
+    Data &data (detach());
+    data.displayText = private_util::formatEntities(data.text, data.entities, true);
+    data.plainText = private_util::formatPlainText(data.text, data.entities);
+}
+
+void Tweet::internUsers(UserStore &store, bool newer)
+{
+    Data &data (detach());
+    data.user = store.intern(data.user, newer);
+    data.retweetingUser = store.intern(data.retweetingUser, newer);
+    data.quotedStatus.internUsers(store, newer);
+}
+
+bool Tweet::isSharedWith(const Tweet &other) const
+{
+    return m_data == other.m_data;
+}
+
+const std::shared_ptr<Tweet::Data> & Tweet::emptyData()
+{
+    static const std::shared_ptr<Data> data {std::make_shared<Data>()};
+    return data;
+}
+
+Tweet::Data & Tweet::detach()
+{
+    // Copy the data if it is shared, including
+    // with default constructed tweets
+    if (m_data.use_count() > 1) {
+        m_data = std::make_shared<Data>(*m_data);
+    }
+    return *m_data;
+}
+
+QDataStream & operator<<(QDataStream &stream, const Tweet &tweet)
+{
+    const Tweet::Data &data (*tweet.m_data);
+    stream << data.id;
+    stream << data.originalId;
+    stream << data.text;
+    stream << tweet.user();
+    stream << tweet.retweetingUser();
+    stream << data.timestamp;
+    stream << data.favoriteCount;
+    stream << data.favorited;
+    stream << data.retweetCount;
+    stream << data.retweeted;
+    stream << data.inReplyTo;
+    stream << data.source;
+    stream << data.entities;
+    stream << data.quotedStatus;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, Tweet &tweet)
+{
+    Tweet::Data &data (tweet.detach());
+    User user {};
+    User retweetingUser {};
+    stream >> data.id;
+    stream >> data.originalId;
+    stream >> data.text;
+    stream >> user;
+    stream >> retweetingUser;
+    stream >> data.timestamp;
+    stream >> data.favoriteCount;
+    stream >> data.favorited;
+    stream >> data.retweetCount;
+    stream >> data.retweeted;
+    stream >> data.inReplyTo;
+    stream >> data.source;
+    stream >> data.entities;
+    stream >> data.quotedStatus;
+    data.user = std::make_shared<User>(std::move(user));
+    data.retweetingUser.reset();
+    if (retweetingUser.isValid()) {
+        data.retweetingUser = std::make_shared<User>(std::move(retweetingUser));
+    }
+    return stream;
+}
@@ -32,14 +32,21 @@
 #ifndef TWEET_H
 #define TWEET_H
 
-#include "user.h"
 #include "quotedtweet.h"
+#include "twitterid.h"
+#include "user.h"
 
+class UserStore;
 /**
  * @brief A tweet
  *
  * This class represents an tweet from Twitter API.
  *
+ * Tweet is implicitly shared: copies of a tweet share
+ * the same data, that is only copied when one of the copies
+ * is modified, so that timelines can hold the same tweet
+ * without duplicating it.
+ *
  * See https://dev.twitter.com/overview/api/tweets.
  */
 class Tweet
@@ -62,6 +69,16 @@ public:
      * @param json JSON object to parse.
      */
     explicit Tweet(const QJsonObject &json);
+    /**
+     * @brief Constructs a tweet from a JSON reader
+     *
+     * This constructor reads the next value of the
+     * JSON reader, and performs the same adaptations
+     * than Tweet(const QJsonObject &).
+     *
+     * @param reader JSON reader to read from.
+     */
+    explicit Tweet(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(Tweet);
     /**
      * @brief If the tweet instance is valid
@@ -75,7 +92,7 @@ public:
      * @brief Id of the tweet
      * @return id of the tweet.
      */
-    QString id() const;
+    TwitterId id() const;
     /**
      * @brief Id of the retweet
      *
@@ -84,11 +101,11 @@ public:
      * if there is any retweet.
      *
      * If there is no retweet, this method will
-     * return a null QString().
+     * return the id of the tweet.
      *
      * @return id of the retweet.
      */
-    QString originalId() const;
+    TwitterId originalId() const;
     /**
      * @brief Text of the tweet
      * @return text of the tweet.
@@ -106,7 +123,7 @@ public:
      *
      * @return user who sent the tweet.
      */
-    User user() const;
+    const User & user() const;
     /**
      * @brief User who sent the tweet, or retweet
      *
@@ -119,7 +136,17 @@ public:
      *
      * @return user who sent the tweet or retweet.
      */
-    User retweetingUser() const;
+    const User & retweetingUser() const;
+    /**
+     * @brief Shared instance of user()
+     * @return shared instance of user(), or null.
+     */
+    User::Ptr sharedUser() const;
+    /**
+     * @brief Shared instance of retweetingUser()
+     * @return shared instance of retweetingUser(), or null.
+     */
+    User::Ptr sharedRetweetingUser() const;
     /**
      * @brief When the tweet has been sent
      * @return when the tweet has been sent.
@@ -159,7 +186,7 @@ public:
      * @brief Id of the tweet that this tweet replies to
      * @return id of the tweet that this tweet replies to.
      */
-    QString inReplyTo() const;
+    TwitterId inReplyTo() const;
     /**
      * @brief What that was used to post this tweet
      * @return what that was used to post this tweet.
@@ -175,21 +202,74 @@ public:
      * @return quoted status in this tweet.
      */
     QuotedTweet quotedStatus() const;
+    /**
+     * @brief Text of the tweet, formatted as rich text
+     *
+     * This text is only available after calling
+     * prepareDisplayText().
+     *
+     * @return text of the tweet, formatted as rich text, or a null string.
+     */
+    QString displayText() const;
+    /**
+     * @brief Text of the tweet, formatted as plain text
+     *
+     * This text is only available after calling
+     * prepareDisplayText().
+     *
+     * @return text of the tweet, formatted as plain text, or a null string.
+     */
+    QString plainText() const;
+    /**
+     * @brief Format the text of the tweet for display
+     *
+     * This method is called when decoding timelines, so that
+     * the formatting is done on the decoding thread, and not
+     * when displaying the tweet. Formatted texts are not cached.
+     */
+    void prepareDisplayText();
+    /**
+     * @brief Share the users of this tweet through a store
+     *
+     * The users of this tweet, and of its quoted status, are
+     * replaced by the instances that are held in the store.
+     *
+     * @param store store to intern the users in.
+     * @param newer if the users of this tweet are more recent than the stored ones.
+     */
+    void internUsers(UserStore &store, bool newer = true);
+    /**
+     * @brief If this tweet shares its data with another tweet
+     * @param other tweet to compare to.
+     * @return if this tweet shares its data with the other tweet.
+     */
+    bool isSharedWith(const Tweet &other) const;
+    friend QDataStream & operator<<(QDataStream &stream, const Tweet &tweet);
+    friend QDataStream & operator>>(QDataStream &stream, Tweet &tweet);
 private:
-    QString m_id {};
-    QString m_originalId {};
-    QString m_text {};
-    User m_user {};
-    User m_retweetingUser {};
-    QDateTime m_timestamp {};
-    int m_favoriteCount {};
-    bool m_favorited {};
-    int m_retweetCount {};
-    bool m_retweeted {};
-    QString m_inReplyTo {};
-    QString m_source {};
-    Entity::List m_entities {};
-    QuotedTweet m_quotedStatus {};
+    friend class TweetStore;
+    struct Data
+    {
+        TwitterId id {};
+        TwitterId originalId {};
+        QString text {};
+        User::Ptr user {};
+        User::Ptr retweetingUser {};
+        qint64 timestamp {-1}; // UTC, in milliseconds since epoch
+        int favoriteCount {};
+        bool favorited {};
+        int retweetCount {};
+        bool retweeted {};
+        TwitterId inReplyTo {};
+        QString source {};
+        Entity::List entities {};
+        QuotedTweet quotedStatus {};
+        QString displayText {};
+        QString plainText {};
+    };
+    static const std::shared_ptr<Data> & emptyData();
+    Data & detach();
+    std::shared_ptr<Data> m_data {emptyData()};
 };
 
 #endif // TWEET_H
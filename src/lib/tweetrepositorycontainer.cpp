@@ -31,21 +31,95 @@
 
 #include "tweetrepositorycontainer.h"
 #include "private/debughelper.h"
+#include "private/replydecoder.h"
+#include "private/repositoryindex.h"
 #include "private/repositoryquerycallback.h"
 #include "private/twitterqueryutil.h"
 #include "repositoryqueryhandlerfactory.h"
+#include <algorithm>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
 #include <QtNetwork/QNetworkReply>
 
 static const QLoggingCategory logger {"tweet-repository-container"};
 
-TweetRepositoryContainer::TweetRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor)
+TweetRepositoryContainer::TweetRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor,
+                                                   QThreadPool *threadPool)
     : m_queryExecutor(std::move(queryExecutor))
+    , m_decoder(new private_util::ReplyDecoder(threadPool))
+    , m_saveTimer(new QTimer())
 {
     Q_ASSERT_X(m_queryExecutor, "TweetRepositoryContainer", "NULL query executor");
+    // Writing the cache is slow, so the timelines
+    // that are refreshed often are saved once
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(CacheSaveDelay);
+    QObject::connect(m_saveTimer.get(), &QTimer::timeout, [this]() {
+        saveCache();
+    });
+}
+
+TweetRepositoryContainer::~TweetRepositoryContainer()
+{
+    // Handlers that are still decoding a reply cannot be saved
+    for (const auto &it : m_mapping) {
+        if (!it.second.loading) {
+            m_cache.save(it.first, it.second.repository, *it.second.handler);
+        }
+    }
+}
+
+void TweetRepositoryContainer::setCache(TimelineCache &&cache)
+{
+    m_cache = std::move(cache);
+}
+
+void TweetRepositoryContainer::setMaximumSize(int maximumSize)
+{
+    m_maximumSize = maximumSize;
+    for (auto &it : m_mapping) {
+        it.second.repository.setMaximumSize(m_maximumSize);
+    }
+}
+
+void TweetRepositoryContainer::setMaximumConcurrentLoads(int maximumConcurrentLoads)
+{
+    m_maximumConcurrentLoads = maximumConcurrentLoads;
+    processRefreshQueue();
+}
+
+void TweetRepositoryContainer::setRefreshPriority(const Account &account, const Query &query,
+                                                  RefreshPriority priority)
+{
+    auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
+    if (it != std::end(m_mapping)) {
+        it->second.priority = priority;
+    }
+}
+
+void TweetRepositoryContainer::setStreamed(const Account &account, const Query &query, bool streamed)
+{
+    auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
+    if (it != std::end(m_mapping)) {
+        it->second.streamed = streamed;
+    }
+}
+
+void TweetRepositoryContainer::ingest(const Account &account, const Query &query,
+                                      const std::vector<Tweet> &tweets)
+{
+    auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
+    if (it == std::end(m_mapping) || tweets.empty()) {
+        return;
+    }
+    std::vector<Tweet> &pendingTweets (it->second.pendingTweets);
+    pendingTweets.insert(std::end(pendingTweets), std::begin(tweets), std::end(tweets));
+    if (!it->second.loading) {
+        insertPendingTweets(it->first, it->second);
+    }
 }
 
 TweetRepository * TweetRepositoryContainer::repository(const Account &account, const Query &query)
@@ -80,6 +154,8 @@ void TweetRepositoryContainer::dereferenceQuery(const Account &account, const Qu
     }
     --data->refcount;
     if (data->refcount == 0) {
+        m_unsavedTimelines.erase(ContainerKey{Account{account}, Query{query}});
+        m_cache.remove(ContainerKey{Account{account}, Query{query}});
         m_mapping.erase(ContainerKey{Account{account}, Query{query}});
     }
 
@@ -103,8 +179,9 @@ std::set<Query> TweetRepositoryContainer::referencedQueries(const Account &accou
 void TweetRepositoryContainer::refresh()
 {
     for (auto it = std::begin(m_mapping); it != std::end(m_mapping); ++it) {
-        load(it->first, it->second, IRepositoryQueryHandler<Tweet>::Refresh);
+        queue(it->first, it->second);
     }
+    processRefreshQueue();
 }
 
 void TweetRepositoryContainer::refresh(const Account &account, const Query &query)
@@ -119,6 +196,19 @@ void TweetRepositoryContainer::refresh(const Account &account, const Query &quer
     }
 }
 
+void TweetRepositoryContainer::queueRefresh(const Account &account, const Query &query)
+{
+    auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
+    if (it != std::end(m_mapping)) {
+        queue(it->first, it->second);
+        processRefreshQueue();
+    } else {
+        qCWarning(logger) << "queueRefresh: cannot perform load";
+        qCWarning(logger) << "  Account:" << account.userId();
+        qCWarning(logger) << "  Query:" << query;
+    }
+}
+
 void TweetRepositoryContainer::loadMore(const Account &account, const Query &query)
 {
     auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
@@ -131,31 +221,27 @@ void TweetRepositoryContainer::loadMore(const Account &account, const Query &que
     }
 }
 
-Tweet TweetRepositoryContainer::tweet(const QString &id) const
+Tweet TweetRepositoryContainer::tweet(const TwitterId &id) const
 {
-    auto it = m_data.find(id);
-    if (it != std::end(m_data)) {
-        return it->second;
-    }
-    return Tweet();
+    return m_tweetStore.tweet(id);
 }
 
-void TweetRepositoryContainer::updateTweet(const Tweet &tweet)
+void TweetRepositoryContainer::updateTweet(const Tweet &inputTweet)
 {
-    auto it = m_data.find(tweet.id());
-    if (it != std::end(m_data)) {
-        it->second = tweet;
-    }
+    Tweet tweet {inputTweet};
+    tweet.internUsers(m_userStore);
+    m_tweetStore.insert(tweet);
+    propagateTweets({tweet});
+}
 
-    for (auto it = std::begin(m_mapping); it != std::end(m_mapping); ++it) {
-        TweetRepository &repository = it->second.repository;
-        for (int i = 0; i < repository.size(); ++i) {
-            const Tweet &currentTweet {*(std::begin(repository) + i)};
-            if (currentTweet.id() == tweet.id()) {
-                repository.update(i, std::move(Tweet(tweet)));
-            }
-        }
+UserStore::MemoryUsage TweetRepositoryContainer::userMemoryUsage(const Account &account,
+                                                                 const Query &query) const
+{
+    auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
+    if (it == std::end(m_mapping)) {
+        return UserStore::MemoryUsage();
     }
+    return UserStore::memoryUsage(it->second.repository);
 }
 
 void TweetRepositoryContainer::load(const ContainerKey &key, Data &mappingData,
@@ -182,21 +268,66 @@ void TweetRepositoryContainer::load(const ContainerKey &key, Data &mappingData,
 
     qCDebug(logger) << "Request:" << path << parameters;
     mappingData.repository.start();
+    mappingData.deferred = m_queryExecutor->isDeferred(key.query().requestType(), path, parameters, key.account());
 
-    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, &mappingData, requestType](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
-        std::vector<Tweet> items {};
-        private_util::RepositoryQueryCallback<Tweet> callback {
-            requestType,
-            *mappingData.handler,
-            mappingData.repository,
-            items,
-            mappingData.loading
-        };
-        callback(reply, error, errorMessage);
-        for (const Tweet &tweet : items) {
-            m_data.emplace(tweet.id(), tweet);
-            qCDebug(logger) << "Adding tweet with id" << tweet.id();
+    private_util::RepositoryQueryCallback<Tweet>::Ptr callback {
+        std::make_shared<private_util::RepositoryQueryCallback<Tweet>>(requestType, mappingData.handler)
+    };
+    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, key, callback](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
+        Data *mappingData {getLoadingMappingData(key, callback->handler())};
+        if (mappingData == nullptr) {
+            processRefreshQueue();
+            return;
+        }
+        if (callback->treatError(mappingData->repository, reply, error, errorMessage)) {
+            mappingData->loading = false;
+            mappingData->deferred = false;
+            insertPendingTweets(key, *mappingData);
+            processRefreshQueue();
+            return;
         }
+
+        // Decoding is done in the thread pool, while the result
+        // is placed in the repository in the current thread.
+        // The reply stays compressed until it is decoded.
+        QByteArray data {reply.readAll()};
+        m_decoder->decode([callback, data]() {
+            callback->decode(data);
+        }, [this, key, callback]() {
+            Data *mappingData {getLoadingMappingData(key, callback->handler())};
+            if (mappingData == nullptr) {
+                processRefreshQueue();
+                return;
+            }
+            mappingData->loading = false;
+            mappingData->deferred = false;
+            // Tweets that are already displayed in other timelines
+            // are replaced by the new version, and share its data
+            std::vector<Tweet> updatedTweets {};
+            for (Tweet &tweet : callback->items()) {
+                tweet.internUsers(m_userStore);
+                if (m_tweetStore.insert(tweet)) {
+                    updatedTweets.push_back(tweet);
+                }
+            }
+            if (!callback->apply(mappingData->repository)) {
+                insertPendingTweets(key, *mappingData);
+                processRefreshQueue();
+                return;
+            }
+            propagateTweets(updatedTweets);
+            insertPendingTweets(key, *mappingData);
+
+            const UserStore::MemoryUsage &usage (UserStore::memoryUsage(mappingData->repository));
+            qCDebug(logger) << "User memory for" << key << ":" << usage.users << "users for"
+                            << usage.references << "references," << usage.sharedSize
+                            << "bytes instead of" << usage.unsharedSize << "bytes";
+            m_unsavedTimelines.insert(key);
+            if (!m_saveTimer->isActive()) {
+                m_saveTimer->start();
+            }
+            processRefreshQueue();
+        });
     });
 }
 
@@ -215,7 +346,172 @@ TweetRepositoryContainer::Data * TweetRepositoryContainer::getMappingData(const
     if (!handler) {
         return nullptr;
     }
-    return &(m_mapping.emplace(key, Data{std::move(handler)}).first->second);
+    Data &mappingData (m_mapping.emplace(key, Data{std::move(handler)}).first->second);
+    // The index listens to the repository, that must not move anymore
+    mappingData.index.reset(new private_util::RepositoryIndex<Tweet>(mappingData.repository));
+    mappingData.repository.setMaximumSize(m_maximumSize);
+    loadCache(key, mappingData);
+    return &mappingData;
+}
+
+void TweetRepositoryContainer::loadCache(const ContainerKey &key, Data &mappingData)
+{
+    std::vector<Tweet> tweets {};
+    if (!m_cache.load(key, tweets, *mappingData.handler) || tweets.empty()) {
+        return;
+    }
+
+    qCDebug(logger) << "Loaded" << tweets.size() << "tweets from cache for" << key;
+    for (Tweet &tweet : tweets) {
+        // Cached tweets and users are older than the ones that are already known
+        Tweet storedTweet {m_tweetStore.tweet(tweet.id())};
+        if (storedTweet.isValid()) {
+            tweet = std::move(storedTweet);
+        } else {
+            tweet.internUsers(m_userStore, false);
+            m_tweetStore.insert(tweet);
+        }
+    }
+    mappingData.repository.prepend(tweets);
+}
+
+TweetRepositoryContainer::Data * TweetRepositoryContainer::getLoadingMappingData(const ContainerKey &key,
+                                                                                 const IRepositoryQueryHandler<Tweet>::SharedPtr &handler)
+{
+    // The query might have been removed, or even added again, while loading
+    auto it = m_mapping.find(key);
+    if (it == std::end(m_mapping) || it->second.handler != handler) {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
+void TweetRepositoryContainer::propagateTweets(const std::vector<Tweet> &tweets)
+{
+    if (tweets.empty()) {
+        return;
+    }
+
+    // Only the rows that contain the tweets are touched, and
+    // listeners are notified once per range of updated rows
+    for (auto it = std::begin(m_mapping); it != std::end(m_mapping); ++it) {
+        TweetRepository &repository = it->second.repository;
+        TweetRepository::Transaction transaction {repository};
+        for (const Tweet &tweet : tweets) {
+            for (int i : it->second.index->indexes(tweet.id())) {
+                const Tweet &currentTweet {*(std::begin(repository) + i)};
+                if (!currentTweet.isSharedWith(tweet)) {
+                    repository.update(i, std::move(Tweet(tweet)));
+                }
+            }
+        }
+    }
+}
+
+void TweetRepositoryContainer::insertPendingTweets(const ContainerKey &key, Data &mappingData)
+{
+    std::vector<Tweet> tweets {};
+    std::swap(tweets, mappingData.pendingTweets);
+
+    // Streams send the oldest tweets first, while timelines start
+    // with the newest ones. Tweets that are not newer than the
+    // timeline were already loaded, or are too late to be inserted.
+    std::sort(std::begin(tweets), std::end(tweets), [](const Tweet &first, const Tweet &second) {
+        return second.id() < first.id();
+    });
+    TweetRepository &repository (mappingData.repository);
+    if (!repository.empty()) {
+        const TwitterId &firstId {std::begin(repository)->id()};
+        tweets.erase(std::find_if(std::begin(tweets), std::end(tweets), [&firstId](const Tweet &tweet) {
+            return !(firstId < tweet.id());
+        }), std::end(tweets));
+    }
+    tweets.erase(std::unique(std::begin(tweets), std::end(tweets), [](const Tweet &first, const Tweet &second) {
+        return first.id() == second.id();
+    }), std::end(tweets));
+    if (tweets.empty()) {
+        return;
+    }
+
+    std::vector<Tweet> updatedTweets {};
+    for (Tweet &tweet : tweets) {
+        tweet.internUsers(m_userStore);
+        if (m_tweetStore.insert(tweet)) {
+            updatedTweets.push_back(tweet);
+        }
+    }
+    qCDebug(logger) << "Inserting" << tweets.size() << "streamed tweets in" << key;
+    repository.prepend(tweets);
+    repository.trimBack();
+    // The next refresh loads the tweets that are newer than the streamed ones
+    mappingData.handler->synchronize(repository);
+    propagateTweets(updatedTweets);
+}
+
+void TweetRepositoryContainer::queue(const ContainerKey &key, Data &mappingData)
+{
+    // Streamed timelines are already up to date
+    if (!mappingData.queued && !mappingData.streamed) {
+        mappingData.queued = true;
+        m_refreshQueue.push_back(key);
+    }
+}
+
+void TweetRepositoryContainer::saveCache()
+{
+    // Timelines that are loading again are saved after this load
+    for (const ContainerKey &key : m_unsavedTimelines) {
+        auto it = m_mapping.find(key);
+        if (it != std::end(m_mapping) && !it->second.loading) {
+            m_cache.save(key, it->second.repository, *it->second.handler);
+        }
+    }
+    m_unsavedTimelines.clear();
+}
+
+void TweetRepositoryContainer::processRefreshQueue()
+{
+    while (!m_refreshQueue.empty()) {
+        if (m_maximumConcurrentLoads > 0) {
+            int loading {0};
+            for (const auto &it : m_mapping) {
+                if (it.second.loading && !it.second.deferred) {
+                    ++loading;
+                }
+            }
+            if (loading >= m_maximumConcurrentLoads) {
+                return;
+            }
+        }
+
+        // The query might have been removed, or even added again, while queued
+        for (auto it = std::begin(m_refreshQueue); it != std::end(m_refreshQueue);) {
+            auto mappingIt = m_mapping.find(*it);
+            if (mappingIt == std::end(m_mapping) || !mappingIt->second.queued) {
+                it = m_refreshQueue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (m_refreshQueue.empty()) {
+            return;
+        }
+
+        // Priorities can change while timelines are queued, and
+        // timelines with the same priority are loaded in order
+        auto next = std::begin(m_refreshQueue);
+        for (auto it = std::begin(m_refreshQueue); it != std::end(m_refreshQueue); ++it) {
+            if (m_mapping.find(*it)->second.priority > m_mapping.find(*next)->second.priority) {
+                next = it;
+            }
+        }
+
+        ContainerKey key {*next};
+        m_refreshQueue.erase(next);
+        auto it = m_mapping.find(key);
+        it->second.queued = false;
+        load(it->first, it->second, IRepositoryQueryHandler<Tweet>::Refresh);
+    }
 }
 
 TweetRepositoryContainer::Data::Data(IRepositoryQueryHandler<Tweet>::Ptr &&inputHandler)
@@ -32,7 +32,10 @@
 #ifndef TWEETREPOSITORYCONTAINER_H
 #define TWEETREPOSITORYCONTAINER_H
 
+#include <deque>
 #include <map>
+#include <memory>
+#include <set>
 #include "account.h"
 #include "containerkey.h"
 #include "globals.h"
@@ -40,35 +43,177 @@
 #include "tweetrepository.h"
 #include "irepositoryqueryhandler.h"
 #include "iqueryexecutor.h"
+#include "timelinecache.h"
+#include "tweetstore.h"
+#include "userstore.h"
+
+class QThreadPool;
+class QTimer;
+namespace private_util {
+class ReplyDecoder;
+template<class T> class RepositoryIndex;
+}
 
 class TweetRepositoryContainer
 {
 public:
-    explicit TweetRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor);
+    static const int DefaultMaximumSize = 1000;
+    static const int DefaultMaximumConcurrentLoads = 4;
+    static const int CacheSaveDelay = 30000;
+    /**
+     * @brief Priority of a timeline when refreshing all timelines
+     */
+    enum RefreshPriority
+    {
+        Background,
+        Unread,
+        Visible
+    };
+    explicit TweetRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor,
+                                      QThreadPool *threadPool = nullptr);
+    ~TweetRepositoryContainer();
     DISABLE_COPY_DEFAULT_MOVE(TweetRepositoryContainer);
+    /**
+     * @brief Set the cache used to store timelines
+     *
+     * Timelines are loaded from the cache when they are
+     * referenced. They are saved at most once every
+     * CacheSaveDelay ms after they are loaded, and when
+     * the container is destroyed.
+     *
+     * @param cache cache used to store timelines.
+     */
+    void setCache(TimelineCache &&cache);
+    /**
+     * @brief Set the maximum number of tweets per timeline
+     *
+     * When a timeline grows beyond this size, the tweets
+     * that are the furthest from the loaded ones are removed,
+     * and loaded again when refreshing or loading more.
+     *
+     * @param maximumSize maximum number of tweets per timeline, or 0 for no limit.
+     */
+    void setMaximumSize(int maximumSize);
+    /**
+     * @brief Set the maximum number of timelines loading at the same time
+     *
+     * refresh() queues the timelines, and starts loading them
+     * by priority, see setRefreshPriority(), when less than this
+     * number of timelines are loading. Timelines whose query is
+     * held back by the query executor until its rate limit is reset,
+     * see IQueryExecutor::isDeferred(), are not counted.
+     *
+     * @param maximumConcurrentLoads maximum number of loading timelines, or 0 for no limit.
+     */
+    void setMaximumConcurrentLoads(int maximumConcurrentLoads);
+    /**
+     * @brief Set the priority of a timeline when refreshing all timelines
+     *
+     * Visible timelines are refreshed first, then the timelines
+     * with unread tweets, and then the other ones. Timelines have
+     * the Background priority by default.
+     *
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @param priority priority of the timeline.
+     */
+    void setRefreshPriority(const Account &account, const Query &query, RefreshPriority priority);
+    /**
+     * @brief Set if a timeline receives its tweets from a stream
+     *
+     * Streamed timelines are not loaded by refresh(), but can
+     * still be refreshed on their own. Their tweets are inserted
+     * with ingest().
+     *
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @param streamed if the timeline is streamed.
+     */
+    void setStreamed(const Account &account, const Query &query, bool streamed);
+    /**
+     * @brief Insert the tweets received from a stream in a timeline
+     *
+     * Only the tweets that are newer than the timeline are inserted,
+     * so that tweets that were already loaded are not duplicated.
+     * Tweets received while the timeline is loading are inserted
+     * when the loading is finished.
+     *
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @param tweets tweets to insert.
+     */
+    void ingest(const Account &account, const Query &query, const std::vector<Tweet> &tweets);
     TweetRepository * repository(const Account &account, const Query &query);
     void referenceQuery(const Account &account, const Query &query);
     void dereferenceQuery(const Account &account, const Query &query);
     std::set<Query> referencedQueries(const Account &account) const;
     void refresh();
     void refresh(const Account &account, const Query &query);
+    /**
+     * @brief Queue a timeline to be refreshed
+     *
+     * Unlike refresh(const Account &, const Query &), the timeline
+     * is loaded like when refreshing all timelines, by priority and
+     * within the maximum number of concurrent loads. Streamed
+     * timelines are not queued.
+     *
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     */
+    void queueRefresh(const Account &account, const Query &query);
     void loadMore(const Account &account, const Query &query);
-    Tweet tweet(const QString &id) const;
+    Tweet tweet(const TwitterId &id) const;
     void updateTweet(const Tweet &tweet);
+    /**
+     * @brief Memory used by the users of a timeline
+     *
+     * This method can be used to check how much memory
+     * is saved by sharing users between tweets.
+     *
+     * @param account account of the timeline.
+     * @param query query of the timeline.
+     * @return memory used by the users of the timeline.
+     */
+    UserStore::MemoryUsage userMemoryUsage(const Account &account, const Query &query) const;
 private:
     struct Data
     {
         explicit Data(IRepositoryQueryHandler<Tweet>::Ptr &&inputHandler);
         bool loading {false};
+        // The query waits for a rate limit window to be reset
+        bool deferred {false};
+        bool queued {false};
+        bool streamed {false};
+        RefreshPriority priority {Background};
         TweetRepository repository {};
         int refcount {0};
-        IRepositoryQueryHandler<Tweet>::Ptr handler {};
+        IRepositoryQueryHandler<Tweet>::SharedPtr handler {};
+        std::unique_ptr<private_util::RepositoryIndex<Tweet>> index {};
+        // Tweets received from a stream while loading
+        std::vector<Tweet> pendingTweets {};
     };
     void load(const ContainerKey &key, Data &mappingData,
               IRepositoryQueryHandler<Tweet>::RequestType requestType);
     Data * getMappingData(const ContainerKey &key);
+    void loadCache(const ContainerKey &key, Data &mappingData);
+    Data * getLoadingMappingData(const ContainerKey &key,
+                                 const IRepositoryQueryHandler<Tweet>::SharedPtr &handler);
+    void propagateTweets(const std::vector<Tweet> &tweets);
+    void insertPendingTweets(const ContainerKey &key, Data &mappingData);
+    void queue(const ContainerKey &key, Data &mappingData);
+    void processRefreshQueue();
+    void saveCache();
     IQueryExecutor::ConstPtr m_queryExecutor {nullptr};
-    std::map<QString, Tweet> m_data {};
+    std::unique_ptr<private_util::ReplyDecoder> m_decoder {};
+    TimelineCache m_cache {};
+    // Timelines that are loaded, and saved when the timer expires
+    std::set<ContainerKey> m_unsavedTimelines {};
+    std::unique_ptr<QTimer> m_saveTimer {};
+    UserStore m_userStore {};
+    int m_maximumSize {DefaultMaximumSize};
+    int m_maximumConcurrentLoads {DefaultMaximumConcurrentLoads};
+    std::deque<ContainerKey> m_refreshQueue {};
+    TweetStore m_tweetStore {};
     std::map<ContainerKey, Data> m_mapping {};
 };
 
@@ -30,9 +30,11 @@
  */
 
 #include "tweetrepositoryqueryhandler.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
-#include <QtCore/QUrl>
+#include "private/jsonreader.h"
 #include "private/repositoryqueryhandlerutil.h"
 
 TweetRepositoryQueryHandler::TweetRepositoryQueryHandler()
@@ -50,13 +52,13 @@ Query::Parameters TweetRepositoryQueryHandler::additionalParameters(RequestType
 
     switch (requestType) {
     case Refresh:
-        if (!m_sinceId.isEmpty()) {
-            returned.emplace("since_id", QUrl::toPercentEncoding(m_sinceId));
+        if (m_sinceId.isValid()) {
+            returned.emplace("since_id", QByteArray::number(m_sinceId.value()));
         }
         break;
     case LoadMore:
-        if (!m_maxId.isEmpty()) {
-            returned.emplace("max_id", QUrl::toPercentEncoding(m_maxId));
+        if (m_maxId.isValid()) {
+            returned.emplace("max_id", QByteArray::number(m_maxId.value()));
         }
         break;
     default:
@@ -65,12 +67,13 @@ Query::Parameters TweetRepositoryQueryHandler::additionalParameters(RequestType
     return returned;
 }
 
-bool TweetRepositoryQueryHandler::treatReply(RequestType requestType, const QByteArray &data,
+bool TweetRepositoryQueryHandler::treatReply(RequestType requestType, QIODevice &reply,
                                        std::vector<Tweet> &items, QString &errorMessage,
                                        Placement &placement)
 {
+#ifdef USE_DOM_PARSER
     QJsonParseError error {-1, QJsonParseError::NoError};
-    QJsonDocument document {QJsonDocument::fromJson(data, &error)};
+    QJsonDocument document {QJsonDocument::fromJson(reply.readAll(), &error)};
     if (error.error != QJsonParseError::NoError) {
         errorMessage = error.errorString();
         placement = Discard;
@@ -79,4 +82,24 @@ bool TweetRepositoryQueryHandler::treatReply(RequestType requestType, const QByt
 
     return private_util::treatTweetReply(requestType, document.array(), items, placement,
                                          m_sinceId, m_maxId);
+#else
+    private_util::JsonReader reader {reply};
+    return private_util::treatTweetReply(requestType, reader, items, errorMessage, placement,
+                                         m_sinceId, m_maxId);
+#endif
+}
+
+void TweetRepositoryQueryHandler::saveState(QDataStream &stream) const
+{
+    private_util::saveTweetState(stream, m_sinceId, m_maxId);
+}
+
+void TweetRepositoryQueryHandler::restoreState(QDataStream &stream, const std::vector<Tweet> &items)
+{
+    private_util::restoreTweetState(stream, items, m_sinceId, m_maxId);
+}
+
+void TweetRepositoryQueryHandler::synchronize(const Repository<Tweet> &repository)
+{
+    private_util::synchronizeTweetState(repository, m_sinceId, m_maxId);
 }
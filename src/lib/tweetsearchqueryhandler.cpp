@@ -30,8 +30,10 @@
  */
 
 #include "tweetsearchqueryhandler.h"
+#include "private/jsonreader.h"
 #include "private/repositoryqueryhandlerutil.h"
-#include <QtCore/QUrl>
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 
@@ -50,13 +52,13 @@ Query::Parameters TweetSearchQueryHandler::additionalParameters(RequestType requ
 
     switch (requestType) {
     case Refresh:
-        if (!m_sinceId.isEmpty()) {
-            returned.emplace("since_id", QUrl::toPercentEncoding(m_sinceId));
+        if (m_sinceId.isValid()) {
+            returned.emplace("since_id", QByteArray::number(m_sinceId.value()));
         }
         break;
     case LoadMore:
-        if (!m_maxId.isEmpty()) {
-            returned.emplace("max_id", QUrl::toPercentEncoding(m_maxId));
+        if (m_maxId.isValid()) {
+            returned.emplace("max_id", QByteArray::number(m_maxId.value()));
         }
         break;
     default:
@@ -65,12 +67,13 @@ Query::Parameters TweetSearchQueryHandler::additionalParameters(RequestType requ
     return returned;
 }
 
-bool TweetSearchQueryHandler::treatReply(RequestType requestType, const QByteArray &data,
+bool TweetSearchQueryHandler::treatReply(RequestType requestType, QIODevice &reply,
                                        std::vector<Tweet> &items, QString &errorMessage,
                                        Placement &placement)
 {
+#ifdef USE_DOM_PARSER
     QJsonParseError error {-1, QJsonParseError::NoError};
-    QJsonDocument document {QJsonDocument::fromJson(data, &error)};
+    QJsonDocument document {QJsonDocument::fromJson(reply.readAll(), &error)};
     if (error.error != QJsonParseError::NoError) {
         errorMessage = error.errorString();
         placement = Discard;
@@ -81,4 +84,39 @@ bool TweetSearchQueryHandler::treatReply(RequestType requestType, const QByteArr
     const QJsonArray tweets (root.value(QLatin1String("statuses")).toArray());
     return private_util::treatTweetReply(requestType, tweets, items, placement,
                                          m_sinceId, m_maxId);
+#else
+    // Only statuses are used, the rest of the reply is not read
+    private_util::JsonReader reader {reply};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            if (reader.name() == "statuses") {
+                return private_util::treatTweetReply(requestType, reader, items, errorMessage,
+                                                     placement, m_sinceId, m_maxId);
+            }
+            reader.skipValue();
+        }
+    }
+
+    if (reader.hasError()) {
+        errorMessage = reader.errorString();
+        placement = Discard;
+        return false;
+    }
+    return true;
+#endif
+}
+
+void TweetSearchQueryHandler::saveState(QDataStream &stream) const
+{
+    private_util::saveTweetState(stream, m_sinceId, m_maxId);
+}
+
+void TweetSearchQueryHandler::restoreState(QDataStream &stream, const std::vector<Tweet> &items)
+{
+    private_util::restoreTweetState(stream, items, m_sinceId, m_maxId);
+}
+
+void TweetSearchQueryHandler::synchronize(const Repository<Tweet> &repository)
+{
+    private_util::synchronizeTweetState(repository, m_sinceId, m_maxId);
 }
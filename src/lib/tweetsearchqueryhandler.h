@@ -43,11 +43,14 @@ public:
 private:
     TweetSearchQueryHandler();
     Query::Parameters additionalParameters(RequestType requestType) const override;
-    bool treatReply(RequestType requestType, const QByteArray &data,
+    bool treatReply(RequestType requestType, QIODevice &reply,
                     std::vector<Tweet> &items, QString &errorMessage,
                     Placement &placement) override;
-    QString m_sinceId {};
-    QString m_maxId {};
+    void saveState(QDataStream &stream) const override;
+    void restoreState(QDataStream &stream, const std::vector<Tweet> &items) override;
+    void synchronize(const Repository<Tweet> &repository) override;
+    TwitterId m_sinceId {};
+    TwitterId m_maxId {};
 };
 
 #endif // TWEETSEARCHQUERYHANDLER_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "tweetstore.h"
+
+Tweet TweetStore::tweet(const TwitterId &id) const
+{
+    Tweet returned {};
+    auto it = m_tweets.find(id);
+    if (it != std::end(m_tweets)) {
+        std::shared_ptr<Tweet::Data> data {it->second.lock()};
+        if (data) {
+            returned.m_data = std::move(data);
+        }
+    }
+    return returned;
+}
+
+bool TweetStore::insert(const Tweet &tweet)
+{
+    if (!tweet.isValid()) {
+        return false;
+    }
+
+    auto it = m_tweets.find(tweet.id());
+    if (it != std::end(m_tweets)) {
+        std::shared_ptr<Tweet::Data> data {it->second.lock()};
+        it->second = tweet.m_data;
+        return data && data != tweet.m_data;
+    }
+
+    m_tweets.emplace(tweet.id(), tweet.m_data);
+    if (m_tweets.size() > 2 * m_pruneSize) {
+        prune();
+    }
+    return false;
+}
+
+int TweetStore::count() const
+{
+    int returned {0};
+    for (const auto &it : m_tweets) {
+        if (!it.second.expired()) {
+            ++returned;
+        }
+    }
+    return returned;
+}
+
+void TweetStore::prune()
+{
+    // Expired entries are removed when the store doubled in size,
+    // so that the cost of pruning is amortized over the insertions
+    for (auto it = std::begin(m_tweets); it != std::end(m_tweets);) {
+        if (it->second.expired()) {
+            it = m_tweets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_pruneSize = m_tweets.size();
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TWEETSTORE_H
+#define TWEETSTORE_H
+
+#include <map>
+#include <memory>
+#include "globals.h"
+#include "tweet.h"
+
+/**
+ * @brief A store of tweets, keyed by id
+ *
+ * This class references the tweets that are displayed
+ * in the timelines. As Tweet is implicitly shared, the
+ * timelines that contain the same tweet share the same
+ * data, and memory grows with the number of unique tweets.
+ *
+ * The store does not own the tweets: the data of a tweet
+ * is reference counted, and a tweet is evicted when the last
+ * timeline, or object, that holds it drops it.
+ *
+ * This class is not thread-safe, and should be used
+ * in the thread of the repositories.
+ */
+class TweetStore
+{
+public:
+    explicit TweetStore() = default;
+    DISABLE_COPY_DEFAULT_MOVE(TweetStore);
+    /**
+     * @brief Get a tweet
+     * @param id id of the tweet.
+     * @return the stored tweet, or an invalid tweet if there is none.
+     */
+    Tweet tweet(const TwitterId &id) const;
+    /**
+     * @brief Insert a tweet
+     *
+     * The inserted tweet replaces the stored one, if any.
+     *
+     * @param tweet tweet to insert.
+     * @return if another version of the tweet was stored.
+     */
+    bool insert(const Tweet &tweet);
+    /**
+     * @brief Number of tweets in the store
+     * @return number of tweets in the store.
+     */
+    int count() const;
+private:
+    void prune();
+    std::map<TwitterId, std::weak_ptr<Tweet::Data>> m_tweets {};
+    std::size_t m_pruneSize {0};
+};
+
+#endif // TWEETSTORE_H
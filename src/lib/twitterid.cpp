@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "twitterid.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QHash>
+
+TwitterId::TwitterId(quint64 value)
+    : m_value(value)
+{
+}
+
+TwitterId TwitterId::fromString(const QString &id)
+{
+    // Only canonical numbers are accepted, so that a valid id is written as
+    // one string. toULongLong() would also accept "01", "+1" or " 1".
+    if (id.isEmpty() || id.at(0) == QLatin1Char('0')) {
+        return TwitterId();
+    }
+    for (const QChar &character : id) {
+        if (character < QLatin1Char('0') || character > QLatin1Char('9')) {
+            return TwitterId();
+        }
+    }
+    bool ok {false};
+    quint64 value {id.toULongLong(&ok)};
+    return ok ? TwitterId(value) : TwitterId();
+}
+
+bool TwitterId::isValid() const
+{
+    return m_value != 0;
+}
+
+quint64 TwitterId::value() const
+{
+    return m_value;
+}
+
+QString TwitterId::toString() const
+{
+    return isValid() ? QString::number(m_value) : QString();
+}
+
+TwitterId TwitterId::previous() const
+{
+    return isValid() ? TwitterId(m_value - 1) : TwitterId();
+}
+
+bool TwitterId::operator==(const TwitterId &other) const
+{
+    return m_value == other.m_value;
+}
+
+bool TwitterId::operator!=(const TwitterId &other) const
+{
+    return m_value != other.m_value;
+}
+
+bool TwitterId::operator<(const TwitterId &other) const
+{
+    return m_value < other.m_value;
+}
+
+uint qHash(const TwitterId &id, uint seed)
+{
+    return qHash(id.value(), seed);
+}
+
+QDataStream & operator<<(QDataStream &stream, const TwitterId &id)
+{
+    stream << id.value();
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, TwitterId &id)
+{
+    quint64 value {0};
+    stream >> value;
+    id = TwitterId(value);
+    return stream;
+}
+
+QDebug operator<<(QDebug debug, const TwitterId &id)
+{
+    debug << id.value();
+    return debug;
+}
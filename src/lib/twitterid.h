@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef TWITTERID_H
+#define TWITTERID_H
+
+#include <QtCore/QString>
+#include "globals.h"
+
+class QDataStream;
+class QDebug;
+
+/**
+ * @brief Id of a Twitter object
+ *
+ * Tweets and users are identified by unsigned 64-bit
+ * integers. This class stores them as numbers, so that they
+ * are compact, and cheap to compare and to hash.
+ *
+ * Strings are only produced by toString(), when ids are
+ * displayed or sent to Twitter.
+ *
+ * An id of 0 is invalid.
+ */
+class TwitterId
+{
+public:
+    explicit TwitterId() = default;
+    explicit TwitterId(quint64 value);
+    DEFAULT_COPY_DEFAULT_MOVE(TwitterId);
+    /**
+     * @brief Parse an id
+     * @param id id, written in base 10, without sign, spaces or leading zeros.
+     * @return parsed id, or an invalid id if the input is not such a number.
+     */
+    static TwitterId fromString(const QString &id);
+    bool isValid() const;
+    quint64 value() const;
+    /**
+     * @brief Id as a string
+     * @return id written in base 10, or a null QString() if the id is invalid.
+     */
+    QString toString() const;
+    /**
+     * @brief Previous id
+     *
+     * This id is used as a max_id cursor, that
+     * excludes the current id.
+     *
+     * @return previous id, or an invalid id if there is none.
+     */
+    TwitterId previous() const;
+    bool operator==(const TwitterId &other) const;
+    bool operator!=(const TwitterId &other) const;
+    bool operator<(const TwitterId &other) const;
+private:
+    quint64 m_value {0};
+};
+
+uint qHash(const TwitterId &id, uint seed = 0);
+QDataStream & operator<<(QDataStream &stream, const TwitterId &id);
+QDataStream & operator>>(QDataStream &stream, TwitterId &id);
+QDebug operator<<(QDebug debug, const TwitterId &id);
+
+#endif // TWITTERID_H
@@ -30,16 +30,40 @@
  */
 
 #include "urlentity.h"
+#include <QtCore/QDataStream>
 #include "entityvisitor.h"
+#include "private/jsonreader.h"
 
 UrlEntity::UrlEntity(const QJsonObject &json)
 {
+    readIndices(json);
     m_text = std::move(json.value(QLatin1String("url")).toString());
     m_displayUrl = std::move(json.value(QLatin1String("display_url")).toString());
     m_expandedUrl = std::move(json.value(QLatin1String("expanded_url")).toString());
 }
 
 
+UrlEntity::UrlEntity(private_util::JsonReader &reader)
+{
+    if (!reader.beginObject()) {
+        return;
+    }
+    while (reader.nextName()) {
+        const QByteArray &name (reader.name());
+        if (name == "url") {
+            m_text = reader.readString();
+        } else if (name == "display_url") {
+            m_displayUrl = reader.readString();
+        } else if (name == "expanded_url") {
+            m_expandedUrl = reader.readString();
+        } else if (name == "indices") {
+            readIndices(reader);
+        } else {
+            reader.skipValue();
+        }
+    }
+}
+
 bool UrlEntity::isValid() const
 {
     return !m_text.isEmpty() && !m_displayUrl.isEmpty() && !m_expandedUrl.isEmpty();
@@ -64,3 +88,19 @@ void UrlEntity::accept(EntityVisitor &visitor) const
 {
     visitor.visitUrl(*this);
 }
+
+QDataStream & operator<<(QDataStream &stream, const UrlEntity &entity)
+{
+    stream << entity.m_text;
+    stream << entity.m_displayUrl;
+    stream << entity.m_expandedUrl;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, UrlEntity &entity)
+{
+    stream >> entity.m_text;
+    stream >> entity.m_displayUrl;
+    stream >> entity.m_expandedUrl;
+    return stream;
+}
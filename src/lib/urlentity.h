@@ -40,12 +40,15 @@ class UrlEntity: public Entity
 public:
     explicit UrlEntity() = default;
     explicit UrlEntity(const QJsonObject &json);
+    explicit UrlEntity(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(UrlEntity);
     bool isValid() const override;
     QString text() const override;
     QString displayUrl() const;
     QString expandedUrl() const;
     void accept(EntityVisitor &visitor) const override;
+    friend QDataStream & operator<<(QDataStream &stream, const UrlEntity &entity);
+    friend QDataStream & operator>>(QDataStream &stream, UrlEntity &entity);
 private:
     QString m_text {};
     QString m_displayUrl {};
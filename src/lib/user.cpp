@@ -30,12 +30,14 @@
  */
 
 #include "user.h"
+#include <QtCore/QDataStream>
 #include <QtCore/QJsonObject>
+#include "private/jsonreader.h"
 #include "private/timeutil.h"
 
 User::User(const QJsonObject &json)
 {
-    m_id = std::move(json.value(QLatin1String("id_str")).toString());
+    m_id = TwitterId::fromString(json.value(QLatin1String("id_str")).toString());
     m_name = std::move(json.value(QLatin1String("name")).toString());
     m_screenName = std::move(json.value(QLatin1String("screen_name")).toString());
     m_description = std::move(json.value(QLatin1String("description")).toString());
@@ -50,19 +52,90 @@ User::User(const QJsonObject &json)
     m_favouritesCount = json.value(QLatin1String("favourites_count")).toInt();
     m_imageUrl = std::move(json.value(QLatin1String("profile_image_url_https")).toString());
     m_bannerUrl = std::move(json.value(QLatin1String("profile_banner_url")).toString());
-    m_createdAt = std::move(private_util::fromUtc(json.value(QLatin1String("created_at")).toString()));
+    m_createdAt = private_util::parseTimestamp(json.value(QLatin1String("created_at")).toString());
 
     const QJsonObject &entities (json.value(QLatin1String("entities")).toObject());
     m_descriptionEntities = Entity::create(entities.value(QLatin1String("description")).toObject());
     m_urlEntities = Entity::create(entities.value(QLatin1String("url")).toObject());
 }
 
+User::User(private_util::JsonReader &reader)
+{
+    QString createdAt {};
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "id_str") {
+                m_id = TwitterId::fromString(reader.readString());
+            } else if (name == "name") {
+                m_name = reader.readString();
+            } else if (name == "screen_name") {
+                m_screenName = reader.readString();
+            } else if (name == "description") {
+                m_description = reader.readString();
+            } else if (name == "location") {
+                m_location = reader.readString();
+            } else if (name == "url") {
+                m_url = reader.readString();
+            } else if (name == "protected") {
+                m_protected = reader.readBool();
+            } else if (name == "following") {
+                m_following = reader.readBool();
+            } else if (name == "statuses_count") {
+                m_statusesCount = reader.readInt();
+            } else if (name == "followers_count") {
+                m_followersCount = reader.readInt();
+            } else if (name == "friends_count") {
+                m_friendsCount = reader.readInt();
+            } else if (name == "listed_count") {
+                m_listedCount = reader.readInt();
+            } else if (name == "favourites_count") {
+                m_favouritesCount = reader.readInt();
+            } else if (name == "profile_image_url_https") {
+                m_imageUrl = reader.readString();
+            } else if (name == "profile_banner_url") {
+                m_bannerUrl = reader.readString();
+            } else if (name == "created_at") {
+                createdAt = reader.readString();
+            } else if (name == "entities") {
+                readEntities(reader);
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    m_createdAt = private_util::parseTimestamp(createdAt);
+}
+
+void User::readEntities(private_util::JsonReader &reader)
+{
+    if (!reader.beginObject()) {
+        return;
+    }
+    while (reader.nextName()) {
+        const QByteArray &name (reader.name());
+        if (name == "description") {
+            m_descriptionEntities = Entity::create(reader);
+        } else if (name == "url") {
+            m_urlEntities = Entity::create(reader);
+        } else {
+            reader.skipValue();
+        }
+    }
+}
+
+const User & User::null()
+{
+    static const User user {};
+    return user;
+}
+
 bool User::isValid() const
 {
-    return !m_id.isEmpty();
+    return m_id.isValid();
 }
 
-QString User::id() const
+TwitterId User::id() const
 {
     return m_id;
 }
@@ -174,5 +247,51 @@ QString User::bannerUrlLarge() const
 
 QDateTime User::createdAt() const
 {
-    return m_createdAt;
+    return private_util::toLocalTime(m_createdAt);
+}
+
+QDataStream & operator<<(QDataStream &stream, const User &user)
+{
+    stream << user.m_id;
+    stream << user.m_name;
+    stream << user.m_screenName;
+    stream << user.m_description;
+    stream << user.m_descriptionEntities;
+    stream << user.m_location;
+    stream << user.m_url;
+    stream << user.m_urlEntities;
+    stream << user.m_protected;
+    stream << user.m_following;
+    stream << user.m_statusesCount;
+    stream << user.m_followersCount;
+    stream << user.m_friendsCount;
+    stream << user.m_listedCount;
+    stream << user.m_favouritesCount;
+    stream << user.m_imageUrl;
+    stream << user.m_bannerUrl;
+    stream << user.m_createdAt;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, User &user)
+{
+    stream >> user.m_id;
+    stream >> user.m_name;
+    stream >> user.m_screenName;
+    stream >> user.m_description;
+    stream >> user.m_descriptionEntities;
+    stream >> user.m_location;
+    stream >> user.m_url;
+    stream >> user.m_urlEntities;
+    stream >> user.m_protected;
+    stream >> user.m_following;
+    stream >> user.m_statusesCount;
+    stream >> user.m_followersCount;
+    stream >> user.m_friendsCount;
+    stream >> user.m_listedCount;
+    stream >> user.m_favouritesCount;
+    stream >> user.m_imageUrl;
+    stream >> user.m_bannerUrl;
+    stream >> user.m_createdAt;
+    return stream;
 }
@@ -36,6 +36,7 @@
 #include <QtCore/QString>
 #include "globals.h"
 #include "entity.h"
+#include "twitterid.h"
 
 class QJsonObject;
 /**
@@ -48,6 +49,7 @@ class QJsonObject;
 class User
 {
 public:
+    using Ptr = std::shared_ptr<User>;
     explicit User() = default;
     /**
      * @brief Constructs a User from a JSON object
@@ -58,7 +60,25 @@ public:
      * @param json JSON object to parse.
      */
     explicit User(const QJsonObject &json);
+    /**
+     * @brief Constructs a User from a JSON reader
+     *
+     * This constructor reads the next value of the
+     * JSON reader, like User(const QJsonObject &).
+     *
+     * @param reader JSON reader to read from.
+     */
+    explicit User(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(User);
+    /**
+     * @brief An invalid user
+     *
+     * This user is returned by classes that hold
+     * a shared User::Ptr, when this pointer is null.
+     *
+     * @return an invalid user.
+     */
+    static const User & null();
     /**
      * @brief If the User instance is valid
      *
@@ -71,7 +91,7 @@ public:
      * @brief Id of the user
      * @return id of the user.
      */
-    QString id() const;
+    TwitterId id() const;
     /**
      * @brief Name of the user
      * @return name of the user.
@@ -181,8 +201,11 @@ public:
      * @return when the user created his/her account.
      */
     QDateTime createdAt() const;
+    friend QDataStream & operator<<(QDataStream &stream, const User &user);
+    friend QDataStream & operator>>(QDataStream &stream, User &user);
 private:
-    QString m_id {};
+    void readEntities(private_util::JsonReader &reader);
+    TwitterId m_id {};
     QString m_name {};
     QString m_screenName {};
     QString m_description {};
@@ -199,7 +222,7 @@ private:
     int m_favouritesCount {0};
     QString m_imageUrl {};
     QString m_bannerUrl {};
-    QDateTime m_createdAt {};
+    qint64 m_createdAt {-1}; // UTC, in milliseconds since epoch
 };
 
 #endif // USER_H
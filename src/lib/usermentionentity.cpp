@@ -30,16 +30,40 @@
  */
 
 #include "usermentionentity.h"
+#include <QtCore/QDataStream>
 #include "entityvisitor.h"
+#include "private/jsonreader.h"
 
 UserMentionEntity::UserMentionEntity(const QJsonObject &json)
 {
+    readIndices(json);
     m_screenName = std::move(json.value(QLatin1String("screen_name")).toString());
     m_text = QString(QLatin1String("@%1")).arg(m_screenName);
     m_id = std::move(json.value(QLatin1String("id_str")).toString());
     m_name = std::move(json.value(QLatin1String("name")).toString());
 }
 
+UserMentionEntity::UserMentionEntity(private_util::JsonReader &reader)
+{
+    if (reader.beginObject()) {
+        while (reader.nextName()) {
+            const QByteArray &name (reader.name());
+            if (name == "screen_name") {
+                m_screenName = reader.readString();
+            } else if (name == "id_str") {
+                m_id = reader.readString();
+            } else if (name == "name") {
+                m_name = reader.readString();
+            } else if (name == "indices") {
+                readIndices(reader);
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    m_text = QString(QLatin1String("@%1")).arg(m_screenName);
+}
+
 bool UserMentionEntity::isValid() const
 {
     return !m_id.isEmpty() && !m_screenName.isEmpty() && !m_name.isEmpty();
@@ -70,3 +94,20 @@ void UserMentionEntity::accept(EntityVisitor &visitor) const
     visitor.visitUserMention(*this);
 }
 
+QDataStream & operator<<(QDataStream &stream, const UserMentionEntity &entity)
+{
+    stream << entity.m_text;
+    stream << entity.m_id;
+    stream << entity.m_screenName;
+    stream << entity.m_name;
+    return stream;
+}
+
+QDataStream & operator>>(QDataStream &stream, UserMentionEntity &entity)
+{
+    stream >> entity.m_text;
+    stream >> entity.m_id;
+    stream >> entity.m_screenName;
+    stream >> entity.m_name;
+    return stream;
+}
@@ -40,6 +40,7 @@ class UserMentionEntity: public Entity
 public:
     explicit UserMentionEntity() = default;
     explicit UserMentionEntity(const QJsonObject &json);
+    explicit UserMentionEntity(private_util::JsonReader &reader);
     DEFAULT_COPY_DEFAULT_MOVE(UserMentionEntity);
     bool isValid() const override;
     QString text() const override;
@@ -47,6 +48,8 @@ public:
     QString screenName() const;
     QString name() const;
     void accept(EntityVisitor &visitor) const override;
+    friend QDataStream & operator<<(QDataStream &stream, const UserMentionEntity &entity);
+    friend QDataStream & operator>>(QDataStream &stream, UserMentionEntity &entity);
 private:
     QString m_text {};
     QString m_id {};
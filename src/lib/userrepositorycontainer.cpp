@@ -31,6 +31,7 @@
 
 #include "userrepositorycontainer.h"
 #include "private/debughelper.h"
+#include "private/replydecoder.h"
 #include "private/repositoryquerycallback.h"
 #include "private/twitterqueryutil.h"
 #include "repositoryqueryhandlerfactory.h"
@@ -40,12 +41,18 @@
 #include <QtCore/QJsonObject>
 #include <QtNetwork/QNetworkReply>
 
-UserRepositoryContainer::UserRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor)
+UserRepositoryContainer::UserRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor,
+                                                 QThreadPool *threadPool)
     : m_queryExecutor(std::move(queryExecutor))
+    , m_decoder(new private_util::ReplyDecoder(threadPool))
 {
     Q_ASSERT_X(m_queryExecutor, "UserCentralRepository", "NULL query executor");
 }
 
+UserRepositoryContainer::~UserRepositoryContainer()
+{
+}
+
 UserRepository * UserRepositoryContainer::repository(const Account &account, const Query &query)
 {
     auto it = m_mapping.find(ContainerKey{Account{account}, Query{query}});
@@ -108,16 +115,32 @@ void UserRepositoryContainer::load(const ContainerKey &key, Data &mappingData,
 
     mappingData.repository.start();
 
-    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, &mappingData, requestType](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
-        std::vector<User> items {};
-        private_util::RepositoryQueryCallback<User> callback {
-            requestType,
-            *mappingData.handler,
-            mappingData.repository,
-            items,
-            mappingData.loading
-        };
-        callback(reply, error, errorMessage);
+    private_util::RepositoryQueryCallback<User>::Ptr callback {
+        std::make_shared<private_util::RepositoryQueryCallback<User>>(requestType, mappingData.handler)
+    };
+    m_queryExecutor->execute(key.query().requestType(), path, parameters, key.account(), [this, key, callback](QIODevice &reply, QNetworkReply::NetworkError error, const QString &errorMessage) {
+        Data *mappingData {getLoadingMappingData(key, callback->handler())};
+        if (mappingData == nullptr) {
+            return;
+        }
+        if (callback->treatError(mappingData->repository, reply, error, errorMessage)) {
+            mappingData->loading = false;
+            return;
+        }
+
+        // Decoding is done in the thread pool, while the result
+        // is placed in the repository in the current thread
+        QByteArray data {reply.readAll()};
+        m_decoder->decode([callback, data]() {
+            callback->decode(data);
+        }, [this, key, callback]() {
+            Data *mappingData {getLoadingMappingData(key, callback->handler())};
+            if (mappingData == nullptr) {
+                return;
+            }
+            mappingData->loading = false;
+            callback->apply(mappingData->repository);
+        });
     });
 }
 
@@ -139,6 +162,17 @@ UserRepositoryContainer::Data * UserRepositoryContainer::getMappingData(const Co
     return &(m_mapping.emplace(key, Data{std::move(handler)}).first->second);
 }
 
+UserRepositoryContainer::Data * UserRepositoryContainer::getLoadingMappingData(const ContainerKey &key,
+                                                                               const IRepositoryQueryHandler<User>::SharedPtr &handler)
+{
+    // The query might have been removed, or even added again, while loading
+    auto it = m_mapping.find(key);
+    if (it == std::end(m_mapping) || it->second.handler != handler) {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
 
 UserRepositoryContainer::Data::Data(IRepositoryQueryHandler<User>::Ptr &&inputHandler)
     : handler{std::move(inputHandler)}
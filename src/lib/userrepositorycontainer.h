@@ -41,10 +41,17 @@
 #include "irepositoryqueryhandler.h"
 #include "iqueryexecutor.h"
 
+class QThreadPool;
+namespace private_util {
+class ReplyDecoder;
+}
+
 class UserRepositoryContainer
 {
 public:
-    explicit UserRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor);
+    explicit UserRepositoryContainer(IQueryExecutor::ConstPtr &&queryExecutor,
+                                     QThreadPool *threadPool = nullptr);
+    ~UserRepositoryContainer();
     DISABLE_COPY_DEFAULT_MOVE(UserRepositoryContainer);
     UserRepository * repository(const Account &account, const Query &query);
     void referenceQuery(const Account &account, const Query &query);
@@ -58,12 +65,15 @@ private:
         bool loading {false};
         UserRepository repository {};
         int refcount {0};
-        IRepositoryQueryHandler<User>::Ptr handler {};
+        IRepositoryQueryHandler<User>::SharedPtr handler {};
     };
     void load(const ContainerKey &key, Data &mappingData,
               IRepositoryQueryHandler<User>::RequestType requestType);
     Data * getMappingData(const ContainerKey &key);
+    Data * getLoadingMappingData(const ContainerKey &key,
+                                 const IRepositoryQueryHandler<User>::SharedPtr &handler);
     IQueryExecutor::ConstPtr m_queryExecutor {nullptr};
+    std::unique_ptr<private_util::ReplyDecoder> m_decoder {};
     std::map<ContainerKey, Data> m_mapping {};
 };
 
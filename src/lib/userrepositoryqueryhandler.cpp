@@ -30,6 +30,8 @@
  */
 
 #include "userrepositoryqueryhandler.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
 #include <QtCore/QUrl>
@@ -62,13 +64,13 @@ Query::Parameters UserRepositoryQueryHandler::additionalParameters(RequestType r
     return returned;
 }
 
-bool UserRepositoryQueryHandler::treatReply(RequestType requestType, const QByteArray &data,
+bool UserRepositoryQueryHandler::treatReply(RequestType requestType, QIODevice &reply,
                                             std::vector<User> &items, QString &errorMessage,
                                             Placement &placement)
 {
     Q_ASSERT_X(requestType == LoadMore, "UserRepositoryQueryHandler", "Refreshed is not implemented for User");
     QJsonParseError error {-1, QJsonParseError::NoError};
-    QJsonDocument document {QJsonDocument::fromJson(data, &error)};
+    QJsonDocument document {QJsonDocument::fromJson(reply.readAll(), &error)};
     if (error.error != QJsonParseError::NoError) {
         errorMessage = error.errorString();
         placement = Discard;
@@ -90,3 +92,21 @@ bool UserRepositoryQueryHandler::treatReply(RequestType requestType, const QByte
     }
     return true;
 }
+
+void UserRepositoryQueryHandler::saveState(QDataStream &stream) const
+{
+    stream << m_nextCursor;
+}
+
+void UserRepositoryQueryHandler::restoreState(QDataStream &stream, const std::vector<User> &items)
+{
+    Q_UNUSED(items);
+    stream >> m_nextCursor;
+}
+
+void UserRepositoryQueryHandler::synchronize(const Repository<User> &repository)
+{
+    // Cursor based pagination cannot be resumed from the
+    // items, so these repositories are not trimmed
+    Q_UNUSED(repository);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include "userstore.h"
+#include <set>
+
+static std::size_t stringSize(const QString &string)
+{
+    return static_cast<std::size_t>(string.size()) * sizeof(QChar);
+}
+
+// Estimation of the memory used by an user, including the
+// content of its strings and of its entity lists
+static std::size_t userSize(const User &user)
+{
+    std::size_t size {sizeof(User)};
+    size += stringSize(user.name());
+    size += stringSize(user.screenName());
+    size += stringSize(user.description());
+    size += stringSize(user.location());
+    size += stringSize(user.url());
+    size += stringSize(user.imageUrl());
+    size += stringSize(user.bannerUrl());
+    size += user.descriptionEntities().size() * sizeof(Entity::Ptr);
+    size += user.urlEntities().size() * sizeof(Entity::Ptr);
+    return size;
+}
+
+// Each tweet embeds the profile of its user when it was sent, and
+// the counters change with each tweet, so they are not compared.
+// Otherwise the tweets of a single reply would rarely share an user.
+static bool isSameProfile(const User &first, const User &second)
+{
+    return first.name() == second.name()
+            && first.screenName() == second.screenName()
+            && first.description() == second.description()
+            && first.location() == second.location()
+            && first.url() == second.url()
+            && first.isProtected() == second.isProtected()
+            && first.isFollowing() == second.isFollowing()
+            && first.imageUrl() == second.imageUrl()
+            && first.bannerUrl() == second.bannerUrl();
+}
+
+User::Ptr UserStore::intern(const User::Ptr &user, bool newer)
+{
+    if (!user || !user->isValid()) {
+        return user;
+    }
+
+    auto it = m_users.find(user->id());
+    if (it != std::end(m_users)) {
+        // Stored users are never modified, because the user objects
+        // that wrap them cache their data. A newer profile replaces
+        // the stored user for the tweets that are interned next.
+        User::Ptr stored {it->second.lock()};
+        if (stored && (!newer || isSameProfile(*stored, *user))) {
+            return stored;
+        }
+        it->second = user;
+        return user;
+    }
+
+    m_users.emplace(user->id(), user);
+    if (m_users.size() > 2 * m_pruneSize) {
+        prune();
+    }
+    return user;
+}
+
+int UserStore::count() const
+{
+    int returned {0};
+    for (const auto &it : m_users) {
+        if (!it.second.expired()) {
+            ++returned;
+        }
+    }
+    return returned;
+}
+
+UserStore::MemoryUsage UserStore::memoryUsage(const TweetRepository &repository)
+{
+    MemoryUsage returned {};
+    std::set<const User *> users {};
+    auto addUser = [&returned, &users](const User &user) {
+        if (!user.isValid()) {
+            return;
+        }
+        std::size_t size {userSize(user)};
+        ++returned.references;
+        returned.unsharedSize += size;
+        if (users.insert(&user).second) {
+            ++returned.users;
+            returned.sharedSize += size;
+        }
+    };
+
+    for (const Tweet &tweet : repository) {
+        addUser(tweet.user());
+        addUser(tweet.retweetingUser());
+        addUser(tweet.quotedStatus().user());
+    }
+    return returned;
+}
+
+void UserStore::prune()
+{
+    // Expired entries are removed when the store doubled in size,
+    // so that the cost of pruning is amortized over the insertions
+    for (auto it = std::begin(m_users); it != std::end(m_users);) {
+        if (it->second.expired()) {
+            it = m_users.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_pruneSize = m_users.size();
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef USERSTORE_H
+#define USERSTORE_H
+
+#include <map>
+#include <memory>
+#include "globals.h"
+#include "tweetrepository.h"
+#include "user.h"
+
+/**
+ * @brief A store of users, keyed by id
+ *
+ * This class interns users, so that all the tweets
+ * that are sent by the same user share the same
+ * User instance, instead of each embedding a copy.
+ *
+ * Stored users are never modified. When a newer profile
+ * of an user is interned, it replaces the stored
+ * instance, and is shared by the tweets that are
+ * interned next, while the older tweets keep the
+ * instance they reference. Counters, like the number
+ * of followers, are not enough to replace an user.
+ *
+ * The store does not own the users: an user is
+ * released when the last tweet that references it
+ * is destroyed.
+ *
+ * This class is not thread-safe, and should be used
+ * in the thread of the repositories.
+ */
+class UserStore
+{
+public:
+    /**
+     * @brief Memory used by the users of a timeline
+     */
+    struct MemoryUsage
+    {
+        int references {0}; /**< Number of users that are referenced by the tweets. */
+        int users {0}; /**< Number of distinct User instances. */
+        std::size_t sharedSize {0}; /**< Bytes used by the distinct User instances. */
+        std::size_t unsharedSize {0}; /**< Bytes that would be used by embedded copies. */
+    };
+    explicit UserStore() = default;
+    DISABLE_COPY_DEFAULT_MOVE(UserStore);
+    /**
+     * @brief Intern an user
+     *
+     * If an user with the same id is already in the store,
+     * the stored instance is returned. If newer is set, and the
+     * profile of the input user is different, the input user
+     * replaces the stored instance, and is returned.
+     *
+     * Invalid users are returned as is.
+     *
+     * @param user user to intern.
+     * @param newer if the input user is more recent than the stored one.
+     * @return shared instance of the user.
+     */
+    User::Ptr intern(const User::Ptr &user, bool newer = true);
+    /**
+     * @brief Number of users in the store
+     * @return number of users in the store.
+     */
+    int count() const;
+    /**
+     * @brief Memory used by the users of a timeline
+     * @param repository timeline to inspect.
+     * @return memory used by the users of the timeline.
+     */
+    static MemoryUsage memoryUsage(const TweetRepository &repository);
+private:
+    void prune();
+    std::map<TwitterId, std::weak_ptr<User>> m_users {};
+    std::size_t m_pruneSize {0};
+};
+
+#endif // USERSTORE_H
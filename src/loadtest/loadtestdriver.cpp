@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include "loadtestdriver.h"
+#include <algorithm>
+#include <QtCore/QFile>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <private/networkqueryexecutor.h>
+#include <private/replayqueryexecutor.h>
+#include <private/twitterqueryutil.h>
+
+// Users 10000 to 10049 have tweets in the mock server
+static const int MOCK_USER_COUNT = 50;
+static const int MOCK_FIRST_USER_ID = 10000;
+
+static qint64 cpuTime()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static qint64 residentSetSize()
+{
+    QFile file {QLatin1String("/proc/self/statm")};
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QList<QByteArray> fields {file.readAll().split(' ')};
+    if (fields.size() < 2) {
+        return 0;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static qint64 percentile(const std::vector<qint64> &sorted, int percent)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    std::size_t index {(sorted.size() - 1) * percent / 100};
+    return sorted.at(index);
+}
+
+class LoadTestDriver::Column : public IRepositoryListener<Tweet>
+{
+public:
+    explicit Column(LoadTestDriver &driver, Query &&query)
+        : m_driver(driver), m_query(std::move(query))
+    {
+    }
+    const Query & query() const
+    {
+        return m_query;
+    }
+    void onAppend(const Tweet &) override
+    {
+        ++m_driver.m_sample.tweets;
+    }
+    void onAppend(const std::vector<Tweet> &items) override
+    {
+        m_driver.m_sample.tweets += static_cast<int>(items.size());
+    }
+    void onPrepend(const std::vector<Tweet> &items) override
+    {
+        m_driver.m_sample.tweets += static_cast<int>(items.size());
+    }
+    void onUpdate(int, const Tweet &) override
+    {
+    }
+    void onRemove(int) override
+    {
+    }
+    void onMove(int, int) override
+    {
+    }
+    void onInvalidation() override
+    {
+    }
+    void onStart() override
+    {
+        m_timer.start();
+    }
+    void onError(const QString &) override
+    {
+        ++m_driver.m_sample.errors;
+        record();
+    }
+    void onFinish() override
+    {
+        record();
+    }
+private:
+    void record()
+    {
+        if (!m_timer.isValid()) {
+            return;
+        }
+        ++m_driver.m_sample.requests;
+        m_driver.m_sample.latencies.push_back(m_timer.elapsed());
+        m_timer.invalidate();
+    }
+    LoadTestDriver &m_driver;
+    Query m_query {};
+    QElapsedTimer m_timer {};
+};
+
+LoadTestDriver::LoadTestDriver(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_account(QLatin1String("Load test"), QString::number(MOCK_FIRST_USER_ID), QLatin1String("user_0"),
+                QByteArray("token"), QByteArray("secret"))
+    , m_networkStack(new private_util::NetworkStack(m_options.baseUrl))
+    , m_container(new TweetRepositoryContainer(createQueryExecutor()))
+{
+    m_container->setMaximumSize(m_options.maximumSize);
+    m_container->setMaximumConcurrentLoads(m_options.maximumConcurrentLoads);
+    if (m_options.streaming) {
+        m_streamDispatcher.reset(new private_util::StreamDispatcher(m_networkStack->network(), m_options.baseUrl,
+                                                                    *m_container));
+    }
+    for (int i = 0; i < m_options.columns; ++i) {
+        m_columns.emplace_back(new Column(*this, columnQuery(i)));
+    }
+
+    m_refreshTimer.setInterval(m_options.refreshInterval);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &LoadTestDriver::refresh);
+    m_sampleTimer.setInterval(m_options.sampleInterval);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &LoadTestDriver::sample);
+    m_durationTimer.setInterval(m_options.duration * 1000);
+    m_durationTimer.setSingleShot(true);
+    connect(&m_durationTimer, &QTimer::timeout, this, &LoadTestDriver::finish);
+}
+
+LoadTestDriver::~LoadTestDriver()
+{
+    for (const std::unique_ptr<Column> &column : m_columns) {
+        TweetRepository *repository {m_container->repository(m_account, column->query())};
+        if (repository != nullptr) {
+            repository->removeListener(*column);
+        }
+    }
+}
+
+void LoadTestDriver::start()
+{
+    m_output << "time,requests,errors,tweets,tweets_per_s,latency_p50_ms,latency_p95_ms,"
+             << "latency_max_ms,cpu_percent,rss_kb" << endl;
+
+    m_elapsed.start();
+    m_lastCpuTime = cpuTime();
+    // Opens a connection to the server, and keeps it alive
+    m_networkStack->setOnline(true);
+    for (const std::unique_ptr<Column> &column : m_columns) {
+        m_container->referenceQuery(m_account, column->query());
+        TweetRepository *repository {m_container->repository(m_account, column->query())};
+        if (repository != nullptr) {
+            repository->addListener(*column);
+        }
+    }
+    // Like on a phone, only the first column is on screen
+    if (!m_columns.empty()) {
+        m_container->setRefreshPriority(m_account, m_columns.front()->query(), TweetRepositoryContainer::Visible);
+    }
+    if (m_streamDispatcher) {
+        std::set<Query> queries {};
+        for (const std::unique_ptr<Column> &column : m_columns) {
+            queries.insert(column->query());
+        }
+        m_streamDispatcher->setQueries(m_account, queries);
+        m_streamDispatcher->setEnabled(true);
+    }
+    refresh();
+    m_refreshTimer.start();
+    m_sampleTimer.start();
+    m_durationTimer.start();
+}
+
+Query LoadTestDriver::columnQuery(int index)
+{
+    // The first columns are the home timeline and the mentions, the next
+    // ones cycle through the other timelines, with different parameters
+    // so that every column is a distinct query
+    QByteArray userId {QByteArray::number(MOCK_FIRST_USER_ID + index % MOCK_USER_COUNT)};
+    if (index == 0) {
+        return TweetRepositoryQuery(TweetRepositoryQuery::Home, {});
+    } else if (index == 1) {
+        return TweetRepositoryQuery(TweetRepositoryQuery::Mentions, {});
+    }
+    switch ((index - 2) % 3) {
+    case 0:
+        return TweetRepositoryQuery(TweetRepositoryQuery::Search, {{"q", QByteArray("qt") + QByteArray::number(index)}});
+    case 1:
+        return TweetRepositoryQuery(TweetRepositoryQuery::Favorites, {{"user_id", userId}});
+    default:
+        return TweetRepositoryQuery(TweetRepositoryQuery::UserTimeline, {{"user_id", userId}});
+    }
+}
+
+IQueryExecutor::ConstPtr LoadTestDriver::createQueryExecutor()
+{
+    if (!m_options.replayDirPath.isEmpty()) {
+        return private_util::ReplayQueryExecutor::create(m_options.replayDirPath);
+    }
+    return private_util::NetworkQueryExecutor::create(m_networkStack->network(), private_util::TwitterQueryUtil::apiUrl(m_options.baseUrl));
+}
+
+void LoadTestDriver::refresh()
+{
+    m_container->refresh();
+}
+
+void LoadTestDriver::sample()
+{
+    qint64 now {m_elapsed.elapsed()};
+    qint64 cpu {cpuTime()};
+    qint64 wall {std::max<qint64>(now - m_lastSampleTime, 1)};
+    double cpuPercent {static_cast<double>(cpu - m_lastCpuTime) / 10. / wall};
+
+    std::vector<qint64> &latencies (m_sample.latencies);
+    std::sort(std::begin(latencies), std::end(latencies));
+    m_output << QString::number(now / 1000., 'f', 1) << ","
+             << m_sample.requests << ","
+             << m_sample.errors << ","
+             << m_sample.tweets << ","
+             << QString::number(m_sample.tweets * 1000. / wall, 'f', 1) << ","
+             << percentile(latencies, 50) << ","
+             << percentile(latencies, 95) << ","
+             << (latencies.empty() ? 0 : latencies.back()) << ","
+             << QString::number(cpuPercent, 'f', 1) << ","
+             << residentSetSize() << endl;
+
+    m_total.requests += m_sample.requests;
+    m_total.errors += m_sample.errors;
+    m_total.tweets += m_sample.tweets;
+    m_total.latencies.insert(std::end(m_total.latencies), std::begin(latencies), std::end(latencies));
+    m_sample = Sample();
+    m_lastSampleTime = now;
+    m_lastCpuTime = cpu;
+}
+
+void LoadTestDriver::finish()
+{
+    m_refreshTimer.stop();
+    m_sampleTimer.stop();
+    sample();
+
+    std::vector<qint64> &latencies (m_total.latencies);
+    std::sort(std::begin(latencies), std::end(latencies));
+    QTextStream summary {stderr};
+    summary << "Requests: " << m_total.requests << ", errors: " << m_total.errors
+            << ", tweets: " << m_total.tweets << endl;
+    summary << "Latency p50: " << percentile(latencies, 50) << " ms, p95: "
+            << percentile(latencies, 95) << " ms, max: "
+            << (latencies.empty() ? 0 : latencies.back()) << " ms" << endl;
+    const private_util::NetworkStack::Statistics &statistics (m_networkStack->statistics());
+    summary << "Encrypted connections: " << statistics.connections << ", HTTP/2 requests: " << statistics.http2Requests
+            << ", reuse rate: " << statistics.reuseRate() << endl;
+    for (const std::pair<QByteArray, private_util::NetworkStack::Transfer> &transfer : statistics.transfers) {
+        summary << transfer.first << ": " << transfer.second.replies << " replies, received: "
+                << transfer.second.wireBytes << " bytes, decoded: " << transfer.second.decodedBytes << " bytes" << endl;
+    }
+    emit finished();
+}
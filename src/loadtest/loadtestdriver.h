@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#ifndef LOADTESTDRIVER_H
+#define LOADTESTDRIVER_H
+
+#include <memory>
+#include <vector>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QObject>
+#include <QtCore/QTextStream>
+#include <QtCore/QTimer>
+#include <account.h>
+#include <irepositorylistener.h>
+#include <query.h>
+#include <tweet.h>
+#include <tweetrepositorycontainer.h>
+#include <private/networkstack.h>
+#include <private/streamdispatcher.h>
+
+/**
+ * @brief Headless driver used to load test the library
+ *
+ * This driver opens a number of columns, refreshes them on
+ * a schedule, and prints a CSV line for each sample, containing
+ * the latency of the requests, the throughput, the CPU usage
+ * and the RSS of the process.
+ *
+ * With streaming, the columns that can be streamed receive their
+ * tweets from the streams of the server instead of being refreshed.
+ *
+ * It is meant to be run against tools/mockserver, where the
+ * payload sizes, latency and errors can be configured, or
+ * against replies recorded in a directory.
+ */
+class LoadTestDriver : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        int columns {5};
+        int refreshInterval {10000};
+        int sampleInterval {1000};
+        int duration {60};
+        int maximumSize {TweetRepositoryContainer::DefaultMaximumSize};
+        int maximumConcurrentLoads {TweetRepositoryContainer::DefaultMaximumConcurrentLoads};
+        QByteArray baseUrl {"http://localhost:8000/"};
+        QString replayDirPath {};
+        bool streaming {false};
+    };
+    explicit LoadTestDriver(const Options &options, QObject *parent = 0);
+    ~LoadTestDriver();
+    void start();
+signals:
+    void finished();
+private:
+    class Column;
+    struct Sample
+    {
+        int requests {0};
+        int errors {0};
+        int tweets {0};
+        std::vector<qint64> latencies {};
+    };
+    static Query columnQuery(int index);
+    IQueryExecutor::ConstPtr createQueryExecutor();
+    void refresh();
+    void sample();
+    void finish();
+    Options m_options {};
+    Account m_account {};
+    std::unique_ptr<private_util::NetworkStack> m_networkStack {};
+    std::unique_ptr<TweetRepositoryContainer> m_container {};
+    std::unique_ptr<private_util::StreamDispatcher> m_streamDispatcher {};
+    std::vector<std::unique_ptr<Column>> m_columns {};
+    QTimer m_refreshTimer {};
+    QTimer m_sampleTimer {};
+    QTimer m_durationTimer {};
+    QElapsedTimer m_elapsed {};
+    qint64 m_lastSampleTime {0};
+    qint64 m_lastCpuTime {0};
+    Sample m_sample {};
+    Sample m_total {};
+    QTextStream m_output {stdout};
+};
+
+#endif // LOADTESTDRIVER_H
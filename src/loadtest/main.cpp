@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QLoggingCategory>
+#include "loadtestdriver.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app {argc, argv};
+    QLoggingCategory::setFilterRules(QLatin1String("*.debug=false"));
+
+    QCommandLineParser parser {};
+    parser.setApplicationDescription(QLatin1String("Load test the library against tools/mockserver. "
+                                                   "Samples are printed as CSV on the standard output."));
+    parser.addHelpOption();
+    QCommandLineOption columns {QLatin1String("columns"), QLatin1String("Number of columns to open."),
+                                QLatin1String("count"), QLatin1String("5")};
+    QCommandLineOption refresh {QLatin1String("refresh"), QLatin1String("Interval between refreshes, in ms."),
+                                QLatin1String("interval"), QLatin1String("10000")};
+    QCommandLineOption sample {QLatin1String("sample"), QLatin1String("Interval between samples, in ms."),
+                               QLatin1String("interval"), QLatin1String("1000")};
+    QCommandLineOption duration {QLatin1String("duration"), QLatin1String("Duration of the test, in s."),
+                                 QLatin1String("duration"), QLatin1String("60")};
+    QCommandLineOption maximumSize {QLatin1String("maximum-size"),
+                                    QLatin1String("Maximum number of tweets per column, or 0 for no limit."),
+                                    QLatin1String("count"),
+                                    QString::number(TweetRepositoryContainer::DefaultMaximumSize)};
+    QCommandLineOption concurrentLoads {QLatin1String("concurrent-loads"),
+                                        QLatin1String("Maximum number of columns loading at the same time, or 0 for no limit."),
+                                        QLatin1String("count"),
+                                        QString::number(TweetRepositoryContainer::DefaultMaximumConcurrentLoads)};
+    QCommandLineOption url {QLatin1String("url"), QLatin1String("Base URL of the server."),
+                            QLatin1String("url"), QLatin1String("http://localhost:8000/")};
+    QCommandLineOption replay {QLatin1String("replay"),
+                               QLatin1String("Serve the replies recorded in a directory instead of using the network."),
+                               QLatin1String("dir")};
+    QCommandLineOption streaming {QLatin1String("streaming"),
+                                  QLatin1String("Stream the home timeline, the mentions and the searches.")};
+    parser.addOption(columns);
+    parser.addOption(refresh);
+    parser.addOption(sample);
+    parser.addOption(duration);
+    parser.addOption(maximumSize);
+    parser.addOption(concurrentLoads);
+    parser.addOption(url);
+    parser.addOption(replay);
+    parser.addOption(streaming);
+    parser.process(app);
+
+    LoadTestDriver::Options options {};
+    options.columns = parser.value(columns).toInt();
+    options.refreshInterval = parser.value(refresh).toInt();
+    options.sampleInterval = parser.value(sample).toInt();
+    options.duration = parser.value(duration).toInt();
+    options.maximumSize = parser.value(maximumSize).toInt();
+    options.maximumConcurrentLoads = parser.value(concurrentLoads).toInt();
+    options.baseUrl = parser.value(url).toLatin1();
+    if (!options.baseUrl.endsWith('/')) {
+        options.baseUrl.append('/');
+    }
+    options.replayDirPath = parser.value(replay);
+    options.streaming = parser.isSet(streaming);
+
+    LoadTestDriver driver {options};
+    QObject::connect(&driver, &LoadTestDriver::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    driver.start();
+    return app.exec();
+}
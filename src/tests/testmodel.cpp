@@ -82,13 +82,13 @@ QVariant TestModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= rowCount()) {
         return QVariant();
     }
-    const QObjectPtr<TestDataObject> &data = m_items[row];
+    TestDataObject *data {item(row)};
     switch (role) {
     case ValueRole:
         return data->value();
         break;
     case ItemRole:
-        return QVariant::fromValue(data.get());
+        return QVariant::fromValue(data);
         break;
     default:
         return QVariant();
@@ -120,6 +120,8 @@ public:
         ItemRole
     };
     explicit TestModel(QObject *parent = 0);
+    using qml::Model<TestData, TestDataObject>::setLazy;
+    using qml::Model<TestData, TestDataObject>::setMaximumObjectCount;
     QVariant data(const QModelIndex &index, int role) const override final;
 private:
     QHash<int, QByteArray> roleNames() const override final;
@@ -122,13 +122,13 @@ public:
 private:
     void onAppend(const T &item) override
     {
-        data.emplace_back(Data::createAppend(std::vector<QString>{item.id()}));
+        data.emplace_back(Data::createAppend(std::vector<QString>{item.id().toString()}));
     }
     void onAppend(const std::vector<T> &items) override
     {
         std::vector<QString> ids {};
         for (const T &item : items) {
-            ids.push_back(item.id());
+            ids.push_back(item.id().toString());
         }
         data.emplace_back(Data::createAppend(ids));
     }
@@ -136,13 +136,13 @@ private:
     {
         std::vector<QString> ids {};
         for (const T &item : items) {
-            ids.push_back(item.id());
+            ids.push_back(item.id().toString());
         }
         data.emplace_back(Data::createPrepend(ids));
     }
     void onUpdate(int index, const T &item) override
     {
-        data.emplace_back(Data::createUpdate(index, item.id()));
+        data.emplace_back(Data::createUpdate(index, item.id().toString()));
     }
     void onRemove(int index) override
     {
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryDir>
+#include <account.h>
+#include <private/cachingqueryexecutor.h>
+#include "mockqueryexecutor.h"
+
+using testing::Return;
+using testing::_;
+
+// A reply with a status and an ETag
+class ValidatedReply: public QNetworkReply
+{
+public:
+    explicit ValidatedReply(int status, const QByteArray &etag, const QByteArray &body)
+        : m_body(body)
+    {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, status);
+        setRawHeader("ETag", etag);
+        open(QIODevice::ReadOnly);
+    }
+    void abort() override
+    {
+    }
+    qint64 bytesAvailable() const override
+    {
+        return m_body.size() - m_position + QIODevice::bytesAvailable();
+    }
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        qint64 size {std::min<qint64>(maxSize, m_body.size() - m_position)};
+        if (size <= 0) {
+            return -1;
+        }
+        std::copy(m_body.constData() + m_position, m_body.constData() + m_position + size, data);
+        m_position += size;
+        return size;
+    }
+private:
+    QByteArray m_body {};
+    qint64 m_position {0};
+};
+
+// Answers 304 Not Modified when the request carries the current ETag
+class ValidatingQueryExecutor: public IQueryExecutor
+{
+public:
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        execute(type, path, parameters, {}, account, callback);
+    }
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const std::map<QByteArray, QByteArray> &headers,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        Q_UNUSED(type)
+        Q_UNUSED(path)
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        ++requests;
+        auto it = headers.find("If-None-Match");
+        bool notModified {it != std::end(headers) && it->second == etag};
+        ValidatedReply reply {notModified ? 304 : 200, etag, notModified ? QByteArray() : body};
+        callback(reply, QNetworkReply::NoError, QString());
+    }
+    QByteArray etag {};
+    QByteArray body {};
+    mutable int requests {0};
+};
+
+class cachingqueryexecutor: public testing::Test
+{
+public:
+    explicit cachingqueryexecutor()
+        : account(QLatin1String("test"), QLatin1String("1"), QLatin1String("test"), QByteArray("token"), QByteArray())
+    {
+    }
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        queryExecutor = new MockQueryExecutor();
+        EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+        EXPECT_CALL(*queryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+        executor = create(IQueryExecutor::ConstPtr(queryExecutor));
+    }
+    IQueryExecutor::ConstPtr create(IQueryExecutor::ConstPtr &&queryExecutor,
+                                    qint64 maximumSize = private_util::CachingQueryExecutor::DefaultMaximumSize)
+    {
+        return private_util::CachingQueryExecutor::create(std::move(queryExecutor), dir.path(), maximumSize,
+                                                          [this]() { return now; });
+    }
+    const private_util::CachingQueryExecutor & caching() const
+    {
+        return static_cast<const private_util::CachingQueryExecutor &>(*executor);
+    }
+    QByteArray execute(Query::RequestType type, const QByteArray &path,
+                       const std::map<QByteArray, QByteArray> &parameters)
+    {
+        QByteArray returned {};
+        executor->execute(type, path, parameters, account,
+                          [&returned](QIODevice &reply, QNetworkReply::NetworkError, const QString &) {
+            returned = reply.readAll();
+        });
+        return returned;
+    }
+    QTemporaryDir dir {};
+    qint64 now {1000000};
+    MockQueryExecutor *queryExecutor {nullptr};
+    IQueryExecutor::ConstPtr executor {};
+    Account account;
+};
+
+TEST_F(cachingqueryexecutor, TimeToLive)
+{
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("users/show.json"), _, _))
+            .Times(2)
+            .WillOnce(Return(QByteArray("{\"id_str\": \"1\"}")))
+            .WillOnce(Return(QByteArray("{\"id_str\": \"2\"}")));
+
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+    now += 30 * 1000;
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+    EXPECT_EQ(caching().statistics().hits, 1);
+    EXPECT_EQ(caching().statistics().misses, 1);
+
+    // Expired replies are requested again
+    now += 60 * 1000;
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"2\"}"));
+    EXPECT_EQ(caching().statistics().misses, 2);
+    EXPECT_DOUBLE_EQ(caching().statistics().hitRate(), 1. / 3.);
+}
+
+TEST_F(cachingqueryexecutor, Uncached)
+{
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("statuses/home_timeline.json"), _, _))
+            .Times(2).WillRepeatedly(Return(QByteArray("[]")));
+
+    execute(Query::Get, "statuses/home_timeline.json", {});
+    execute(Query::Get, "statuses/home_timeline.json", {});
+    EXPECT_EQ(caching().statistics().uncached, 2);
+    EXPECT_EQ(caching().size(), 0);
+}
+
+TEST_F(cachingqueryexecutor, PostInvalidates)
+{
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("users/show.json"), _, _))
+            .Times(2).WillRepeatedly(Return(QByteArray("{}")));
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("friendships/create.json"), _, _))
+            .Times(1).WillRepeatedly(Return(QByteArray("{}")));
+
+    execute(Query::Get, "users/show.json", {{"user_id", "1"}});
+    execute(Query::Post, "friendships/create.json", {{"user_id", "1"}});
+    execute(Query::Get, "users/show.json", {{"user_id", "1"}});
+    EXPECT_EQ(caching().statistics().hits, 0);
+}
+
+TEST_F(cachingqueryexecutor, Persistence)
+{
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("lists/ownerships.json"), _, _))
+            .Times(1).WillRepeatedly(Return(QByteArray("{\"lists\": []}")));
+    execute(Query::Get, "lists/ownerships.json", {{"user_id", "1"}});
+
+    // Another executor reads the replies stored on disk
+    MockQueryExecutor *otherQueryExecutor {new MockQueryExecutor()};
+    EXPECT_CALL(*otherQueryExecutor, makeReply(_, _, _)).Times(0);
+    executor = create(IQueryExecutor::ConstPtr(otherQueryExecutor));
+    EXPECT_EQ(execute(Query::Get, "lists/ownerships.json", {{"user_id", "1"}}), QByteArray("{\"lists\": []}"));
+    EXPECT_EQ(caching().statistics().hits, 1);
+}
+
+TEST_F(cachingqueryexecutor, Memory)
+{
+    EXPECT_CALL(*queryExecutor, makeReply(QByteArray("users/show.json"), _, _))
+            .Times(1).WillRepeatedly(Return(QByteArray("{\"id_str\": \"1\"}")));
+    execute(Query::Get, "users/show.json", {{"user_id", "1"}});
+
+    // Recently used replies are not read from the disk
+    QDir cacheDir {dir.path()};
+    for (const QString &fileName : cacheDir.entryList(QDir::Files)) {
+        ASSERT_TRUE(cacheDir.remove(fileName));
+    }
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+    EXPECT_EQ(caching().statistics().hits, 1);
+}
+
+TEST_F(cachingqueryexecutor, MaximumSize)
+{
+    MockQueryExecutor *otherQueryExecutor {new MockQueryExecutor()};
+    EXPECT_CALL(*otherQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*otherQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*otherQueryExecutor, makeReply(QByteArray("users/show.json"), _, _))
+            .WillRepeatedly(Return(QByteArray(1000, 'a')));
+    executor = create(IQueryExecutor::ConstPtr(otherQueryExecutor), 2500);
+
+    execute(Query::Get, "users/show.json", {{"user_id", "1"}});
+    now += 1;
+    execute(Query::Get, "users/show.json", {{"user_id", "2"}});
+    now += 1;
+    execute(Query::Get, "users/show.json", {{"user_id", "3"}});
+    EXPECT_LE(caching().size(), 2500);
+
+    // The oldest reply is removed first
+    execute(Query::Get, "users/show.json", {{"user_id", "3"}});
+    EXPECT_EQ(caching().statistics().hits, 1);
+    execute(Query::Get, "users/show.json", {{"user_id", "1"}});
+    EXPECT_EQ(caching().statistics().hits, 1);
+}
+
+TEST_F(cachingqueryexecutor, Revalidation)
+{
+    ValidatingQueryExecutor *validatingQueryExecutor {new ValidatingQueryExecutor()};
+    validatingQueryExecutor->etag = QByteArray("\"1\"");
+    validatingQueryExecutor->body = QByteArray("{\"id_str\": \"1\"}");
+    executor = create(IQueryExecutor::ConstPtr(validatingQueryExecutor));
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+
+    // Expired replies that did not change are served again
+    now += 120 * 1000;
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+    EXPECT_EQ(validatingQueryExecutor->requests, 2);
+    EXPECT_EQ(caching().statistics().revalidations, 1);
+    EXPECT_EQ(caching().statistics().misses, 1);
+
+    // And are fresh again
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"1\"}"));
+    EXPECT_EQ(validatingQueryExecutor->requests, 2);
+    EXPECT_EQ(caching().statistics().hits, 1);
+
+    // Replies that changed replace the stored ones
+    now += 120 * 1000;
+    validatingQueryExecutor->etag = QByteArray("\"2\"");
+    validatingQueryExecutor->body = QByteArray("{\"id_str\": \"2\"}");
+    EXPECT_EQ(execute(Query::Get, "users/show.json", {{"user_id", "1"}}), QByteArray("{\"id_str\": \"2\"}"));
+    EXPECT_EQ(caching().statistics().revalidations, 1);
+    EXPECT_EQ(caching().statistics().misses, 2);
+}
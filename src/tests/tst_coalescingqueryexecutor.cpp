@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <QtCore/QBuffer>
+#include <account.h>
+#include <private/coalescingqueryexecutor.h>
+#include <private/sharedqueryexecutor.h>
+
+// Keeps the queries in flight until reply() is called
+class DeferredQueryExecutor: public IQueryExecutor
+{
+public:
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        Q_UNUSED(type)
+        Q_UNUSED(path)
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        callbacks.push_back(callback);
+    }
+    void reply(const QByteArray &data)
+    {
+        std::vector<Callback_t> pending {};
+        pending.swap(callbacks);
+        for (const Callback_t &callback : pending) {
+            QBuffer buffer {};
+            buffer.setData(data);
+            buffer.open(QIODevice::ReadOnly);
+            callback(buffer, QNetworkReply::NoError, QString());
+        }
+    }
+    mutable std::vector<Callback_t> callbacks {};
+};
+
+class coalescingqueryexecutor: public testing::Test
+{
+public:
+    explicit coalescingqueryexecutor()
+        : account(QLatin1String("test"), QLatin1String("1"), QLatin1String("test"), QByteArray("token"), QByteArray())
+        , otherAccount(QLatin1String("test"), QLatin1String("2"), QLatin1String("test"), QByteArray("token"), QByteArray())
+    {
+        queryExecutor = new DeferredQueryExecutor();
+        IQueryExecutor::ConstPtr executor {private_util::CoalescingQueryExecutor::create(IQueryExecutor::ConstPtr(queryExecutor))};
+        coalescingExecutor = static_cast<const private_util::CoalescingQueryExecutor *>(executor.get());
+        sharedExecutor = std::move(executor);
+    }
+protected:
+    IQueryExecutor::Callback_t record(std::vector<QByteArray> &replies)
+    {
+        return [&replies](QIODevice &reply, QNetworkReply::NetworkError, const QString &) {
+            replies.push_back(reply.readAll());
+        };
+    }
+    DeferredQueryExecutor *queryExecutor {nullptr};
+    const private_util::CoalescingQueryExecutor *coalescingExecutor {nullptr};
+    IQueryExecutor::SharedPtr sharedExecutor {};
+    Account account;
+    Account otherAccount;
+};
+
+TEST_F(coalescingqueryexecutor, MergeIdenticalQueries)
+{
+    // Two containers sharing the same executor
+    IQueryExecutor::ConstPtr first {private_util::SharedQueryExecutor::create(sharedExecutor)};
+    IQueryExecutor::ConstPtr second {private_util::SharedQueryExecutor::create(sharedExecutor)};
+
+    std::vector<QByteArray> replies {};
+    first->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, record(replies));
+    second->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, record(replies));
+    EXPECT_EQ(queryExecutor->callbacks.size(), static_cast<std::size_t>(1));
+    EXPECT_EQ(coalescingExecutor->pendingCount(), 1);
+    EXPECT_EQ(coalescingExecutor->coalescedCount(), 1);
+
+    queryExecutor->reply("{}");
+    EXPECT_EQ(replies, std::vector<QByteArray>({"{}", "{}"}));
+    EXPECT_EQ(coalescingExecutor->pendingCount(), 0);
+
+    // Once the reply arrived, the query is sent again
+    first->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, record(replies));
+    EXPECT_EQ(queryExecutor->callbacks.size(), static_cast<std::size_t>(1));
+}
+
+TEST_F(coalescingqueryexecutor, DistinctQueries)
+{
+    std::vector<QByteArray> replies {};
+    sharedExecutor->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, record(replies));
+    sharedExecutor->execute(Query::Get, "users/show.json", {{"user_id", "2"}}, account, record(replies));
+    sharedExecutor->execute(Query::Get, "statuses/show.json", {{"user_id", "1"}}, account, record(replies));
+    sharedExecutor->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, otherAccount, record(replies));
+    sharedExecutor->execute(Query::Post, "favorites/create.json", {{"id", "1"}}, account, record(replies));
+    sharedExecutor->execute(Query::Post, "favorites/create.json", {{"id", "1"}}, account, record(replies));
+    EXPECT_EQ(queryExecutor->callbacks.size(), static_cast<std::size_t>(6));
+    EXPECT_EQ(coalescingExecutor->coalescedCount(), 0);
+
+    queryExecutor->reply("{}");
+    EXPECT_EQ(replies.size(), static_cast<std::size_t>(6));
+}
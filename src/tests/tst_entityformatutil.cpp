@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QJsonDocument>
+#include <private/entityformatutil.h>
+
+static Entity::List createEntities(const QByteArray &json)
+{
+    return Entity::create(QJsonDocument::fromJson(json).object());
+}
+
+TEST(entityformatutil, Indices)
+{
+    // Indices are expressed in code points, the emoji counts for one
+    const QString input {QString::fromUtf8("Hi @Foo &amp; #tag \xF0\x9F\x98\x80 http://t.co/x")};
+    Entity::List entities {createEntities(
+        "{\"user_mentions\": [{\"screen_name\": \"foo\", \"id_str\": \"1\", \"name\": \"Foo\", \"indices\": [3, 7]}],"
+        " \"hashtags\": [{\"text\": \"tag\", \"indices\": [10, 14]}],"
+        " \"urls\": [{\"url\": \"http://t.co/x\", \"display_url\": \"example.com/x\","
+        " \"expanded_url\": \"http://example.com/x\", \"indices\": [17, 30]}]}"
+    )};
+
+    const QString expected {QString::fromUtf8("Hi <a href=\"user://1\">@foo</a> &amp; "
+                                              "<a href=\"hashtag://tag\">#tag</a> \xF0\x9F\x98\x80 "
+                                              "<a href=\"http://example.com/x\">example.com/x</a>")};
+    EXPECT_EQ(expected, private_util::formatEntities(input, entities, true));
+
+    const QString expectedWithoutLinks {QString::fromUtf8("Hi @Foo &amp; #tag \xF0\x9F\x98\x80 example.com/x")};
+    EXPECT_EQ(expectedWithoutLinks, private_util::formatEntities(input, entities, false));
+}
+
+TEST(entityformatutil, Escape)
+{
+    const QString input {QLatin1String("<b>&amp;lt; \"quoted\"</b>")};
+    EXPECT_EQ(QString(QLatin1String("&lt;b&gt;&amp;lt; &quot;quoted&quot;&lt;/b&gt;")),
+              private_util::formatEntities(input, Entity::List(), true));
+}
+
+TEST(entityformatutil, WithoutIndices)
+{
+    // Hashtags are not replaced inside longer hashtags
+    const QString input {QLatin1String("#Tag #tagged #tag")};
+    Entity::List entities {createEntities("{\"hashtags\": [{\"text\": \"tag\"}]}")};
+
+    const QString expected {QLatin1String("<a href=\"hashtag://tag\">#tag</a> #tagged <a href=\"hashtag://tag\">#tag</a>")};
+    EXPECT_EQ(expected, private_util::formatEntities(input, entities, true));
+}
+
+TEST(entityformatutil, WrongIndices)
+{
+    const QString input {QLatin1String("See http://t.co/x")};
+    Entity::List entities {createEntities(
+        "{\"urls\": [{\"url\": \"http://t.co/x\", \"display_url\": \"example.com/x\","
+        " \"expanded_url\": \"http://example.com/x\", \"indices\": [0, 13]}]}"
+    )};
+
+    EXPECT_EQ(QString(QLatin1String("See example.com/x")), private_util::formatEntities(input, entities, false));
+}
+
+TEST(entityformatutil, PlainText)
+{
+    const QString input {QLatin1String("@foo &amp; #tag http://t.co/x")};
+    Entity::List entities {createEntities(
+        "{\"user_mentions\": [{\"screen_name\": \"foo\", \"id_str\": \"1\", \"name\": \"Foo\", \"indices\": [0, 4]}],"
+        " \"urls\": [{\"url\": \"http://t.co/x\", \"display_url\": \"example.com/x\","
+        " \"expanded_url\": \"http://example.com/x\", \"indices\": [12, 25]}]}"
+    )};
+
+    EXPECT_EQ(QString(QLatin1String("@foo & #tag example.com/x")), private_util::formatPlainText(input, entities));
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <QtCore/QBuffer>
+#include <private/gzipdevice.h>
+#include <private/jsonreader.h>
+#include <zlib.h>
+
+using private_util::GzipDevice;
+using private_util::JsonReader;
+
+static QByteArray compress(const QByteArray &data)
+{
+    z_stream stream {};
+    // 16 + MAX_WBITS writes a gzip header and trailer
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    QByteArray returned {};
+    returned.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(returned.data());
+    stream.avail_out = static_cast<uInt>(returned.size());
+    deflate(&stream, Z_FINISH);
+    returned.resize(static_cast<int>(stream.total_out));
+    deflateEnd(&stream);
+    return returned;
+}
+
+static QByteArray makeTimeline(int count)
+{
+    QByteArray returned {"["};
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            returned.append(',');
+        }
+        returned.append(R"({"id_str": ")" + QByteArray::number(i) + R"(", "text": "Hello world"})");
+    }
+    returned.append(']');
+    return returned;
+}
+
+TEST(gzipdevice, IsCompressed)
+{
+    EXPECT_TRUE(GzipDevice::isCompressed(compress("[]")));
+    EXPECT_FALSE(GzipDevice::isCompressed("[]"));
+    EXPECT_FALSE(GzipDevice::isCompressed(QByteArray()));
+}
+
+TEST(gzipdevice, Decompress)
+{
+    const QByteArray &data {makeTimeline(10)};
+    const QByteArray &compressed {compress(data)};
+    EXPECT_EQ(data, GzipDevice::decompress(compressed));
+    EXPECT_EQ(data.size(), GzipDevice::decompressedSize(compressed));
+
+    // Uncompressed data is returned as is
+    EXPECT_EQ(data, GzipDevice::decompress(data));
+    EXPECT_EQ(-1, GzipDevice::decompressedSize(data));
+}
+
+TEST(gzipdevice, ParseByChunks)
+{
+    // The decompressed data is several times larger than a chunk
+    const QByteArray &data {makeTimeline(5000)};
+    const QByteArray &compressed {compress(data)};
+    EXPECT_GT(data.size(), 4 * GzipDevice::ChunkSize);
+    EXPECT_LT(compressed.size(), data.size());
+
+    QBuffer buffer {};
+    buffer.setData(compressed);
+    buffer.open(QIODevice::ReadOnly);
+    GzipDevice device {buffer};
+    ASSERT_TRUE(device.open(QIODevice::ReadOnly));
+
+    JsonReader reader {device};
+    ASSERT_TRUE(reader.beginArray());
+    int count {0};
+    while (reader.hasNext()) {
+        ASSERT_TRUE(reader.beginObject());
+        while (reader.nextName()) {
+            if (reader.name() == "id_str") {
+                EXPECT_EQ(QString::number(count), reader.readString());
+            } else {
+                reader.skipValue();
+            }
+        }
+        ++count;
+    }
+    EXPECT_FALSE(reader.hasError());
+    EXPECT_EQ(5000, count);
+    EXPECT_TRUE(device.atEnd());
+}
+
+TEST(gzipdevice, Truncated)
+{
+    const QByteArray &compressed {compress(makeTimeline(100))};
+    QBuffer buffer {};
+    buffer.setData(compressed.left(compressed.size() / 2));
+    buffer.open(QIODevice::ReadOnly);
+    GzipDevice device {buffer};
+    ASSERT_TRUE(device.open(QIODevice::ReadOnly));
+
+    JsonReader reader {device};
+    reader.skipValue();
+    EXPECT_TRUE(reader.hasError());
+    EXPECT_TRUE(device.atEnd());
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QBuffer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <private/jsonreader.h>
+#include <tweet.h>
+
+using private_util::JsonReader;
+
+static const char *TWEET_JSON = R"({
+    "created_at": "Wed Aug 27 13:08:45 +0000 2008",
+    "id_str": "200",
+    "text": "RT @b: Hello é 😀 \"world\" #tag https://t.co/a",
+    "source": "<a href=\"http://example.com\">Client</a>",
+    "favorite_count": 1,
+    "favorited": false,
+    "retweet_count": 2,
+    "retweeted": true,
+    "in_reply_to_status_id": null,
+    "user": {"id_str": "1", "name": "A", "screen_name": "a", "statuses_count": 10},
+    "retweeted_status": {
+        "created_at": "Tue Aug 26 13:08:45 +0000 2008",
+        "id_str": "100",
+        "text": "Hello é 😀 \"world\" #tag https://t.co/a",
+        "favorite_count": 3,
+        "favorited": true,
+        "retweet_count": 4.5,
+        "retweeted": false,
+        "user": {
+            "id_str": "2", "name": "B", "screen_name": "b", "protected": true,
+            "entities": {"description": {"urls": []}, "url": {"urls": [
+                {"url": "https://t.co/u", "display_url": "u.com", "expanded_url": "http://u.com"}
+            ]}}
+        },
+        "entities": {
+            "hashtags": [{"text": "tag", "indices": [10, 14]}],
+            "urls": [{"url": "https://t.co/a", "display_url": "a.com", "expanded_url": "http://a.com"}],
+            "user_mentions": [{"id_str": "3", "name": "C", "screen_name": "c"}],
+            "media": [{"id_str": "4", "url": "https://t.co/a", "display_url": "pic", "expanded_url": "http://pic",
+                       "media_url_https": "https://pbs/a.jpg", "type": "photo",
+                       "sizes": {"small": {"w": 1, "h": 1}, "large": {"w": 640, "h": 480}}}]
+        },
+        "extended_entities": {
+            "media": [{"id_str": "5", "url": "https://t.co/a", "display_url": "pic", "expanded_url": "http://pic",
+                       "media_url_https": "https://pbs/b.mp4", "type": "video", "duration_millis": 1000,
+                       "sizes": {"large": {"w": 1280, "h": 720}}}]
+        },
+        "quoted_status": {"id_str": "50", "text": "Quoted", "user": {"id_str": "6", "screen_name": "f"}}
+    }
+})";
+
+static void compareUsers(const User &expected, const User &user)
+{
+    EXPECT_EQ(expected.id(), user.id());
+    EXPECT_EQ(expected.name(), user.name());
+    EXPECT_EQ(expected.screenName(), user.screenName());
+    EXPECT_EQ(expected.isProtected(), user.isProtected());
+    EXPECT_EQ(expected.statusesCount(), user.statusesCount());
+    EXPECT_EQ(expected.createdAt(), user.createdAt());
+    EXPECT_EQ(expected.descriptionEntities().size(), user.descriptionEntities().size());
+    EXPECT_EQ(expected.urlEntities().size(), user.urlEntities().size());
+}
+
+static void compareTweets(const Tweet &expected, const Tweet &tweet)
+{
+    EXPECT_EQ(expected.id(), tweet.id());
+    EXPECT_EQ(expected.originalId(), tweet.originalId());
+    EXPECT_EQ(expected.text(), tweet.text());
+    EXPECT_EQ(expected.source(), tweet.source());
+    EXPECT_EQ(expected.timestamp(), tweet.timestamp());
+    EXPECT_EQ(expected.favoriteCount(), tweet.favoriteCount());
+    EXPECT_EQ(expected.isFavorited(), tweet.isFavorited());
+    EXPECT_EQ(expected.retweetCount(), tweet.retweetCount());
+    EXPECT_EQ(expected.isRetweeted(), tweet.isRetweeted());
+    EXPECT_EQ(expected.inReplyTo(), tweet.inReplyTo());
+    compareUsers(expected.user(), tweet.user());
+    compareUsers(expected.retweetingUser(), tweet.retweetingUser());
+    EXPECT_EQ(expected.quotedStatus().id(), tweet.quotedStatus().id());
+    EXPECT_EQ(expected.quotedStatus().user().id(), tweet.quotedStatus().user().id());
+
+    const Entity::List &expectedEntities (expected.entities());
+    const Entity::List &entities (tweet.entities());
+    ASSERT_EQ(expectedEntities.size(), entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        EXPECT_EQ(expectedEntities[i]->text(), entities[i]->text());
+        EXPECT_EQ(expectedEntities[i]->isValid(), entities[i]->isValid());
+    }
+}
+
+TEST(jsonreader, Values)
+{
+    JsonReader reader {QByteArray(R"({"a": 1, "b": [true, false, null], "c": "A\n", "d": -1.5e2, "e": {}})")};
+    ASSERT_TRUE(reader.beginObject());
+    ASSERT_TRUE(reader.nextName());
+    EXPECT_EQ(QByteArray("a"), reader.name());
+    EXPECT_EQ(1, reader.readInt());
+    ASSERT_TRUE(reader.nextName());
+    EXPECT_EQ(QByteArray("b"), reader.name());
+    ASSERT_TRUE(reader.beginArray());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_TRUE(reader.readBool());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_FALSE(reader.readBool());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_EQ(JsonReader::Null, reader.peek());
+    reader.skipValue();
+    EXPECT_FALSE(reader.hasNext());
+    ASSERT_TRUE(reader.nextName());
+    EXPECT_EQ(QString(QLatin1String("A\n")), reader.readString());
+    ASSERT_TRUE(reader.nextName());
+    EXPECT_EQ(-150., reader.readDouble());
+    ASSERT_TRUE(reader.nextName());
+    EXPECT_EQ(JsonReader::Object, reader.peek());
+    reader.skipValue();
+    EXPECT_FALSE(reader.nextName());
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST(jsonreader, Mismatch)
+{
+    // Values of the wrong type are skipped, like with QJsonValue
+    JsonReader reader {QByteArray(R"([{"a": [1, 2]}, "text", 1.5])")};
+    ASSERT_TRUE(reader.beginArray());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_TRUE(reader.readString().isNull());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_FALSE(reader.beginObject());
+    ASSERT_TRUE(reader.hasNext());
+    EXPECT_EQ(0, reader.readInt());
+    EXPECT_FALSE(reader.hasNext());
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST(jsonreader, Error)
+{
+    {
+        JsonReader reader {QByteArray(R"([{"a": 1)")};
+        ASSERT_TRUE(reader.beginArray());
+        ASSERT_TRUE(reader.hasNext());
+        reader.skipValue();
+        EXPECT_TRUE(reader.hasError());
+        EXPECT_FALSE(reader.hasNext());
+    }
+    {
+        JsonReader reader {QByteArray(R"({"a": tru})")};
+        ASSERT_TRUE(reader.beginObject());
+        ASSERT_TRUE(reader.nextName());
+        EXPECT_FALSE(reader.readBool());
+        EXPECT_TRUE(reader.hasError());
+        EXPECT_FALSE(reader.errorString().isEmpty());
+    }
+}
+
+TEST(jsonreader, Tweet)
+{
+    const QByteArray data {TWEET_JSON};
+    Tweet expected {QJsonDocument::fromJson(data).object()};
+    ASSERT_TRUE(expected.isValid());
+
+    JsonReader reader {data};
+    Tweet tweet {reader};
+    EXPECT_FALSE(reader.hasError());
+    compareTweets(expected, tweet);
+
+    EXPECT_EQ(TwitterId(100), tweet.originalId());
+    EXPECT_EQ(TwitterId(1), tweet.retweetingUser().id());
+    EXPECT_EQ(3, tweet.favoriteCount());
+    EXPECT_EQ(0, tweet.retweetCount());
+}
+
+TEST(jsonreader, Chunks)
+{
+    // Build a timeline that is larger than a chunk, so that
+    // values are split between two reads
+    QByteArray data {"["};
+    for (int i = 0; i < 100; ++i) {
+        if (i != 0) {
+            data.append(",\n");
+        }
+        data.append(TWEET_JSON);
+    }
+    data.append("]");
+
+    QJsonArray expected {QJsonDocument::fromJson(data).array()};
+    ASSERT_EQ(100, expected.size());
+
+    QBuffer buffer {&data};
+    buffer.open(QIODevice::ReadOnly);
+    JsonReader reader {buffer};
+    int count {0};
+    ASSERT_TRUE(reader.beginArray());
+    while (reader.hasNext()) {
+        Tweet tweet {reader};
+        compareTweets(Tweet(expected.at(count).toObject()), tweet);
+        ++count;
+    }
+    EXPECT_FALSE(reader.hasError());
+    EXPECT_EQ(100, count);
+}
@@ -30,6 +30,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QPointer>
+#include <QtTest/QSignalSpy>
 #include "testmodel.h"
 
 TEST(repository, Move)
@@ -170,3 +173,107 @@ TEST(model, LocalMove)
     EXPECT_EQ(getValue(model, 3), 0);
     model.endMove();
 }
+
+static TestDataObject * getItem(TestModel &model, int index)
+{
+    return model.data(model.index(index), TestModel::ItemRole).value<TestDataObject *>();
+}
+
+TEST(model, Lazy)
+{
+    TestRepositoryContainer container {};
+    for (int i = 0; i < 5; ++i) {
+        container.repository().append(TestData(i));
+    }
+
+    TestModel model {};
+    model.setLazy(true);
+    model.setMaximumObjectCount(4);
+    model.classBegin();
+    model.setRepository(&container);
+    model.componentComplete();
+    EXPECT_EQ(model.count(), 5);
+
+    QPointer<TestDataObject> first {getItem(model, 0)};
+    QPointer<TestDataObject> second {getItem(model, 1)};
+    QPointer<TestDataObject> third {getItem(model, 2)};
+    EXPECT_EQ(getItem(model, 0), first.data());
+    EXPECT_EQ(getItem(model, 1), second.data());
+    EXPECT_EQ(first->value(), 0);
+
+    // Going beyond the maximum releases the least recently used
+    // wrappers, keeping the 3 most recent ones, of the rows 1, 3 and 4
+    QPointer<TestDataObject> fourth {getItem(model, 3)};
+    QPointer<TestDataObject> fifth {getItem(model, 4)};
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    EXPECT_TRUE(first.isNull());
+    EXPECT_FALSE(second.isNull());
+    EXPECT_TRUE(third.isNull());
+    EXPECT_FALSE(fourth.isNull());
+    EXPECT_FALSE(fifth.isNull());
+
+    // Views are notified later that the released rows changed
+    QSignalSpy dataChangedSpy {&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>))};
+    ASSERT_TRUE(dataChangedSpy.wait());
+    ASSERT_EQ(dataChangedSpy.count(), 2);
+    EXPECT_EQ(dataChangedSpy.at(0).at(0).value<QModelIndex>().row(), 0);
+    EXPECT_EQ(dataChangedSpy.at(0).at(1).value<QModelIndex>().row(), 0);
+    EXPECT_EQ(dataChangedSpy.at(1).at(0).value<QModelIndex>().row(), 2);
+    EXPECT_EQ(dataChangedSpy.at(1).at(1).value<QModelIndex>().row(), 2);
+    EXPECT_EQ(getItem(model, 1), second.data());
+    EXPECT_EQ(getItem(model, 4), fifth.data());
+
+    // Released wrappers are created again when needed
+    EXPECT_EQ(getValue(model, 0), 0);
+    EXPECT_EQ(getValue(model, 2), 2);
+}
+
+TEST(model, Transaction)
+{
+    TestRepositoryContainer container {};
+    for (int i = 0; i < 6; ++i) {
+        container.repository().append(TestData(i));
+    }
+
+    TestModel model {};
+    model.classBegin();
+    model.setRepository(&container);
+    model.componentComplete();
+
+    QSignalSpy dataChangedSpy {&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>))};
+    {
+        TestRepository::Transaction transaction {container.repository()};
+        container.repository().update(1, TestData(10));
+        container.repository().update(2, TestData(20));
+        container.repository().update(1, TestData(11));
+        container.repository().update(4, TestData(40));
+        EXPECT_EQ(dataChangedSpy.count(), 0);
+    }
+
+    // Contiguous rows are merged, and rows are changed once
+    ASSERT_EQ(dataChangedSpy.count(), 2);
+    EXPECT_EQ(dataChangedSpy.at(0).at(0).value<QModelIndex>().row(), 1);
+    EXPECT_EQ(dataChangedSpy.at(0).at(1).value<QModelIndex>().row(), 2);
+    EXPECT_EQ(dataChangedSpy.at(1).at(0).value<QModelIndex>().row(), 4);
+    EXPECT_EQ(dataChangedSpy.at(1).at(1).value<QModelIndex>().row(), 4);
+    EXPECT_EQ(getValue(model, 1), 11);
+    EXPECT_EQ(getValue(model, 2), 20);
+    EXPECT_EQ(getValue(model, 4), 40);
+
+    QSignalSpy rowsRemovedSpy {&model, SIGNAL(rowsRemoved(QModelIndex,int,int))};
+    {
+        TestRepository::Transaction transaction {container.repository()};
+        container.repository().remove(3);
+        container.repository().remove(3);
+        container.repository().remove(2);
+        EXPECT_EQ(rowsRemovedSpy.count(), 0);
+    }
+
+    ASSERT_EQ(rowsRemovedSpy.count(), 1);
+    EXPECT_EQ(rowsRemovedSpy.at(0).at(1).toInt(), 2);
+    EXPECT_EQ(rowsRemovedSpy.at(0).at(2).toInt(), 4);
+    EXPECT_EQ(model.count(), 3);
+    EXPECT_EQ(getValue(model, 0), 0);
+    EXPECT_EQ(getValue(model, 1), 11);
+    EXPECT_EQ(getValue(model, 2), 5);
+}
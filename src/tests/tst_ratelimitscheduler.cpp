@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <QtCore/QTemporaryDir>
+#include <account.h>
+#include <private/cachingqueryexecutor.h>
+#include <private/ratelimitscheduler.h>
+#include <private/sharedqueryexecutor.h>
+
+// A reply carrying the rate limit headers
+class RateLimitedReply: public QNetworkReply
+{
+public:
+    explicit RateLimitedReply(int limit, int remaining, qint64 reset, const QByteArray &etag = QByteArray())
+    {
+        if (!etag.isEmpty()) {
+            setRawHeader("ETag", etag);
+        }
+        if (limit > 0) {
+            setRawHeader("x-rate-limit-limit", QByteArray::number(limit));
+            setRawHeader("x-rate-limit-remaining", QByteArray::number(remaining));
+            setRawHeader("x-rate-limit-reset", QByteArray::number(reset));
+        }
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, remaining >= 0 ? 200 : 429);
+        open(QIODevice::ReadOnly);
+    }
+    void abort() override
+    {
+    }
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+};
+
+// Answers immediately, and counts the requests like Twitter
+class RateLimitedQueryExecutor: public IQueryExecutor
+{
+public:
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        execute(type, path, parameters, {}, account, callback);
+    }
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const std::map<QByteArray, QByteArray> &headers,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        paths.push_back(path);
+        sentHeaders.push_back(headers);
+        if (type == Query::Get) {
+            --remaining;
+        }
+        RateLimitedReply reply {limit, remaining, reset, etag};
+        callback(reply, remaining >= 0 ? QNetworkReply::NoError : QNetworkReply::UnknownContentError, QString());
+    }
+    int limit {0};
+    mutable int remaining {0};
+    qint64 reset {0};
+    QByteArray etag {};
+    mutable std::vector<QByteArray> paths {};
+    mutable std::vector<std::map<QByteArray, QByteArray>> sentHeaders {};
+};
+
+class ratelimitscheduler: public testing::Test
+{
+public:
+    explicit ratelimitscheduler()
+        : account(QLatin1String("test"), QLatin1String("1"), QLatin1String("test"), QByteArray("token"), QByteArray())
+    {
+        queryExecutor = new RateLimitedQueryExecutor();
+        scheduler.reset(new private_util::RateLimitScheduler(IQueryExecutor::ConstPtr(queryExecutor), [this]() {
+            return now;
+        }));
+    }
+protected:
+    void setLimit(int limit)
+    {
+        queryExecutor->limit = limit;
+        queryExecutor->remaining = limit;
+        queryExecutor->reset = now / 1000 + 15 * 60;
+    }
+    void execute(Query::RequestType type, const QByteArray &path,
+                 const std::map<QByteArray, QByteArray> &parameters = {})
+    {
+        scheduler->execute(type, path, parameters, account,
+                           [](QIODevice &, QNetworkReply::NetworkError, const QString &) {});
+    }
+    qint64 now {1000000000};
+    RateLimitedQueryExecutor *queryExecutor {nullptr};
+    std::unique_ptr<private_util::RateLimitScheduler> scheduler {};
+    Account account;
+};
+
+TEST_F(ratelimitscheduler, UnknownLimits)
+{
+    for (int i = 0; i < 20; ++i) {
+        execute(Query::Get, "statuses/home_timeline.json");
+    }
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(20));
+    EXPECT_TRUE(scheduler->limits().empty());
+}
+
+TEST_F(ratelimitscheduler, ReserveForHighPriority)
+{
+    setLimit(10);
+    for (int i = 0; i < 10; ++i) {
+        execute(Query::Get, "statuses/home_timeline.json");
+    }
+    // 2 requests are reserved
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(8));
+    std::vector<private_util::RateLimitScheduler::Limit> limits {scheduler->limits()};
+    ASSERT_EQ(limits.size(), static_cast<std::size_t>(1));
+    EXPECT_EQ(limits[0].path, QByteArray("statuses/home_timeline.json"));
+    EXPECT_EQ(limits[0].limit, 10);
+    EXPECT_EQ(limits[0].remaining, 2);
+    EXPECT_EQ(limits[0].queued, 2);
+
+    // Visible columns can use them
+    scheduler->setHighPriority(account, Query(Query::Get, "statuses/home_timeline.json", {{"count", "200"}}), true);
+    execute(Query::Get, "statuses/home_timeline.json", {{"count", "200"}, {"since_id", "1"}});
+    execute(Query::Get, "statuses/home_timeline.json", {{"count", "200"}});
+    execute(Query::Get, "statuses/home_timeline.json", {{"count", "200"}});
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(10));
+    EXPECT_EQ(scheduler->limits()[0].queued, 3);
+
+    // Other endpoints are not limited
+    execute(Query::Get, "statuses/mentions_timeline.json");
+    EXPECT_EQ(queryExecutor->paths.back(), QByteArray("statuses/mentions_timeline.json"));
+}
+
+TEST_F(ratelimitscheduler, QueueUntilReset)
+{
+    setLimit(5);
+    for (int i = 0; i < 6; ++i) {
+        execute(Query::Get, "statuses/home_timeline.json");
+    }
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(4));
+
+    // Queued requests are not sent before the reset
+    scheduler->processQueue();
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(4));
+
+    now += 15 * 60 * 1000;
+    setLimit(5);
+    scheduler->processQueue();
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(6));
+    EXPECT_EQ(scheduler->limits()[0].queued, 0);
+}
+
+TEST_F(ratelimitscheduler, TooManyRequests)
+{
+    setLimit(10);
+    execute(Query::Get, "statuses/home_timeline.json");
+    // Other clients used the remaining requests
+    queryExecutor->remaining = 0;
+    execute(Query::Get, "statuses/home_timeline.json");
+    EXPECT_EQ(scheduler->limits()[0].remaining, 0);
+
+    scheduler->setHighPriority(account, Query(Query::Get, "statuses/home_timeline.json", {}), true);
+    execute(Query::Get, "statuses/home_timeline.json");
+    EXPECT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(2));
+}
+
+TEST_F(ratelimitscheduler, PostAreNotLimited)
+{
+    setLimit(1);
+    execute(Query::Get, "statuses/home_timeline.json");
+    execute(Query::Get, "statuses/home_timeline.json");
+    execute(Query::Post, "statuses/update.json", {{"status", "test"}});
+    ASSERT_EQ(queryExecutor->paths.size(), static_cast<std::size_t>(2));
+    EXPECT_EQ(queryExecutor->paths.back(), QByteArray("statuses/update.json"));
+}
+
+TEST_F(ratelimitscheduler, ForwardHeaders)
+{
+    // The conditional requests of the cache go through the scheduler
+    QTemporaryDir dir {};
+    ASSERT_TRUE(dir.isValid());
+    RateLimitedQueryExecutor *transport {new RateLimitedQueryExecutor()};
+    transport->remaining = 10;
+    transport->etag = QByteArray("\"1\"");
+    std::shared_ptr<private_util::RateLimitScheduler> sharedScheduler {
+        std::make_shared<private_util::RateLimitScheduler>(IQueryExecutor::ConstPtr(transport), [this]() {
+            return now;
+        })
+    };
+    IQueryExecutor::ConstPtr caching {
+        private_util::CachingQueryExecutor::create(private_util::SharedQueryExecutor::create(sharedScheduler),
+                                                   dir.path(), private_util::CachingQueryExecutor::DefaultMaximumSize,
+                                                   [this]() { return now; })
+    };
+
+    auto callback = [](QIODevice &, QNetworkReply::NetworkError, const QString &) {};
+    caching->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, callback);
+    now += 2 * private_util::CachingQueryExecutor::defaultTimeToLive("users/show.json") * 1000;
+    caching->execute(Query::Get, "users/show.json", {{"user_id", "1"}}, account, callback);
+
+    ASSERT_EQ(transport->sentHeaders.size(), static_cast<std::size_t>(2));
+    EXPECT_TRUE(transport->sentHeaders.at(0).empty());
+    ASSERT_EQ(transport->sentHeaders.at(1).count("If-None-Match"), static_cast<std::size_t>(1));
+    EXPECT_EQ(transport->sentHeaders.at(1).at("If-None-Match"), QByteArray("\"1\""));
+}
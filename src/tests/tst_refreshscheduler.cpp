@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <tweetrepositorycontainer.h>
+#include <private/refreshscheduler.h>
+#include "mockqueryexecutor.h"
+
+using testing::Return;
+using testing::_;
+
+static const QByteArray HOME_PATH {"statuses/home_timeline.json"};
+static const QByteArray MENTIONS_PATH {"statuses/mentions_timeline.json"};
+
+// A reply with the tweets from last to first
+static QByteArray makeTweets(int first, int last)
+{
+    QByteArray returned {"["};
+    for (int i = last; i >= first; --i) {
+        returned.append(R"({"id_str": ")").append(QByteArray::number(i)).append("\"}");
+        if (i > first) {
+            returned.append(", ");
+        }
+    }
+    returned.append("]");
+    return returned;
+}
+
+class refreshscheduler: public testing::Test
+{
+public:
+    explicit refreshscheduler()
+        : account(QLatin1String("test"), QLatin1String("test"), QLatin1String("test"),
+                  QByteArray("test"), QByteArray("test"))
+        , home(TweetRepositoryQuery::Home, Query::Parameters())
+        , mentions(TweetRepositoryQuery::Mentions, Query::Parameters())
+    {
+        queryExecutor = new MockQueryExecutor();
+        container.reset(new TweetRepositoryContainer(IQueryExecutor::ConstPtr(queryExecutor)));
+        container->referenceQuery(account, home);
+        container->referenceQuery(account, mentions);
+        scheduler.reset(new private_util::RefreshScheduler(*container, [this]() {
+            return now;
+        }));
+        EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+        EXPECT_CALL(*queryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    }
+protected:
+    void wait(int seconds)
+    {
+        now += seconds * 1000LL;
+        scheduler->processTimelines();
+    }
+    qint64 now {1000000000};
+    MockQueryExecutor *queryExecutor {nullptr};
+    std::unique_ptr<TweetRepositoryContainer> container {};
+    std::unique_ptr<private_util::RefreshScheduler> scheduler {};
+    Account account;
+    TweetRepositoryQuery home;
+    TweetRepositoryQuery mentions;
+};
+
+TEST_F(refreshscheduler, AdaptiveInterval)
+{
+    scheduler->setQueries(account, {home, mentions});
+    scheduler->setOnline(true);
+    EXPECT_EQ(scheduler->interval(account, home), private_util::RefreshScheduler::DefaultInterval);
+    EXPECT_EQ(scheduler->nextRefresh(account, home), now + private_util::RefreshScheduler::DefaultInterval * 1000LL);
+
+    // The home timeline receives 80 tweets in 2 minutes,
+    // while the mentions stay quiet
+    EXPECT_CALL(*queryExecutor, makeReply(HOME_PATH, _, _)).Times(2)
+            .WillOnce(Return(makeTweets(1, 1))).WillOnce(Return(makeTweets(2, 81)));
+    EXPECT_CALL(*queryExecutor, makeReply(MENTIONS_PATH, _, _)).Times(2)
+            .WillOnce(Return(makeTweets(1, 1))).WillOnce(Return(QByteArray("[]")));
+    wait(private_util::RefreshScheduler::DefaultInterval);
+    wait(private_util::RefreshScheduler::DefaultInterval);
+    EXPECT_EQ(scheduler->interval(account, home), private_util::RefreshScheduler::MinimumInterval);
+    EXPECT_EQ(scheduler->nextRefresh(account, home), now + private_util::RefreshScheduler::MinimumInterval * 1000LL);
+    EXPECT_EQ(scheduler->interval(account, mentions), private_util::RefreshScheduler::MaximumInterval);
+
+    // Visible timelines are refreshed more often
+    scheduler->setVisible(account, mentions, true);
+    EXPECT_EQ(scheduler->interval(account, mentions), private_util::RefreshScheduler::MaximumVisibleInterval);
+    EXPECT_EQ(scheduler->nextRefresh(account, mentions), now + private_util::RefreshScheduler::MaximumVisibleInterval * 1000LL);
+}
+
+TEST_F(refreshscheduler, Backoff)
+{
+    scheduler->setQueries(account, {home});
+    scheduler->setOnline(true);
+
+    // Each failure doubles the delay before the next refresh
+    EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::ContentAccessDenied));
+    EXPECT_CALL(*queryExecutor, makeReply(HOME_PATH, _, _)).Times(6)
+            .WillRepeatedly(Return(QByteArray(R"({"errors": [{"code": 88, "message": "Rate limit exceeded"}]})")));
+    int delay {private_util::RefreshScheduler::DefaultInterval};
+    for (int i = 0; i < 6; ++i) {
+        wait(delay);
+        delay = std::min(delay * 2, static_cast<int>(private_util::RefreshScheduler::MaximumBackoff));
+        EXPECT_EQ(scheduler->nextRefresh(account, home), now + delay * 1000LL);
+    }
+    EXPECT_EQ(delay, private_util::RefreshScheduler::MaximumBackoff);
+
+    // Until a refresh succeeds
+    EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*queryExecutor, makeReply(HOME_PATH, _, _)).Times(1).WillOnce(Return(QByteArray("[]")));
+    wait(delay);
+    EXPECT_EQ(scheduler->nextRefresh(account, home), now + private_util::RefreshScheduler::DefaultInterval * 1000LL);
+}
+
+TEST_F(refreshscheduler, Pause)
+{
+    scheduler->setQueries(account, {home, mentions});
+    scheduler->setOnline(true);
+    EXPECT_CALL(*queryExecutor, makeReply(_, _, _)).Times(2).WillRepeatedly(Return(QByteArray("[]")));
+    wait(private_util::RefreshScheduler::DefaultInterval);
+
+    // The mentions are refreshed by the user
+    now += 60 * 1000;
+    EXPECT_CALL(*queryExecutor, makeReply(MENTIONS_PATH, _, _)).Times(1).WillOnce(Return(QByteArray("[]")));
+    container->refresh(account, mentions);
+
+    // Nothing is refreshed in the background or offline
+    scheduler->setActive(false);
+    EXPECT_FALSE(scheduler->isRunning());
+    wait(private_util::RefreshScheduler::DefaultInterval);
+    scheduler->setOnline(false);
+    scheduler->setActive(true);
+    EXPECT_FALSE(scheduler->isRunning());
+    wait(private_util::RefreshScheduler::DefaultInterval);
+
+    // And only the stale timelines are refreshed when resuming
+    EXPECT_CALL(*queryExecutor, makeReply(HOME_PATH, _, _)).Times(1).WillOnce(Return(QByteArray("[]")));
+    scheduler->setOnline(true);
+    EXPECT_TRUE(scheduler->isRunning());
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <QtCore/QTemporaryDir>
+#include <account.h>
+#include <private/recordingqueryexecutor.h>
+#include <private/replayqueryexecutor.h>
+#include "mockqueryexecutor.h"
+
+using testing::Return;
+using testing::_;
+
+class replayqueryexecutor: public testing::Test
+{
+protected:
+    static QByteArray execute(const IQueryExecutor &executor, const QByteArray &path,
+                              const std::map<QByteArray, QByteArray> &parameters,
+                              QNetworkReply::NetworkError &error)
+    {
+        QByteArray returned {};
+        executor.execute(Query::Get, path, parameters, Account(),
+                         [&returned, &error](QIODevice &reply, QNetworkReply::NetworkError replyError,
+                                             const QString &) {
+            returned = reply.readAll();
+            error = replyError;
+        });
+        return returned;
+    }
+    QTemporaryDir dir {};
+};
+
+TEST_F(replayqueryexecutor, RecordAndReplay)
+{
+    ASSERT_TRUE(dir.isValid());
+    MockQueryExecutor *mockQueryExecutor {new MockQueryExecutor()};
+    EXPECT_CALL(*mockQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*mockQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*mockQueryExecutor, makeReply(QByteArray("statuses/home_timeline.json"), _, _))
+            .WillOnce(Return(QByteArray("[1]")))
+            .WillOnce(Return(QByteArray("[2]")));
+    IQueryExecutor::ConstPtr recording {private_util::RecordingQueryExecutor::create(IQueryExecutor::ConstPtr(mockQueryExecutor), dir.path())};
+
+    QNetworkReply::NetworkError error {QNetworkReply::UnknownNetworkError};
+    EXPECT_EQ(execute(*recording, "statuses/home_timeline.json", {{"count", "200"}}, error), QByteArray("[1]"));
+    EXPECT_EQ(error, QNetworkReply::NoError);
+    EXPECT_EQ(execute(*recording, "statuses/home_timeline.json", {{"count", "200"}, {"since_id", "1"}}, error),
+              QByteArray("[2]"));
+
+    // Queries are answered with the reply recorded for the same parameters,
+    // or with the last reply recorded for the same path
+    IQueryExecutor::ConstPtr replay {private_util::ReplayQueryExecutor::create(dir.path())};
+    EXPECT_EQ(execute(*replay, "statuses/home_timeline.json", {{"count", "200"}}, error), QByteArray("[1]"));
+    EXPECT_EQ(error, QNetworkReply::NoError);
+    EXPECT_EQ(execute(*replay, "statuses/home_timeline.json", {{"count", "200"}, {"since_id", "1"}}, error),
+              QByteArray("[2]"));
+    EXPECT_EQ(execute(*replay, "statuses/home_timeline.json", {{"count", "200"}, {"since_id", "2"}}, error),
+              QByteArray("[2]"));
+}
+
+TEST_F(replayqueryexecutor, ErrorsAreNotRecorded)
+{
+    ASSERT_TRUE(dir.isValid());
+    MockQueryExecutor *mockQueryExecutor {new MockQueryExecutor()};
+    EXPECT_CALL(*mockQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::ContentAccessDenied));
+    EXPECT_CALL(*mockQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*mockQueryExecutor, makeReply(_, _, _)).WillRepeatedly(Return(QByteArray("{}")));
+    IQueryExecutor::ConstPtr recording {private_util::RecordingQueryExecutor::create(IQueryExecutor::ConstPtr(mockQueryExecutor), dir.path())};
+
+    QNetworkReply::NetworkError error {QNetworkReply::NoError};
+    EXPECT_EQ(execute(*recording, "statuses/mentions_timeline.json", {}, error), QByteArray("{}"));
+    EXPECT_EQ(error, QNetworkReply::ContentAccessDenied);
+
+    IQueryExecutor::ConstPtr replay {private_util::ReplayQueryExecutor::create(dir.path())};
+    EXPECT_TRUE(execute(*replay, "statuses/mentions_timeline.json", {}, error).isEmpty());
+    EXPECT_EQ(error, QNetworkReply::ContentNotFoundError);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <private/repositoryindex.h>
+
+using private_util::RepositoryIndex;
+
+class Item
+{
+public:
+    explicit Item(const char *id) : m_id(QLatin1String(id)) {}
+    QString id() const
+    {
+        return m_id;
+    }
+private:
+    QString m_id {};
+};
+
+static std::vector<int> indexes(const RepositoryIndex<Item> &index, const char *id)
+{
+    return index.indexes(QLatin1String(id));
+}
+
+TEST(RepositoryIndex, AppendPrepend)
+{
+    Repository<Item> repository {};
+    repository.append(std::vector<Item>{Item("a"), Item("b")});
+    RepositoryIndex<Item> index {repository};
+    EXPECT_EQ(std::vector<int>{0}, indexes(index, "a"));
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "b"));
+    EXPECT_TRUE(indexes(index, "c").empty());
+
+    repository.prepend(std::vector<Item>{Item("c"), Item("d")});
+    repository.append(Item("e"));
+    repository.append(std::vector<Item>{Item("a")});
+    EXPECT_EQ(std::vector<int>{0}, indexes(index, "c"));
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "d"));
+    EXPECT_EQ((std::vector<int>{2, 5}), indexes(index, "a"));
+    EXPECT_EQ(std::vector<int>{3}, indexes(index, "b"));
+    EXPECT_EQ(std::vector<int>{4}, indexes(index, "e"));
+}
+
+TEST(RepositoryIndex, RemoveMoveUpdate)
+{
+    Repository<Item> repository {};
+    RepositoryIndex<Item> index {repository};
+    repository.prepend(std::vector<Item>{Item("a"), Item("b"), Item("c"), Item("d")});
+
+    repository.remove(1);
+    EXPECT_TRUE(indexes(index, "b").empty());
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "c"));
+    EXPECT_EQ(std::vector<int>{2}, indexes(index, "d"));
+
+    repository.move(0, 3);
+    EXPECT_EQ(std::vector<int>{2}, indexes(index, "a"));
+    EXPECT_EQ(std::vector<int>{0}, indexes(index, "c"));
+
+    repository.update(1, Item("e"));
+    EXPECT_TRUE(indexes(index, "d").empty());
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "e"));
+}
+
+TEST(RepositoryIndex, Trim)
+{
+    Repository<Item> repository {};
+    RepositoryIndex<Item> index {repository};
+    repository.setMaximumSize(2);
+    repository.append(std::vector<Item>{Item("a"), Item("b")});
+    repository.prepend(std::vector<Item>{Item("c")});
+    EXPECT_EQ(1, repository.trimBack());
+    EXPECT_TRUE(indexes(index, "b").empty());
+    EXPECT_EQ(std::vector<int>{0}, indexes(index, "c"));
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "a"));
+
+    repository.append(Item("d"));
+    EXPECT_EQ(1, repository.trimFront());
+    EXPECT_TRUE(indexes(index, "c").empty());
+    EXPECT_EQ(std::vector<int>{0}, indexes(index, "a"));
+    EXPECT_EQ(std::vector<int>{1}, indexes(index, "d"));
+}
+
+TEST(RepositoryIndex, Invalidation)
+{
+    std::unique_ptr<RepositoryIndex<Item>> index {};
+    {
+        Repository<Item> repository {};
+        repository.append(Item("a"));
+        index.reset(new RepositoryIndex<Item>(repository));
+        EXPECT_EQ(std::vector<int>{0}, indexes(*index, "a"));
+    }
+    EXPECT_TRUE(indexes(*index, "a").empty());
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QLocale>
+#include <private/timeutil.h>
+
+static QDateTime fromUtcWithLocale(const QString &timeUtc)
+{
+    QLocale locale (QLocale::English, QLocale::UnitedStates);
+    QDateTime utc {locale.toDateTime(timeUtc, QLatin1String("ddd MMM dd HH:mm:ss +0000 yyyy"))};
+    utc.setTimeSpec(Qt::UTC);
+    return utc;
+}
+
+TEST(timeutil, Parse)
+{
+    const QStringList timestamps {
+        QLatin1String("Wed Aug 27 13:08:45 +0000 2008"),
+        QLatin1String("Thu Jan 01 00:00:00 +0000 1970"),
+        QLatin1String("Tue Feb 29 23:59:59 +0000 2016"),
+        QLatin1String("Sun Dec 31 12:30:00 +0000 2017")
+    };
+    for (const QString &timestamp : timestamps) {
+        EXPECT_EQ(fromUtcWithLocale(timestamp).toMSecsSinceEpoch(), private_util::parseTimestamp(timestamp));
+        EXPECT_EQ(fromUtcWithLocale(timestamp), private_util::fromUtc(timestamp));
+    }
+
+    EXPECT_EQ(Q_INT64_C(1219842525000), private_util::parseTimestamp(QLatin1String("Wed Aug 27 15:08:45 +0200 2008")));
+}
+
+TEST(timeutil, Invalid)
+{
+    EXPECT_EQ(private_util::INVALID_TIMESTAMP, private_util::parseTimestamp(QString()));
+    EXPECT_EQ(private_util::INVALID_TIMESTAMP, private_util::parseTimestamp(QLatin1String("Wed Foo 27 13:08:45 +0000 2008")));
+    EXPECT_EQ(private_util::INVALID_TIMESTAMP, private_util::parseTimestamp(QLatin1String("Wed Aug 27 13:08:4a +0000 2008")));
+    EXPECT_EQ(private_util::INVALID_TIMESTAMP, private_util::parseTimestamp(QLatin1String("Wed Aug 27 25:08:45 +0000 2008")));
+    EXPECT_FALSE(private_util::toLocalTime(private_util::INVALID_TIMESTAMP).isValid());
+}
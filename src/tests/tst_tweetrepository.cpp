@@ -30,9 +30,13 @@
  */
 
 #include <gtest/gtest.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThreadPool>
 #include <tweetrepositorycontainer.h>
 #include "mockqueryexecutor.h"
 #include "testrepositorylistener.h"
@@ -56,6 +60,38 @@ static std::ostream & operator<<(std::ostream &os, const TestRepositoryListener<
     return os;
 }
 
+// Holds back the searches, like a rate limiter whose window is exhausted
+class ParkingQueryExecutor: public IQueryExecutor
+{
+public:
+    void execute(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                 const Account &account, const Callback_t &callback) const override
+    {
+        Q_UNUSED(type)
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        requests.push_back(path);
+        if (path == QByteArray("search/tweets.json")) {
+            parked.push_back(callback);
+            return;
+        }
+        QBuffer reply {};
+        reply.setData(QByteArray("[]"));
+        reply.open(QIODevice::ReadOnly);
+        callback(reply, QNetworkReply::NoError, QString());
+    }
+    bool isDeferred(Query::RequestType type, const QByteArray &path, const std::map<QByteArray, QByteArray> &parameters,
+                    const Account &account) const override
+    {
+        Q_UNUSED(type)
+        Q_UNUSED(parameters)
+        Q_UNUSED(account)
+        return path == QByteArray("search/tweets.json");
+    }
+    mutable std::vector<QByteArray> requests {};
+    mutable std::vector<Callback_t> parked {};
+};
+
 class tweetrepository: public testing::Test, protected TestRepositoryListener<Tweet>
 {
 public:
@@ -166,6 +202,28 @@ TEST_F(tweetrepository, RefDeref)
     repository->refresh();
 }
 
+TEST_F(tweetrepository, Accounts)
+{
+    // User ids that are not numbers are parsed to the same invalid id
+    Account first {QLatin1String("first"), QLatin1String("first"), QLatin1String("first"),
+                   QByteArray("first"), QByteArray("first")};
+    Account second {QLatin1String("second"), QLatin1String("second"), QLatin1String("second"),
+                    QByteArray("second"), QByteArray("second")};
+    TweetRepositoryQuery query {TweetRepositoryQuery::Home, Query::Parameters()};
+    repository->referenceQuery(first, query);
+    repository->referenceQuery(second, query);
+
+    TweetRepository *firstRepository {repository->repository(first, query)};
+    TweetRepository *secondRepository {repository->repository(second, query)};
+    EXPECT_TRUE(firstRepository != nullptr);
+    EXPECT_TRUE(secondRepository != nullptr);
+    EXPECT_TRUE(firstRepository != secondRepository);
+
+    repository->dereferenceQuery(first, query);
+    EXPECT_TRUE(repository->repository(first, query) == nullptr);
+    EXPECT_EQ(repository->referencedQueries(second).size(), 1);
+}
+
 TEST_F(tweetrepository, ErrorManagement)
 {
     // First send a network error
@@ -283,3 +341,268 @@ TEST_F(tweetrepository, ErrorManagement)
     EXPECT_EQ(data.at(7), Data(Data::createPrepend({QLatin1String("3"), QLatin1String("2")})));
     EXPECT_EQ(data.at(8), Data(Data::createIdle()));
 }
+
+TEST_F(tweetrepository, AsyncDecoding)
+{
+    QThreadPool threadPool {};
+    MockQueryExecutor *asyncQueryExecutor {new MockQueryExecutor()};
+    TweetRepositoryContainer asyncRepository {IQueryExecutor::ConstPtr(asyncQueryExecutor), &threadPool};
+
+    EXPECT_CALL(*asyncQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*asyncQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*asyncQueryExecutor, makeReply(_, _, _)).Times(2)
+            .WillRepeatedly(Return(QByteArray(R"([{"id_str": "2", "text": "Test text 2"},
+                                                  {"id_str": "1", "text": "Test text 1"}])")));
+
+    TweetRepositoryQuery query {TweetRepositoryQuery::Home, Query::Parameters()};
+    asyncRepository.referenceQuery(account, query);
+    TweetRepository *homeTimeline {asyncRepository.repository(account, query)};
+    ASSERT_TRUE(homeTimeline != nullptr);
+    homeTimeline->addListener(*this);
+
+    // Items are only placed once the decoding is done
+    // and the result is posted back, and loading again
+    // is not possible while decoding
+    asyncRepository.refresh();
+    asyncRepository.refresh();
+    EXPECT_EQ(data.size(), 1);
+    EXPECT_EQ(data.at(0), Data(Data::createLoading()));
+
+    threadPool.waitForDone();
+    QCoreApplication::sendPostedEvents();
+    EXPECT_EQ(data.size(), 3);
+    EXPECT_EQ(data.at(1), Data(Data::createPrepend({QLatin1String("2"), QLatin1String("1")})));
+    EXPECT_EQ(data.at(2), Data(Data::createIdle()));
+
+    // Results for a query that is removed while decoding are dropped
+    asyncRepository.refresh();
+    EXPECT_EQ(data.size(), 4);
+    homeTimeline->removeListener(*this);
+    asyncRepository.dereferenceQuery(account, query);
+    threadPool.waitForDone();
+    QCoreApplication::sendPostedEvents();
+    EXPECT_TRUE(asyncRepository.repository(account, query) == nullptr);
+    EXPECT_EQ(data.size(), 4);
+}
+
+TEST_F(tweetrepository, RefreshPriority)
+{
+    EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*queryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    {
+        testing::InSequence sequence {};
+        EXPECT_CALL(*queryExecutor, makeReply(QByteArray{"statuses/mentions_timeline.json"}, _, _))
+                .WillOnce(Return(QByteArray("[]")));
+        EXPECT_CALL(*queryExecutor, makeReply(QByteArray{"search/tweets.json"}, _, _))
+                .WillOnce(Return(QByteArray("{\"statuses\": []}")));
+        EXPECT_CALL(*queryExecutor, makeReply(QByteArray{"statuses/home_timeline.json"}, _, _))
+                .WillOnce(Return(QByteArray("[]")));
+    }
+
+    TweetRepositoryQuery home {TweetRepositoryQuery::Home, Query::Parameters()};
+    TweetRepositoryQuery mentions {TweetRepositoryQuery::Mentions, Query::Parameters()};
+    TweetRepositoryQuery search {TweetRepositoryQuery::Search, Query::Parameters{{"q", "test"}}};
+    repository->referenceQuery(account, home);
+    repository->referenceQuery(account, mentions);
+    repository->referenceQuery(account, search);
+
+    // Visible timelines first, then unread ones, then the others
+    repository->setRefreshPriority(account, mentions, TweetRepositoryContainer::Visible);
+    repository->setRefreshPriority(account, search, TweetRepositoryContainer::Unread);
+    repository->setMaximumConcurrentLoads(1);
+    repository->refresh();
+}
+
+TEST_F(tweetrepository, MaximumConcurrentLoads)
+{
+    QThreadPool threadPool {};
+    MockQueryExecutor *asyncQueryExecutor {new MockQueryExecutor()};
+    TweetRepositoryContainer asyncRepository {IQueryExecutor::ConstPtr(asyncQueryExecutor), &threadPool};
+    asyncRepository.setMaximumConcurrentLoads(2);
+
+    EXPECT_CALL(*asyncQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*asyncQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*asyncQueryExecutor, makeReply(_, _, _)).Times(2).WillRepeatedly(Return(QByteArray("[]")));
+
+    const std::vector<TweetRepositoryQuery> queries {
+        TweetRepositoryQuery {TweetRepositoryQuery::Home, Query::Parameters()},
+        TweetRepositoryQuery {TweetRepositoryQuery::Mentions, Query::Parameters()},
+        TweetRepositoryQuery {TweetRepositoryQuery::Favorites, Query::Parameters{{"user_id", "123"}}}
+    };
+    for (const TweetRepositoryQuery &query : queries) {
+        asyncRepository.referenceQuery(account, query);
+    }
+
+    // The last timeline is loaded once one of the others is decoded
+    asyncRepository.refresh();
+    testing::Mock::VerifyAndClearExpectations(asyncQueryExecutor);
+
+    EXPECT_CALL(*asyncQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*asyncQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*asyncQueryExecutor, makeReply(_, _, _)).Times(1).WillRepeatedly(Return(QByteArray("[]")));
+    threadPool.waitForDone();
+    QCoreApplication::sendPostedEvents();
+    threadPool.waitForDone();
+    QCoreApplication::sendPostedEvents();
+}
+
+TEST_F(tweetrepository, DeferredLoads)
+{
+    ParkingQueryExecutor *parkingQueryExecutor {new ParkingQueryExecutor()};
+    TweetRepositoryContainer parkingRepository {IQueryExecutor::ConstPtr(parkingQueryExecutor)};
+    parkingRepository.setMaximumConcurrentLoads(1);
+
+    TweetRepositoryQuery home {TweetRepositoryQuery::Home, Query::Parameters()};
+    TweetRepositoryQuery search1 {TweetRepositoryQuery::Search, Query::Parameters{{"q", "test1"}}};
+    TweetRepositoryQuery search2 {TweetRepositoryQuery::Search, Query::Parameters{{"q", "test2"}}};
+    parkingRepository.referenceQuery(account, home);
+    parkingRepository.referenceQuery(account, search1);
+    parkingRepository.referenceQuery(account, search2);
+    parkingRepository.setRefreshPriority(account, search1, TweetRepositoryContainer::Unread);
+    parkingRepository.setRefreshPriority(account, search2, TweetRepositoryContainer::Unread);
+
+    // The searches waiting for their rate limit do not hold the home timeline back
+    parkingRepository.refresh();
+    const std::vector<QByteArray> expected {
+        QByteArray("search/tweets.json"), QByteArray("search/tweets.json"),
+        QByteArray("statuses/home_timeline.json")
+    };
+    EXPECT_EQ(parkingQueryExecutor->requests, expected);
+    EXPECT_EQ(parkingQueryExecutor->parked.size(), static_cast<std::size_t>(2));
+}
+
+TEST_F(tweetrepository, Trim)
+{
+    repository->setMaximumSize(2);
+    EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*queryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*queryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}}, _))
+            .Times(1).WillOnce(Return(QByteArray(R"([{"id_str": "3"}, {"id_str": "2"}, {"id_str": "1"}])")));
+
+    TweetRepositoryQuery query {TweetRepositoryQuery::Home, Query::Parameters()};
+    repository->referenceQuery(account, query);
+    TweetRepository *homeTimeline {repository->repository(account, query)};
+    ASSERT_TRUE(homeTimeline != nullptr);
+    homeTimeline->addListener(*this);
+
+    // The oldest tweets are removed after a refresh
+    repository->refresh();
+    EXPECT_EQ(data.size(), 4);
+    EXPECT_EQ(data.at(1), Data(Data::createPrepend({QLatin1String("3"), QLatin1String("2"), QLatin1String("1")})));
+    EXPECT_EQ(data.at(2), Data(Data::createRemove(2)));
+    EXPECT_EQ(data.at(3), Data(Data::createIdle()));
+    ASSERT_EQ(homeTimeline->size(), 2);
+
+    // And are loaded again when loading more, while the
+    // newest tweets are removed
+    EXPECT_CALL(*queryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}, {"max_id", "1"}}, _))
+            .Times(1).WillOnce(Return(QByteArray(R"([{"id_str": "1"}])")));
+    repository->loadMore(account, query);
+    EXPECT_EQ(data.size(), 8);
+    EXPECT_EQ(data.at(5), Data(Data::createAppend({QLatin1String("1")})));
+    EXPECT_EQ(data.at(6), Data(Data::createRemove(0)));
+    ASSERT_EQ(homeTimeline->size(), 2);
+    EXPECT_EQ(std::begin(*homeTimeline)->id(), TwitterId(2));
+
+    // So refreshing loads them again
+    EXPECT_CALL(*queryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}, {"since_id", "2"}}, _))
+            .Times(1).WillOnce(Return(QByteArray("[]")));
+    repository->refresh();
+    homeTimeline->removeListener(*this);
+}
+
+TEST_F(tweetrepository, Stream)
+{
+    EXPECT_CALL(*queryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*queryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*queryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}}, _))
+            .Times(1).WillOnce(Return(QByteArray(R"([{"id_str": "2"}, {"id_str": "1"}])")));
+
+    TweetRepositoryQuery query {TweetRepositoryQuery::Home, Query::Parameters()};
+    repository->referenceQuery(account, query);
+    TweetRepository *homeTimeline {repository->repository(account, query)};
+    ASSERT_TRUE(homeTimeline != nullptr);
+    repository->refresh();
+    ASSERT_EQ(homeTimeline->size(), 2);
+
+    // Streams send the oldest tweets first, and tweets
+    // that were already loaded are not inserted again
+    std::vector<Tweet> tweets {};
+    for (const char *id : {"2", "3", "4"}) {
+        QJsonObject object {};
+        object.insert(QLatin1String("id_str"), QLatin1String(id));
+        tweets.emplace_back(object);
+    }
+    repository->ingest(account, query, tweets);
+    ASSERT_EQ(homeTimeline->size(), 4);
+    EXPECT_EQ(std::begin(*homeTimeline)->id(), TwitterId(4));
+    EXPECT_EQ((std::begin(*homeTimeline) + 1)->id(), TwitterId(3));
+    EXPECT_EQ((std::begin(*homeTimeline) + 2)->id(), TwitterId(2));
+
+    // Streamed timelines are not polled, but can still be
+    // refreshed, from the last streamed tweet
+    repository->setStreamed(account, query, true);
+    repository->refresh();
+    EXPECT_CALL(*queryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}, {"since_id", "4"}}, _))
+            .Times(1).WillOnce(Return(QByteArray("[]")));
+    repository->refresh(account, query);
+}
+
+TEST_F(tweetrepository, Cache)
+{
+    QTemporaryDir dir {};
+    ASSERT_TRUE(dir.isValid());
+    TweetRepositoryQuery query {TweetRepositoryQuery::Home, Query::Parameters()};
+
+    {
+        MockQueryExecutor *cachedQueryExecutor {new MockQueryExecutor()};
+        TweetRepositoryContainer cachedRepository {IQueryExecutor::ConstPtr(cachedQueryExecutor)};
+        cachedRepository.setCache(TimelineCache(dir.path(), 2));
+
+        EXPECT_CALL(*cachedQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+        EXPECT_CALL(*cachedQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+        EXPECT_CALL(*cachedQueryExecutor, makeReply(_, _, _)).Times(1)
+                .WillOnce(Return(QByteArray(R"([{"id_str": "3", "text": "Test text 3", "entities": {"hashtags": [{"text": "test"}]}},
+                                                {"id_str": "2", "text": "Test text 2"},
+                                                {"id_str": "1", "text": "Test text 1"}])")));
+
+        cachedRepository.referenceQuery(account, query);
+        cachedRepository.refresh();
+        EXPECT_EQ(cachedRepository.repository(account, query)->size(), 3);
+
+        // Saves are delayed, and done at the latest when the container is destroyed
+        EXPECT_TRUE(QDir(dir.path()).entryList(QDir::Files).isEmpty());
+    }
+
+    // Only the most recent tweets are restored, and the
+    // next refresh only queries for newer tweets
+    MockQueryExecutor *cachedQueryExecutor {new MockQueryExecutor()};
+    TweetRepositoryContainer cachedRepository {IQueryExecutor::ConstPtr(cachedQueryExecutor)};
+    cachedRepository.setCache(TimelineCache(dir.path(), 2));
+
+    EXPECT_CALL(*cachedQueryExecutor, makeError(_, _, _)).WillRepeatedly(Return(QNetworkReply::NoError));
+    EXPECT_CALL(*cachedQueryExecutor, makeErrorMessage(_, _, _)).WillRepeatedly(Return(QString()));
+    EXPECT_CALL(*cachedQueryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}, {"since_id", "3"}}, _))
+            .Times(1).WillOnce(Return(QByteArray("[]")));
+    EXPECT_CALL(*cachedQueryExecutor, makeReply(_, Query::Parameters{{"count", "200"}, {"trim_user", "false"}, {"include_entities", "true"}, {"max_id", "1"}}, _))
+            .Times(1).WillOnce(Return(QByteArray("[]")));
+
+    cachedRepository.referenceQuery(account, query);
+    TweetRepository *homeTimeline {cachedRepository.repository(account, query)};
+    ASSERT_TRUE(homeTimeline != nullptr);
+    ASSERT_EQ(homeTimeline->size(), 2);
+    EXPECT_EQ(std::begin(*homeTimeline)->id(), TwitterId(3));
+    EXPECT_EQ(std::begin(*homeTimeline)->entities().size(), 1);
+    EXPECT_EQ((std::begin(*homeTimeline) + 1)->id(), TwitterId(2));
+    EXPECT_EQ(cachedRepository.tweet(TwitterId(2)).text(), QLatin1String("Test text 2"));
+
+    cachedRepository.refresh();
+    cachedRepository.loadMore(account, query);
+
+    // Removed timelines are removed from the cache
+    cachedRepository.dereferenceQuery(account, query);
+    EXPECT_TRUE(QDir(dir.path()).entryList(QDir::Files).isEmpty());
+
+    // And their tweets are evicted
+    EXPECT_FALSE(cachedRepository.tweet(TwitterId(2)).isValid());
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QJsonObject>
+#include <tweet.h>
+#include <tweetrepository.h>
+#include <tweetstore.h>
+
+static Tweet makeTweet(const QString &id, int favoriteCount)
+{
+    QJsonObject tweet {};
+    tweet.insert(QLatin1String("id_str"), id);
+    tweet.insert(QLatin1String("favorite_count"), favoriteCount);
+    return Tweet(tweet);
+}
+
+TEST(TweetStore, Sharing)
+{
+    Tweet tweet {makeTweet(QLatin1String("1"), 1)};
+    Tweet copy {tweet};
+    EXPECT_TRUE(copy.isSharedWith(tweet));
+
+    // Modifying a copy detaches it
+    copy.setFavorited(true);
+    EXPECT_FALSE(copy.isSharedWith(tweet));
+    EXPECT_TRUE(copy.isFavorited());
+    EXPECT_FALSE(tweet.isFavorited());
+    EXPECT_EQ(tweet.id(), copy.id());
+}
+
+TEST(TweetStore, Insert)
+{
+    TweetStore store {};
+    Tweet tweet {makeTweet(QLatin1String("1"), 1)};
+    EXPECT_FALSE(store.insert(tweet));
+    EXPECT_FALSE(store.insert(tweet));
+    EXPECT_FALSE(store.insert(Tweet()));
+    EXPECT_EQ(1, store.count());
+    EXPECT_TRUE(store.tweet(TwitterId(1)).isSharedWith(tweet));
+    EXPECT_FALSE(store.tweet(TwitterId(2)).isValid());
+
+    // A newer version replaces the stored one
+    Tweet newTweet {makeTweet(QLatin1String("1"), 2)};
+    EXPECT_TRUE(store.insert(newTweet));
+    EXPECT_EQ(1, store.count());
+    EXPECT_EQ(2, store.tweet(TwitterId(1)).favoriteCount());
+}
+
+TEST(TweetStore, Eviction)
+{
+    TweetStore store {};
+    {
+        TweetRepository home {};
+        TweetRepository mentions {};
+        Tweet tweet {makeTweet(QLatin1String("1"), 1)};
+        store.insert(tweet);
+        home.append(std::vector<Tweet>{tweet});
+        mentions.append(std::vector<Tweet>{tweet});
+        tweet = Tweet();
+        EXPECT_EQ(1, store.count());
+        EXPECT_TRUE((*std::begin(home)).isSharedWith(*std::begin(mentions)));
+    }
+    EXPECT_EQ(0, store.count());
+    EXPECT_FALSE(store.tweet(TwitterId(1)).isValid());
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <private/streamdispatcher.h>
+#include <private/tweetstream.h>
+
+using private_util::StreamDispatcher;
+using private_util::TweetStream;
+
+static Tweet makeTweet(const QByteArray &json)
+{
+    QByteArray buffer {json + "\r\n"};
+    std::vector<Tweet> tweets {TweetStream::readLines(buffer)};
+    return tweets.empty() ? Tweet() : tweets.front();
+}
+
+TEST(tweetstream, ReadLines)
+{
+    // Blank lines keep the connection alive, and other messages are ignored
+    QByteArray buffer {"\r\n{\"friends\": [1, 2]}\r\n{\"id_str\": \"1\", \"text\": \"a\"}\r\n"
+                       "{\"delete\": {\"status\": {\"id_str\": \"1\"}}}\r\n{\"id_str\": \"2\", \"te"};
+    std::vector<Tweet> tweets {TweetStream::readLines(buffer)};
+    ASSERT_EQ(tweets.size(), static_cast<std::size_t>(1));
+    EXPECT_EQ(tweets.at(0).id(), TwitterId(1));
+    EXPECT_EQ(tweets.at(0).text(), QString(QLatin1String("a")));
+
+    // The last line is read once it is complete
+    EXPECT_EQ(buffer, QByteArray("{\"id_str\": \"2\", \"te"));
+    buffer.append("xt\": \"b\"}\r\n");
+    tweets = TweetStream::readLines(buffer);
+    ASSERT_EQ(tweets.size(), static_cast<std::size_t>(1));
+    EXPECT_EQ(tweets.at(0).id(), TwitterId(2));
+    EXPECT_TRUE(buffer.isEmpty());
+
+    // Malformed lines are skipped
+    buffer = QByteArray("{\"id_str\": \r\n{\"id_str\": \"3\"}\n");
+    tweets = TweetStream::readLines(buffer);
+    ASSERT_EQ(tweets.size(), static_cast<std::size_t>(1));
+    EXPECT_EQ(tweets.at(0).id(), TwitterId(3));
+}
+
+TEST(tweetstream, Matches)
+{
+    Account account {QLatin1String("test"), QLatin1String("1"), QLatin1String("Someone"),
+                     QByteArray("token"), QByteArray("secret")};
+    TweetRepositoryQuery home {TweetRepositoryQuery::Home, Query::Parameters()};
+    TweetRepositoryQuery mentions {TweetRepositoryQuery::Mentions, Query::Parameters()};
+    TweetRepositoryQuery search {TweetRepositoryQuery::Search, Query::Parameters{{"q", "Qt release"}}};
+    TweetRepositoryQuery favorites {TweetRepositoryQuery::Favorites, Query::Parameters{{"user_id", "1"}}};
+    EXPECT_TRUE(StreamDispatcher::isStreamable(home));
+    EXPECT_TRUE(StreamDispatcher::isStreamable(mentions));
+    EXPECT_TRUE(StreamDispatcher::isStreamable(search));
+    EXPECT_FALSE(StreamDispatcher::isStreamable(favorites));
+
+    // Searches with operators are polled
+    for (const char *q : {"qt OR jolla", "qt -release", "from:someone", "\"qt release\"", "#qt"}) {
+        TweetRepositoryQuery operatorSearch {TweetRepositoryQuery::Search, Query::Parameters{{"q", q}}};
+        EXPECT_FALSE(StreamDispatcher::isStreamable(operatorSearch));
+    }
+
+    // Each tweet is a line of the stream
+    const Tweet &mention {makeTweet(R"({"id_str": "1", "text": "Hello @someone", "entities": )"
+                                    R"({"user_mentions": [{"id_str": "1", "screen_name": "someone", )"
+                                    R"("name": "Someone", "indices": [6, 14]}]}})")};
+    const Tweet &otherMention {makeTweet(R"({"id_str": "3", "text": "Hello @someoneelse", "entities": )"
+                                         R"({"user_mentions": [{"id_str": "2", "screen_name": "someoneelse", )"
+                                         R"("name": "Someone else", "indices": [6, 18]}]}})")};
+    const Tweet &release {makeTweet(R"({"id_str": "2", "text": "The new release of qt is out"})")};
+    EXPECT_TRUE(StreamDispatcher::matches(account, home, mention));
+    EXPECT_TRUE(StreamDispatcher::matches(account, home, release));
+    EXPECT_TRUE(StreamDispatcher::matches(account, mentions, mention));
+    // Mentions are matched with the id of the account, and not with its screen name
+    EXPECT_FALSE(StreamDispatcher::matches(account, mentions, otherMention));
+    EXPECT_FALSE(StreamDispatcher::matches(account, mentions, release));
+    // Every word of the search must be in the tweet
+    EXPECT_FALSE(StreamDispatcher::matches(account, search, mention));
+    EXPECT_TRUE(StreamDispatcher::matches(account, search, release));
+    EXPECT_FALSE(StreamDispatcher::matches(account, favorites, release));
+}
+
+TEST(tweetstream, Track)
+{
+    TweetRepositoryQuery home {TweetRepositoryQuery::Home, Query::Parameters()};
+    TweetRepositoryQuery first {TweetRepositoryQuery::Search, Query::Parameters{{"q", "qt  release"}}};
+    TweetRepositoryQuery second {TweetRepositoryQuery::Search, Query::Parameters{{"q", "sailfish,jolla"}}};
+    EXPECT_TRUE(StreamDispatcher::track({home}).isEmpty());
+    TweetRepositoryQuery third {TweetRepositoryQuery::Search, Query::Parameters{{"q", "qt OR jolla"}}};
+    EXPECT_EQ(StreamDispatcher::track({home, first, second, third}), QByteArray("qt release,sailfish jolla"));
+}
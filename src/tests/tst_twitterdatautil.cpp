@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+
+#include <gtest/gtest.h>
+#include <private/twitterdatautil.h>
+
+// Example of https://dev.twitter.com/oauth/overview/creating-signatures
+static const QByteArray CONSUMER_KEY {"xvz1evFS4wEEPTGEFPHBog"};
+static const QByteArray CONSUMER_SECRET {"kAcSOqF21Fu85e7zjz7ZN2U4ZRhfV3WpwPAoE3Z7kBw"};
+static const QByteArray TOKEN {"370773112-GmHxMAgYyLbNEtIKZeRNFsMKPR9EyMZeS9weJAEb"};
+static const QByteArray TOKEN_SECRET {"LswwdoUaIvS8ltyTt5jkRh4J50vUPVVHtR2YPi5kE"};
+static const QByteArray URL {"https://api.twitter.com/1.1/statuses/update.json"};
+static const QByteArray NONCE {"kYjzVBB8Y0ZFabxSWbWovY3uYSQ2pTgmZeNu2VS4cg"};
+static const QByteArray TIMESTAMP {"1318622958"};
+static const QByteArray STATUS {"Hello%20Ladies%20%2B%20Gentlemen%2C%20a%20signed%20OAuth%20request%21"};
+static const QByteArray HEADER {"OAuth oauth_consumer_key=\"xvz1evFS4wEEPTGEFPHBog\", "
+                                "oauth_nonce=\"kYjzVBB8Y0ZFabxSWbWovY3uYSQ2pTgmZeNu2VS4cg\", "
+                                "oauth_signature=\"hCtSmYh%2BiHYCEqBWrE7C7hYmtUk%3D\", "
+                                "oauth_signature_method=\"HMAC-SHA1\", "
+                                "oauth_timestamp=\"1318622958\", "
+                                "oauth_token=\"370773112-GmHxMAgYyLbNEtIKZeRNFsMKPR9EyMZeS9weJAEb\", "
+                                "oauth_version=\"1.0\""};
+
+TEST(twitterdatautil, SigningContext)
+{
+    private_util::TwitterDataUtil::SigningContext context {CONSUMER_KEY, CONSUMER_SECRET, TOKEN, TOKEN_SECRET};
+    EXPECT_EQ(context.authorizationHeader("POST", URL, {{"include_entities", "true"}}, {{"status", STATUS}},
+                                          NONCE, TIMESTAMP), HEADER);
+    // The context can be reused
+    EXPECT_EQ(context.authorizationHeader("post", URL, {{"include_entities", "true"}, {"status", STATUS}}, {},
+                                          NONCE, TIMESTAMP), HEADER);
+}
+
+TEST(twitterdatautil, AuthorizationHeader)
+{
+    EXPECT_EQ(private_util::TwitterDataUtil::authorizationHeader(CONSUMER_KEY, CONSUMER_SECRET, "POST", URL,
+                                                                 {{"status", STATUS}, {"include_entities", "true"}},
+                                                                 TOKEN, TOKEN_SECRET, NONCE, TIMESTAMP), HEADER);
+}
+
+TEST(twitterdatautil, GeneratedNonce)
+{
+    // Requests of the OAuth flow are signed without a token
+    private_util::TwitterDataUtil::SigningContext context {CONSUMER_KEY, CONSUMER_SECRET};
+    QByteArray first {context.authorizationHeader("POST", URL, {{"oauth_callback", "oob"}})};
+    QByteArray second {context.authorizationHeader("POST", URL, {{"oauth_callback", "oob"}})};
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(first.startsWith("OAuth oauth_consumer_key=\"xvz1evFS4wEEPTGEFPHBog\", oauth_nonce=\""));
+    EXPECT_FALSE(first.contains("oauth_token"));
+    EXPECT_FALSE(first.contains("oauth_callback"));
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QHash>
+#include <twitterid.h>
+
+TEST(TwitterId, Parse)
+{
+    TwitterId id {TwitterId::fromString(QLatin1String("18446744073709551615"))};
+    EXPECT_TRUE(id.isValid());
+    EXPECT_EQ(Q_UINT64_C(18446744073709551615), id.value());
+    EXPECT_EQ(QString(QLatin1String("18446744073709551615")), id.toString());
+
+    EXPECT_FALSE(TwitterId::fromString(QString()).isValid());
+    EXPECT_FALSE(TwitterId::fromString(QLatin1String("abc")).isValid());
+
+    // Only one string is parsed to an id
+    EXPECT_FALSE(TwitterId::fromString(QLatin1String("09")).isValid());
+    EXPECT_FALSE(TwitterId::fromString(QLatin1String("+9")).isValid());
+    EXPECT_FALSE(TwitterId::fromString(QLatin1String(" 9")).isValid());
+    EXPECT_TRUE(TwitterId().toString().isNull());
+}
+
+TEST(TwitterId, Compare)
+{
+    EXPECT_EQ(TwitterId(9), TwitterId::fromString(QLatin1String("9")));
+    EXPECT_NE(TwitterId(9), TwitterId(10));
+
+    // Numeric, and not lexicographic, order
+    EXPECT_TRUE(TwitterId(9) < TwitterId(10));
+    EXPECT_EQ(qHash(TwitterId(9)), qHash(TwitterId::fromString(QLatin1String("9"))));
+}
+
+TEST(TwitterId, Previous)
+{
+    EXPECT_EQ(TwitterId(9), TwitterId(10).previous());
+    EXPECT_FALSE(TwitterId(1).previous().isValid());
+    EXPECT_FALSE(TwitterId().previous().isValid());
+}
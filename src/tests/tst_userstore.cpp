@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2014 Lucien XU <sfietkonstantin@free.fr>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * The names of its contributors may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <gtest/gtest.h>
+#include <QtCore/QJsonObject>
+#include <tweet.h>
+#include <userstore.h>
+
+static QJsonObject userJson(const QString &id, const QString &name)
+{
+    QJsonObject user {};
+    user.insert(QLatin1String("id_str"), id);
+    user.insert(QLatin1String("name"), name);
+    return user;
+}
+
+static Tweet makeTweet(const QString &id, const QJsonObject &user)
+{
+    QJsonObject tweet {};
+    tweet.insert(QLatin1String("id_str"), id);
+    tweet.insert(QLatin1String("user"), user);
+    return Tweet(tweet);
+}
+
+TEST(UserStore, Intern)
+{
+    UserStore store {};
+    Tweet tweet1 {makeTweet(QLatin1String("1"), userJson(QLatin1String("10"), QLatin1String("Old")))};
+    Tweet tweet2 {makeTweet(QLatin1String("2"), userJson(QLatin1String("10"), QLatin1String("New")))};
+    Tweet tweet3 {makeTweet(QLatin1String("3"), userJson(QLatin1String("10"), QLatin1String("Cached")))};
+    EXPECT_NE(tweet1.sharedUser(), tweet2.sharedUser());
+
+    tweet1.internUsers(store);
+    tweet2.internUsers(store);
+    EXPECT_EQ(1, store.count());
+
+    // Newer data replaces older data, that is not modified
+    EXPECT_NE(tweet1.sharedUser(), tweet2.sharedUser());
+    EXPECT_EQ(QString(QLatin1String("Old")), tweet1.user().name());
+    EXPECT_EQ(QString(QLatin1String("New")), tweet2.user().name());
+
+    // Older data do not replace newer data
+    tweet3.internUsers(store, false);
+    EXPECT_EQ(tweet2.sharedUser(), tweet3.sharedUser());
+    EXPECT_EQ(QString(QLatin1String("New")), tweet3.user().name());
+
+    // Counters that changed do not replace the stored user
+    QJsonObject counted {userJson(QLatin1String("10"), QLatin1String("New"))};
+    counted.insert(QLatin1String("followers_count"), 5);
+    Tweet tweet4 {makeTweet(QLatin1String("4"), counted)};
+    tweet4.internUsers(store);
+    EXPECT_EQ(tweet2.sharedUser(), tweet4.sharedUser());
+
+    // Invalid users are not interned
+    EXPECT_FALSE(tweet1.retweetingUser().isValid());
+    EXPECT_FALSE(tweet1.sharedRetweetingUser());
+}
+
+TEST(UserStore, Release)
+{
+    UserStore store {};
+    {
+        Tweet tweet {makeTweet(QLatin1String("1"), userJson(QLatin1String("10"), QLatin1String("A")))};
+        tweet.internUsers(store);
+        EXPECT_EQ(1, store.count());
+    }
+    EXPECT_EQ(0, store.count());
+
+    Tweet tweet {makeTweet(QLatin1String("2"), userJson(QLatin1String("10"), QLatin1String("B")))};
+    User::Ptr user {tweet.sharedUser()};
+    tweet.internUsers(store);
+    EXPECT_EQ(1, store.count());
+    EXPECT_EQ(user, tweet.sharedUser());
+}
+
+TEST(UserStore, MemoryUsage)
+{
+    UserStore store {};
+    TweetRepository repository {};
+    std::vector<Tweet> tweets {};
+    for (int i = 0; i < 3; ++i) {
+        tweets.push_back(makeTweet(QString::number(i + 1), userJson(QLatin1String("10"), QLatin1String("A"))));
+    }
+    tweets.push_back(makeTweet(QLatin1String("4"), userJson(QLatin1String("20"), QLatin1String("B"))));
+
+    repository.append(tweets);
+    UserStore::MemoryUsage unshared {UserStore::memoryUsage(repository)};
+    EXPECT_EQ(4, unshared.references);
+    EXPECT_EQ(4, unshared.users);
+    EXPECT_EQ(unshared.unsharedSize, unshared.sharedSize);
+
+    for (Tweet &tweet : tweets) {
+        tweet.internUsers(store);
+    }
+    TweetRepository sharedRepository {};
+    sharedRepository.append(tweets);
+    UserStore::MemoryUsage shared {UserStore::memoryUsage(sharedRepository)};
+    EXPECT_EQ(4, shared.references);
+    EXPECT_EQ(2, shared.users);
+    EXPECT_EQ(unshared.unsharedSize, shared.unsharedSize);
+    EXPECT_LT(shared.sharedSize, shared.unsharedSize);
+}
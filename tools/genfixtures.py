@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+#
+# Generates the JSON fixtures used by the benchmarks, in src/benchmarks/data.
+#
+# The fixtures follow the layout of replies from the Twitter REST API
+# (statuses/home_timeline.json, search/tweets.json and lists/members.json),
+# with the same proportion of retweets, quotes, replies, media, links,
+# mentions and hashtags than a typical home timeline. A fixed seed is used,
+# so that the generated files are stable.
+
+import json
+import os
+import random
+import sys
+from datetime import datetime, timedelta, timezone
+
+WORDS = ("the a to of and in is for on that this with you it at be are was have "
+         "not we but can what about just from more all like new one now out so "
+         "today time people year good great day really think know want still "
+         "release build phone app update work team week night back again").split()
+SOURCES = [
+    '<a href="http://twitter.com/download/android" rel="nofollow">Twitter for Android</a>',
+    '<a href="http://twitter.com/download/iphone" rel="nofollow">Twitter for iPhone</a>',
+    '<a href="https://about.twitter.com/products/tweetdeck" rel="nofollow">TweetDeck</a>',
+    '<a href="http://twitter.com" rel="nofollow">Twitter Web Client</a>',
+]
+EMOJIS = ["\U0001F600", "\U0001F44D", "❤️", "\U0001F680"]
+NOW = datetime(2016, 3, 14, 15, 9, 26, tzinfo=timezone.utc)
+
+random.seed(42)
+next_id = [709000000000000000]
+
+
+def new_id():
+    next_id[0] -= random.randint(1000, 5000000)
+    return next_id[0]
+
+
+def timestamp(offset):
+    return (NOW - timedelta(seconds=offset)).strftime("%a %b %d %H:%M:%S +0000 %Y")
+
+
+def sentence(count):
+    return " ".join(random.choice(WORDS) for _ in range(count))
+
+
+def make_user(index):
+    screen_name = "user_%d" % index
+    description = sentence(random.randint(4, 16))
+    entities = {"description": {"urls": []}}
+    if index % 3 == 0:
+        url = "https://t.co/%07d" % index
+        description += " " + url
+        entities["description"]["urls"].append({
+            "url": url, "expanded_url": "http://example.com/%s" % screen_name,
+            "display_url": "example.com/%s" % screen_name,
+            "indices": [len(description) - len(url), len(description)]})
+    return {
+        "id": 10000 + index, "id_str": str(10000 + index),
+        "name": "User %d" % index, "screen_name": screen_name,
+        "location": random.choice(["", "Paris, France", "San Francisco, CA", "Tokyo"]),
+        "description": description, "url": None, "entities": entities,
+        "protected": index % 17 == 0, "followers_count": random.randint(0, 100000),
+        "friends_count": random.randint(0, 2000), "listed_count": random.randint(0, 100),
+        "created_at": timestamp(random.randint(10 ** 7, 2 * 10 ** 8)),
+        "favourites_count": random.randint(0, 5000), "utc_offset": 3600,
+        "time_zone": "Paris", "geo_enabled": False, "verified": index % 11 == 0,
+        "statuses_count": random.randint(10, 50000), "lang": "en",
+        "profile_background_color": "C0DEED",
+        "profile_image_url": "http://pbs.twimg.com/profile_images/%d/avatar_normal.jpg" % index,
+        "profile_image_url_https": "https://pbs.twimg.com/profile_images/%d/avatar_normal.jpg" % index,
+        "profile_banner_url": "https://pbs.twimg.com/profile_banners/%d/1450000000" % index,
+        "default_profile": False, "following": random.random() < 0.8,
+        "follow_request_sent": False, "notifications": False,
+    }
+
+
+def make_tweet(users, offset, depth=0):
+    user = random.choice(users)
+    parts = [sentence(random.randint(3, 10))]
+    entities = {"hashtags": [], "symbols": [], "user_mentions": [], "urls": []}
+    extended = None
+
+    def add(text):
+        # Indices are in code points
+        start = len(" ".join(parts)) + 1
+        parts.append(text)
+        return [start, start + len(text)]
+
+    if random.random() < 0.3:
+        mentioned = random.choice(users)
+        entities["user_mentions"].append({
+            "screen_name": mentioned["screen_name"], "name": mentioned["name"],
+            "id": mentioned["id"], "id_str": mentioned["id_str"],
+            "indices": add("@" + mentioned["screen_name"])})
+    if random.random() < 0.2:
+        parts.append(random.choice(EMOJIS))
+    if random.random() < 0.25:
+        tag = random.choice(["qt", "cpp", "sailfishos", "jolla", "release"])
+        entities["hashtags"].append({"text": tag, "indices": add("#" + tag)})
+    if random.random() < 0.1:
+        parts.append("&amp;")
+        parts.append(sentence(2))
+    if random.random() < 0.35:
+        url = "https://t.co/%010d" % random.randint(0, 10 ** 10)
+        entities["urls"].append({
+            "url": url, "expanded_url": "http://example.com/article/%d" % offset,
+            "display_url": "example.com/article/%d" % offset, "indices": add(url)})
+    if random.random() < 0.2:
+        url = "https://t.co/%010d" % random.randint(0, 10 ** 10)
+        media_id = new_id()
+        media = {
+            "id": media_id, "id_str": str(media_id), "indices": add(url),
+            "media_url": "http://pbs.twimg.com/media/%d.jpg" % media_id,
+            "media_url_https": "https://pbs.twimg.com/media/%d.jpg" % media_id,
+            "url": url, "display_url": "pic.twitter.com/%d" % media_id,
+            "expanded_url": "http://twitter.com/%s/status/%d/photo/1" % (user["screen_name"], media_id),
+            "type": "photo",
+            "sizes": {"large": {"w": 1024, "h": 768, "resize": "fit"},
+                      "medium": {"w": 600, "h": 450, "resize": "fit"},
+                      "thumb": {"w": 150, "h": 150, "resize": "crop"},
+                      "small": {"w": 340, "h": 255, "resize": "fit"}}}
+        entities["media"] = [media]
+        extended = {"media": [media]}
+
+    tweet_id = new_id()
+    tweet = {
+        "created_at": timestamp(offset), "id": tweet_id, "id_str": str(tweet_id),
+        "text": " ".join(parts)[:140], "source": random.choice(SOURCES), "truncated": False,
+        "in_reply_to_status_id": None, "in_reply_to_status_id_str": None,
+        "in_reply_to_user_id": None, "in_reply_to_user_id_str": None,
+        "in_reply_to_screen_name": None, "user": user, "geo": None, "coordinates": None,
+        "place": None, "contributors": None, "is_quote_status": False,
+        "retweet_count": random.randint(0, 500), "favorite_count": random.randint(0, 1000),
+        "entities": entities, "favorited": random.random() < 0.05,
+        "retweeted": random.random() < 0.02, "possibly_sensitive": False, "lang": "en",
+    }
+    if extended:
+        tweet["extended_entities"] = extended
+    if random.random() < 0.15:
+        reply_id = new_id()
+        tweet["in_reply_to_status_id"] = reply_id
+        tweet["in_reply_to_status_id_str"] = str(reply_id)
+    if depth == 0:
+        roll = random.random()
+        if roll < 0.2:
+            retweeted = make_tweet(users, offset + random.randint(60, 36000), depth + 1)
+            tweet["retweeted_status"] = retweeted
+            tweet["text"] = ("RT @%s: %s" % (retweeted["user"]["screen_name"], retweeted["text"]))[:140]
+        elif roll < 0.3:
+            quoted = make_tweet(users, offset + random.randint(60, 36000), depth + 1)
+            tweet["is_quote_status"] = True
+            tweet["quoted_status_id"] = quoted["id"]
+            tweet["quoted_status_id_str"] = quoted["id_str"]
+            tweet["quoted_status"] = quoted
+    return tweet
+
+
+def dump(directory, name, value):
+    with open(os.path.join(directory, name), "w") as output:
+        json.dump(value, output, ensure_ascii=False, separators=(",", ":"))
+        output.write("\n")
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), os.pardir, "src", "benchmarks", "data")
+    users = [make_user(i) for i in range(120)]
+    home = [make_tweet(users, 30 * i) for i in range(200)]
+    search = [make_tweet(users, 45 * i) for i in range(100)]
+    dump(directory, "home_timeline.json", home)
+    dump(directory, "search.json", {
+        "statuses": search,
+        "search_metadata": {"completed_in": 0.035, "max_id": search[0]["id"],
+                            "max_id_str": search[0]["id_str"], "query": "qt",
+                            "count": len(search), "since_id": 0, "since_id_str": "0"}})
+    dump(directory, "members.json", {
+        "users": users[:100], "next_cursor": 0, "next_cursor_str": "0",
+        "previous_cursor": 0, "previous_cursor_str": "0"})
+
+
+if __name__ == "__main__":
+    main()
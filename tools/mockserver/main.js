@@ -1,44 +1,463 @@
+// A mock of the Twitter REST API, used to render timelines without
+// a Twitter account, and to load test the application.
+//
+// Usage: node main.js [--option value]...
+//
+// Options, that can also be changed while the server is running
+// with POST /_config?option=value&...
+//   port           port to listen to (8000)
+//   latency        delay before answering, in ms (2000)
+//   jitter         random delay added to latency, in ms (0)
+//   tweets         number of tweets per page, or 0 to honour the count parameter (50)
+//   users          number of users returned by friends and followers (100)
+//   lists          number of lists returned by the lists endpoints (10)
+//   rate           new tweets per second in the timelines (1)
+//   rateLimitRate  ratio of requests that fail with a rate limit error (code 88) (0)
+//   rateLimit      GET requests allowed per token and endpoint in a window, or 0
+//                  for no limit; when set, the x-rate-limit-* headers are sent (0)
+//   rateLimitWindow  length of a rate limit window, in s (900)
+//   errorRate      ratio of requests that fail with an internal error (0)
+//   malformedRate  ratio of requests that are answered with truncated JSON (0)
+//   gzip           compress the replies when the request accepts gzip, 0 or 1 (1)
+//
+// GET /_config returns the current configuration, GET /_stats returns
+// the number of requests per endpoint and outcome, and the size of the
+// bodies that were sent ("wireBytes") and before compression
+// ("decodedBytes"), and POST /_reset
+// resets the statistics and the rate limit windows.
+//
+// GET user.json and GET statuses/filter.json?track=... mock the
+// streaming API: the connection stays open, and the new tweets are
+// written to it as they appear, one per line. The filter stream only
+// sends the tweets that contain all the words of one of the comma
+// separated track phrases.
+//
+// The library is sent to this server when built with ENABLE_MOCK_SERVER,
+// or when TWABLET_API_URL is set to http://localhost:8000/, and the load
+// test driver in src/loadtest, built with ENABLE_LOADTEST, opens columns
+// and refreshes them against it.
+
 var express = require('express');
+var querystring = require('querystring');
+var zlib = require('zlib');
 var app = express();
 
-var id = 1;
-
-var callback = function (req, res) {
-    setTimeout(function() {
-        var date = new Date();
-        var ts = String(Math.round(date.getTime() / 1000) + date.getTimezoneOffset() * 60);
-
-        var tweets = new Array;
-        for (var i = 0; i < 50; i++) {
-            var tweet = new Object;
-            tweet.id_str = (id + i).toString();
-            tweet.text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua";
-            tweet.favorite_count = 0;
-            tweet.favorited = false;
-            tweet.retweet_count = 0;
-            tweet.retweeted = false;
-            tweet.in_reply_to_status_id = "0";
-            tweet.source = "Test app";
-            tweet.created_at = ts;
-            tweet.user = new Object;
-            tweet.user.id_str = "0";
-            tweet.user.id_str = i.toString();
-            tweet.user.name = "User " + i;
-            tweet.user.screen_name = "User_" + i;
-            tweets.push(tweet);
+var config = {
+    port: 8000,
+    latency: 2000,
+    jitter: 0,
+    tweets: 50,
+    users: 100,
+    lists: 10,
+    rate: 1,
+    rateLimitRate: 0,
+    rateLimit: 0,
+    rateLimitWindow: 900,
+    errorRate: 0,
+    malformedRate: 0,
+    gzip: 1
+};
+
+var updateConfig = function (values) {
+    Object.keys(values).forEach(function (key) {
+        if (config.hasOwnProperty(key)) {
+            config[key] = Number(values[key]);
         }
-        id = id + 50
-        
-        res.setHeader('Content-Type', 'application/json');
-        res.send(JSON.stringify(tweets));
-    }, 2000);
+    });
+};
+
+for (var i = 2; i + 1 < process.argv.length; i += 2) {
+    var values = {};
+    values[process.argv[i].replace(/^--/, '')] = process.argv[i + 1];
+    updateConfig(values);
 }
 
-app.get('/statuses/home_timeline.json', callback);
-app.get('/statuses/mentions_timeline.json', callback);
+// Data
+
+var FIRST_ID = 700000000000; // Ids stay below 2^53
+var WORDS = ('the a to of and in is for on that this with you it at be are was have not we '
+             + 'but can what about just from more all like new one now out so today time people '
+             + 'year good great day really think know want still release build phone app update').split(' ');
+var startTime = Date.now();
+var created = {};
+var favorited = {};
+var following = {};
+
+// Deterministic pseudo random numbers, so that a given id
+// always produces the same tweet
+var random = function (seed, index) {
+    var value = Math.sin(seed * 12.9898 + index * 78.233) * 43758.5453;
+    return value - Math.floor(value);
+};
+
+var latestId = function () {
+    return FIRST_ID + Math.floor((Date.now() - startTime) / 1000 * config.rate) + Object.keys(created).length;
+};
 
+var timestamp = function (date) {
+    var days = ['Sun', 'Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat'];
+    var months = ['Jan', 'Feb', 'Mar', 'Apr', 'May', 'Jun', 'Jul', 'Aug', 'Sep', 'Oct', 'Nov', 'Dec'];
+    var pad = function (value) {
+        return value < 10 ? '0' + value : String(value);
+    };
+    return days[date.getUTCDay()] + ' ' + months[date.getUTCMonth()] + ' ' + pad(date.getUTCDate()) + ' '
+            + pad(date.getUTCHours()) + ':' + pad(date.getUTCMinutes()) + ':' + pad(date.getUTCSeconds())
+            + ' +0000 ' + date.getUTCFullYear();
+};
+
+var makeUser = function (index) {
+    var id = String(10000 + index);
+    return {
+        id_str: id,
+        name: 'User ' + index,
+        screen_name: 'user_' + index,
+        description: 'Description of user ' + index,
+        location: 'Paris, France',
+        url: null,
+        entities: {description: {urls: []}},
+        'protected': false,
+        following: following.hasOwnProperty(id) ? following[id] : index % 3 !== 0,
+        statuses_count: 1000 + index,
+        followers_count: 100 * index,
+        friends_count: 10 * index,
+        listed_count: index,
+        favourites_count: 5 * index,
+        created_at: timestamp(new Date(Date.UTC(2010, index % 12, 1 + index % 28))),
+        profile_image_url_https: 'https://pbs.twimg.com/profile_images/' + id + '/avatar_normal.jpg',
+        profile_banner_url: 'https://pbs.twimg.com/profile_banners/' + id + '/1450000000'
+    };
+};
+
+var userIndex = function (id) {
+    return Math.floor(random(id, 1) * 50);
+};
+
+var makeTweet = function (id, depth) {
+    if (created.hasOwnProperty(id)) {
+        return created[id];
+    }
+
+    var words = [];
+    for (var i = 0; i < 4 + Math.floor(random(id, 2) * 12); ++i) {
+        words.push(WORDS[Math.floor(random(id, 3 + i) * WORDS.length)]);
+    }
+    var text = words.join(' ');
+    var entities = {hashtags: [], symbols: [], user_mentions: [], urls: []};
+    var add = function (token) {
+        var start = text.length + 1;
+        text += ' ' + token;
+        return [start, start + token.length];
+    };
+    if (random(id, 20) < 0.3) {
+        var mentioned = makeUser(userIndex(id + 1));
+        entities.user_mentions.push({screen_name: mentioned.screen_name, name: mentioned.name,
+                                     id_str: mentioned.id_str, indices: add('@' + mentioned.screen_name)});
+    }
+    if (random(id, 21) < 0.25) {
+        entities.hashtags.push({text: 'qt', indices: add('#qt')});
+    }
+    if (random(id, 22) < 0.35) {
+        var url = 'https://t.co/' + (id % 10000000000);
+        entities.urls.push({url: url, expanded_url: 'http://example.com/' + id,
+                            display_url: 'example.com/' + id, indices: add(url)});
+    }
+
+    var date = new Date(startTime - (latestId() - id) * 1000 / Math.max(config.rate, 0.001));
+    var tweet = {
+        created_at: timestamp(date),
+        id_str: String(id),
+        text: text,
+        source: '<a href="http://twitter.com" rel="nofollow">Twitter Web Client</a>',
+        in_reply_to_status_id_str: random(id, 23) < 0.15 ? String(id - 1) : null,
+        user: makeUser(userIndex(id)),
+        retweet_count: Math.floor(random(id, 24) * 100),
+        favorite_count: Math.floor(random(id, 25) * 200),
+        favorited: favorited.hasOwnProperty(id) ? favorited[id] : false,
+        retweeted: false,
+        entities: entities,
+        lang: 'en'
+    };
+    if (depth === 0) {
+        var roll = random(id, 26);
+        if (roll < 0.2) {
+            tweet.retweeted_status = makeTweet(id - 1000, 1);
+        } else if (roll < 0.3) {
+            tweet.quoted_status = makeTweet(id - 2000, 1);
+        }
+    }
+    return tweet;
+};
+
+// Each timeline contains a subset of the tweets
+var filters = {
+    'statuses/home_timeline.json': function () { return true; },
+    'statuses/mentions_timeline.json': function (id) { return id % 5 === 0; },
+    'search/tweets.json': function (id) { return id % 3 === 0; },
+    'favorites/list.json': function (id) { return id % 7 === 0; },
+    'statuses/user_timeline.json': function (id, query) {
+        return !query.user_id || String(10000 + userIndex(id)) === query.user_id;
+    }
+};
+
+var timeline = function (path, query) {
+    var count = config.tweets > 0 ? config.tweets : Math.min(Number(query.count || 20), 200);
+    var sinceId = Number(query.since_id || 0);
+    var id = Math.min(latestId(), query.max_id ? Number(query.max_id) : Infinity);
+    var tweets = [];
+    // Bounded, since some filters are sparse
+    for (var scanned = 0; tweets.length < count && id > sinceId && id > FIRST_ID - 100000 && scanned < 100000;
+         --id, ++scanned) {
+        if (filters[path](id, query)) {
+            tweets.push(makeTweet(id, 0));
+        }
+    }
+    return tweets;
+};
+
+var page = function (total, query, make) {
+    var count = Math.min(Number(query.count || 20), 200);
+    var cursor = Math.max(Number(query.cursor || 0), 0);
+    var items = [];
+    for (var i = cursor; i < Math.min(cursor + count, total); ++i) {
+        items.push(make(i));
+    }
+    return {items: items, next: cursor + count < total ? String(cursor + count) : '0'};
+};
+
+var makeList = function (index) {
+    return {
+        id_str: String(500 + index),
+        name: 'List ' + index,
+        slug: 'list-' + index,
+        full_name: '@user_0/list-' + index,
+        description: 'Description of list ' + index,
+        user: makeUser(0),
+        mode: 'public',
+        following: index % 2 === 0,
+        member_count: 10 * index,
+        subscriber_count: index,
+        uri: '/user_0/lists/list-' + index,
+        created_at: timestamp(new Date(Date.UTC(2014, index % 12, 1)))
+    };
+};
+
+// Endpoints
+
+var handlers = {};
+Object.keys(filters).forEach(function (path) {
+    handlers['GET ' + path] = function (query) {
+        var tweets = timeline(path, query);
+        if (path !== 'search/tweets.json') {
+            return tweets;
+        }
+        return {statuses: tweets, search_metadata: {count: tweets.length, query: query.q || ''}};
+    };
+});
+['friends/list.json', 'followers/list.json'].forEach(function (path) {
+    handlers['GET ' + path] = function (query) {
+        var result = page(config.users, query, makeUser);
+        return {users: result.items, next_cursor_str: result.next, previous_cursor_str: '0'};
+    };
+});
+['lists/subscriptions.json', 'lists/ownerships.json', 'lists/memberships.json'].forEach(function (path) {
+    handlers['GET ' + path] = function (query) {
+        var result = page(config.lists, query, makeList);
+        return {lists: result.items, next_cursor_str: result.next, previous_cursor_str: '0'};
+    };
+});
+handlers['GET statuses/show.json'] = function (query) {
+    return makeTweet(Number(query.id), 0);
+};
+handlers['POST statuses/update.json'] = function (query) {
+    var id = latestId() + 1;
+    var tweet = makeTweet(id, 1);
+    tweet.text = query.status || '';
+    tweet.entities = {hashtags: [], symbols: [], user_mentions: [], urls: []};
+    tweet.in_reply_to_status_id_str = query.in_reply_to_status_id || null;
+    created[id] = tweet;
+    return tweet;
+};
+handlers['POST favorites/create.json'] = function (query) {
+    favorited[Number(query.id)] = true;
+    return makeTweet(Number(query.id), 0);
+};
+handlers['POST favorites/destroy.json'] = function (query) {
+    favorited[Number(query.id)] = false;
+    return makeTweet(Number(query.id), 0);
+};
+handlers['POST statuses/retweet.json'] = function (query) {
+    var tweet = makeTweet(latestId() + 1, 1);
+    tweet.retweeted_status = makeTweet(Number(query.id), 1);
+    tweet.retweeted_status.retweeted = true;
+    return tweet;
+};
+handlers['GET users/show.json'] = function (query) {
+    return makeUser(Number(query.user_id) - 10000);
+};
+handlers['POST friendships/create.json'] = function (query) {
+    following[query.user_id] = true;
+    return makeUser(Number(query.user_id) - 10000);
+};
+handlers['POST friendships/destroy.json'] = function (query) {
+    following[query.user_id] = false;
+    return makeUser(Number(query.user_id) - 10000);
+};
 
+// Statistics
+
+var stats = {};
+var record = function (path, outcome) {
+    if (!stats.hasOwnProperty(path)) {
+        stats[path] = {};
+    }
+    stats[path][outcome] = (stats[path][outcome] || 0) + 1;
+};
+var recordBytes = function (path, wireBytes, decodedBytes) {
+    stats[path].wireBytes = (stats[path].wireBytes || 0) + wireBytes;
+    stats[path].decodedBytes = (stats[path].decodedBytes || 0) + decodedBytes;
+};
+
+// Sends a JSON body, compressed when the client accepts gzip
+var send = function (req, res, path, status, body) {
+    var decoded = Buffer.from(body, 'utf8');
+    var wire = decoded;
+    res.status(status);
+    res.setHeader('Content-Type', 'application/json; charset=utf-8');
+    if (config.gzip && /\bgzip\b/.test(req.headers['accept-encoding'] || '')) {
+        wire = zlib.gzipSync(decoded);
+        res.setHeader('Content-Encoding', 'gzip');
+    }
+    res.setHeader('Vary', 'Accept-Encoding');
+    recordBytes(path, wire.length, decoded.length);
+    res.end(wire);
+};
+
+app.get('/_config', function (req, res) {
+    res.json(config);
+});
+app.post('/_config', function (req, res) {
+    updateConfig(req.query);
+    res.json(config);
+});
+app.get('/_stats', function (req, res) {
+    res.json(stats);
+});
+app.post('/_reset', function (req, res) {
+    stats = {};
+    windows = {};
+    res.json(stats);
+});
+
+// Rate limits, per token and endpoint, like the GET endpoints of Twitter
+
+var windows = {};
+var consume = function (req, path) {
+    var authorization = req.headers.authorization || '';
+    var token = /oauth_token="([^"]*)"/.exec(authorization);
+    var key = (token ? token[1] : '') + ' ' + path;
+    var now = Math.floor(Date.now() / 1000);
+    var current = windows[key];
+    if (!current || current.reset <= now) {
+        current = windows[key] = {remaining: config.rateLimit, reset: now + config.rateLimitWindow};
+    }
+    var allowed = current.remaining > 0;
+    if (allowed) {
+        --current.remaining;
+    }
+    return {allowed: allowed, remaining: current.remaining, reset: current.reset};
+};
+
+// Streams, that are not delayed, compressed or rate limited
+
+var tracked = function (track, tweet) {
+    var text = tweet.text.toLowerCase();
+    return track.split(',').some(function (phrase) {
+        var words = phrase.toLowerCase().split(/\s+/).filter(function (word) { return word.length > 0; });
+        return words.length > 0 && words.every(function (word) { return text.indexOf(word) !== -1; });
+    });
+};
+
+app.get(/^\/(1\.1\/)?(user\.json|statuses\/filter\.json)$/, function (req, res) {
+    var path = req.path.replace(/^\/(1\.1\/)?/, '');
+    var track = path === 'user.json' ? null : String(req.query.track || '');
+    record(path, 'stream');
+    res.status(200);
+    res.setHeader('Content-Type', 'application/json; charset=utf-8');
+    res.write('\r\n');
+
+    var lastId = latestId();
+    var poll = setInterval(function () {
+        var id = latestId();
+        for (++lastId; lastId <= id; ++lastId) {
+            var tweet = makeTweet(lastId, 0);
+            if (track === null || tracked(track, tweet)) {
+                var line = JSON.stringify(tweet) + '\r\n';
+                recordBytes(path, Buffer.byteLength(line), Buffer.byteLength(line));
+                res.write(line);
+            }
+        }
+        lastId = id;
+    }, 200);
+    // Keep-alive newlines, so that clients can detect stalls
+    var keepAlive = setInterval(function () {
+        res.write('\r\n');
+    }, 30000);
+    req.on('close', function () {
+        clearInterval(poll);
+        clearInterval(keepAlive);
+    });
+});
+
+// POST parameters are form encoded
+app.use(function (req, res, next) {
+    var body = '';
+    req.on('data', function (chunk) {
+        body += chunk;
+    });
+    req.on('end', function () {
+        req.body = querystring.parse(body);
+        next();
+    });
+});
+
+app.use(function (req, res) {
+    // The REST API is served both under /1.1/, like Twitter, and under /
+    var path = req.path.replace(/^\/(1\.1\/)?/, '');
+    var handler = handlers[req.method + ' ' + path];
+    var query = req.method === 'POST' ? req.body : req.query;
+    if (!handler) {
+        record(path, 'notfound');
+        res.status(404).json({errors: [{code: 34, message: 'Sorry, that page does not exist.'}]});
+        return;
+    }
+
+    var window = null;
+    if (config.rateLimit > 0 && req.method === 'GET') {
+        window = consume(req, path);
+        res.setHeader('x-rate-limit-limit', config.rateLimit);
+        res.setHeader('x-rate-limit-remaining', window.remaining);
+        res.setHeader('x-rate-limit-reset', window.reset);
+    }
+
+    var delay = config.latency + Math.random() * config.jitter;
+    setTimeout(function () {
+        if ((window && !window.allowed) || Math.random() < config.rateLimitRate) {
+            record(path, 'ratelimit');
+            send(req, res, path, 429, JSON.stringify({errors: [{code: 88, message: 'Rate limit exceeded'}]}));
+        } else if (Math.random() < config.errorRate) {
+            record(path, 'error');
+            send(req, res, path, 500, JSON.stringify({errors: [{code: 131, message: 'Internal error'}]}));
+        } else if (Math.random() < config.malformedRate) {
+            record(path, 'malformed');
+            var body = JSON.stringify(handler(query));
+            send(req, res, path, 200, body.substring(0, Math.floor(body.length / 2)));
+        } else {
+            record(path, 'ok');
+            send(req, res, path, 200, JSON.stringify(handler(query)));
+        }
+    }, delay);
+});
 
-var server = app.listen(8000, function () {
-    console.log('Started mock server');
+var server = app.listen(config.port, function () {
+    console.log('Started mock server on port ' + config.port);
 });